@@ -0,0 +1,116 @@
+/**
+ * @file displaybench.cpp
+ * @author ldk
+ * @brief 离屏运行显示性能测量，写出 JSON 并与基线对比
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include "displaybenchmark.hpp"
+
+/**
+ * @brief 退出码：0 为通过，1 为性能回退，2 为参数或文件错误
+ *
+ * 用法：qttools_display_bench [--output result.json] [--baseline baseline.json]
+ *                             [--tolerance 0.1] [--iterations 30] [--update-baseline]
+ */
+int main(int argc, char* argv[])
+{
+    // 未指定平台时使用离屏平台，可在没有显示器的 CI 中运行
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    QApplication::setApplicationName("qttools_display_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Offscreen display benchmark with baseline comparison");
+    parser.addHelpOption();
+    const QCommandLineOption outputOption("output", "Write results to <file>.", "file", "display_bench.json");
+    const QCommandLineOption baselineOption("baseline", "Compare results against <file>.", "file");
+    const QCommandLineOption toleranceOption("tolerance", "Allowed relative increase, default 0.1.", "ratio", "0.1");
+    const QCommandLineOption iterationsOption("iterations", "Iterations per case, default 30.", "count", "30");
+    const QCommandLineOption updateOption("update-baseline", "Overwrite the baseline with the results.");
+    parser.addOptions({ outputOption, baselineOption, toleranceOption, iterationsOption, updateOption });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    bool ok = false;
+    const double tolerance = parser.value(toleranceOption).toDouble(&ok);
+    if (!ok || tolerance < 0.)
+    {
+        err << "invalid tolerance: " << parser.value(toleranceOption) << '\n';
+        return 2;
+    }
+    const int iterations = parser.value(iterationsOption).toInt(&ok);
+    if (!ok || iterations <= 0)
+    {
+        err << "invalid iterations: " << parser.value(iterationsOption) << '\n';
+        return 2;
+    }
+    const QString baselinePath = parser.value(baselineOption);
+    const bool update = parser.isSet(updateOption);
+    if (update && baselinePath.isEmpty())
+    {
+        err << "--update-baseline requires --baseline" << '\n';
+        return 2;
+    }
+    // 先读取基线，避免输出文件与基线相同时被覆盖
+    QJsonObject baseline;
+    if (!baselinePath.isEmpty() && !update)
+    {
+        baseline = DisplayBenchmark::readJson(baselinePath);
+        if (baseline.isEmpty())
+        {
+            err << "cannot read baseline: " << baselinePath << '\n';
+            return 2;
+        }
+    }
+
+    DisplayBenchmark benchmark(iterations);
+    const QVector<BenchmarkResult> results = benchmark.run();
+    for (const BenchmarkResult& result : results)
+        out << result.name << '\t' << result.value << ' ' << result.unit << '\n';
+
+    const QString outputPath = parser.value(outputOption);
+    if (!DisplayBenchmark::writeJson(outputPath, results))
+    {
+        err << "cannot write results: " << outputPath << '\n';
+        return 2;
+    }
+    out << "results written to " << QFileInfo(outputPath).absoluteFilePath() << '\n';
+
+    if (update)
+    {
+        if (!DisplayBenchmark::writeJson(baselinePath, results))
+        {
+            err << "cannot write baseline: " << baselinePath << '\n';
+            return 2;
+        }
+        out << "baseline updated: " << baselinePath << '\n';
+        return 0;
+    }
+    if (baselinePath.isEmpty())
+        return 0;
+
+    const QStringList regressions = DisplayBenchmark::compare(results, baseline, tolerance);
+    if (regressions.isEmpty())
+    {
+        out << "no regressions against " << baselinePath << '\n';
+        return 0;
+    }
+    err << regressions.size() << " regression(s) against " << baselinePath << ':' << '\n';
+    for (const QString& regression : regressions)
+        err << "  " << regression << '\n';
+    return 1;
+}
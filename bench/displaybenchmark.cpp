@@ -0,0 +1,394 @@
+/**
+ * @file displaybenchmark.cpp
+ * @author ldk
+ * @brief 图像显示控件的离屏性能测量与基线对比
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <QBoxLayout>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMouseEvent>
+#include <QPair>
+#include <QTimer>
+#include <QWidget>
+
+#include "displaybenchmark.hpp"
+#include "graphicsview.hpp"
+#include "graphicsviewinterface.hpp"
+#include "imageplayer.hpp"
+#include "pixelconvert.hpp"
+#include "pixelconvertreference.hpp"
+#include "resample.hpp"
+
+namespace
+{
+
+const QSize VIEW_SIZE(1280, 800);  // 离屏视图尺寸
+
+/* 生成确定的渐变测试图像 */
+QImage testImage(const QSize& size, QImage::Format format)
+{
+    QImage image(size, QImage::Format_RGB32);
+    for (int y = 0; y < size.height(); ++y)
+    {
+        QRgb* row = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < size.width(); ++x)
+            row[x] = qRgb(x & 0xFF, y & 0xFF, (x + y) & 0xFF);
+    }
+    return format == QImage::Format_RGB32 ? image : image.convertToFormat(format);
+}
+
+QString formatName(QImage::Format format)
+{
+    switch (format)
+    {
+    case QImage::Format_RGB32:
+        return "RGB32";
+    case QImage::Format_Grayscale8:
+        return "Gray8";
+    default:
+        return "Gray16";
+    }
+}
+
+/* 生成确定的相机原始帧数据，NV12 包含色度平面 */
+QByteArray testRawData(const QSize& size, PixelFormat format)
+{
+    const int stride = minimumStride(format, size.width());
+    const int rows = format == PixelFormat::NV12 ? size.height() * 3 / 2 : size.height();
+    QByteArray data(stride * rows, Qt::Uninitialized);
+    for (int y = 0; y < rows; ++y)
+    {
+        char* row = data.data() + qsizetype(y) * stride;
+        for (int x = 0; x < stride; ++x)
+            row[x] = char((x * 7 + y * 13) & 0xFF);
+    }
+    return data;
+}
+
+QString sizeName(const QSize& size)
+{
+    return QString("%1x%2").arg(size.width()).arg(size.height());
+}
+
+/* 运行 count 次，返回每次的平均毫秒数 */
+template <typename Function>
+double measure(int count, Function&& function)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < count; ++i)
+        function(i);
+    return timer.nsecsElapsed() / 1e6 / count;
+}
+
+/* 离屏宿主控件 */
+struct Host
+{
+    QWidget                 widget;
+    QVBoxLayout*            layout;
+    GraphicsViewInterface*  view;
+    GraphicsView*           graphicsView;
+
+    Host()
+        : layout(new QVBoxLayout(&widget))
+        , view(new GraphicsViewInterface(layout, &widget))
+        , graphicsView(widget.findChild<GraphicsView*>())
+    {
+        widget.resize(VIEW_SIZE);
+        widget.show();
+    }
+    ~Host() { delete view; }
+
+    /* 执行动态模式计时器的一次刷新并绘制，不等待计时器 */
+    void present()
+    {
+        graphicsView->setImage();
+        widget.grab();
+    }
+};
+
+} // namespace
+
+DisplayBenchmark::DisplayBenchmark(int iterations)
+    : m_nIterations(qMax(1, iterations))
+    , m_sizes{ QSize(640, 480), QSize(1920, 1080), QSize(5472, 3648) }
+{}
+
+QVector<BenchmarkResult> DisplayBenchmark::run() const
+{
+    QVector<BenchmarkResult> results;
+    QVector<QImage::Format> formats{ QImage::Format_RGB32, QImage::Format_Grayscale8 };
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+    formats.append(QImage::Format_Grayscale16);
+#endif
+
+    // setImage 吞吐量与每幅图像的内存
+    for (const QSize& size : m_sizes)
+    {
+        // 大图减少迭代次数
+        const int count = qMax(3, int(m_nIterations * 640. * 480. / (size.width() * double(size.height())) * 4));
+        const int iterations = qMin(count, m_nIterations);
+        for (QImage::Format format : formats)
+        {
+            const QString suffix = formatName(format) + "/" + sizeName(size);
+            const QImage image = testImage(size, format);
+
+            Host host;
+            const double staticTime = measure(iterations, [&](int) { host.view->setImage(image); });
+            results.append({ "setImage/static/" + suffix, staticTime, "ms" });
+
+            const QImage& display = host.view->displayImage();
+            qint64 bytes = host.view->getImage().sizeInBytes();
+            if (display.cacheKey() != host.view->getImage().cacheKey())
+                bytes += display.sizeInBytes();
+            results.append({ "memory/" + suffix, bytes / (1024. * 1024.), "MB" });
+
+            // 动态模式计入刷新时的显示映射与绘制，交替送入两帧使每次都是新的图像
+            const QImage frames[2] = { image, image.copy() };
+            host.view->DynamicMode();
+            host.view->setImage(frames[1]);
+            host.present();
+            const double dynamicTime = measure(iterations, [&](int i)
+            {
+                host.view->setImage(frames[i % 2]);
+                host.present();
+            });
+            results.append({ "setImage/dynamic/" + suffix, dynamicTime, "ms" });
+            host.view->StaticMode();
+        }
+    }
+
+    // 各缩放倍数与平移的绘制耗时，使用最大的图像
+    {
+        Host host;
+        const QSize size = m_sizes.isEmpty() ? QSize(1920, 1080) : m_sizes.last();
+        host.view->setImage(testImage(size, QImage::Format_RGB32));
+        const QPointF center(size.width() / 2., size.height() / 2.);
+        for (double zoom : { 0.01, 0.1, 0.5, 1., 8., 50. })
+        {
+            host.view->setViewTransform(QTransform::fromScale(zoom, zoom), center);
+            host.widget.grab();  // 预热，生成多级纹理
+            const double time = measure(m_nIterations, [&](int) { host.widget.grab(); });
+            results.append({ QString("paint/zoom/%1").arg(zoom), time, "ms" });
+        }
+        const double time = measure(m_nIterations, [&](int i)
+        {
+            host.view->setViewTransform(QTransform(), center + QPointF(i * 7 % 200, i * 3 % 200));
+            host.widget.grab();
+        });
+        results.append({ "paint/pan", time, "ms" });
+    }
+
+    // 重采样与 QImage::scaled 对比：4K 生成缩略图、2000 万像素缩小到视图尺寸
+    {
+        const QPair<QSize, QSize> cases[] = {
+            { QSize(3840, 2160), QSize(160, 90) },
+            { QSize(5472, 3648), VIEW_SIZE }
+        };
+        for (const auto& item : cases)
+        {
+            const QImage image = testImage(item.first, QImage::Format_RGB32);
+            const QString suffix = sizeName(item.first) + "->" + sizeName(item.second);
+            const int iterations = qMax(3, m_nIterations / 3);
+            double time = measure(iterations, [&](int)
+            {
+                image.scaled(item.second, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            });
+            results.append({ "scale/qt/" + suffix, time, "ms" });
+            const QPair<ResampleFilter, const char*> filters[] = {
+                { ResampleFilter::Box, "box" },
+                { ResampleFilter::Bilinear, "bilinear" },
+                { ResampleFilter::Lanczos, "lanczos" }
+            };
+            for (const auto& filter : filters)
+            {
+                time = measure(iterations, [&](int) { resample(image, item.second, Qt::KeepAspectRatio, filter.first); });
+                results.append({ QString("scale/%1/").arg(filter.second) + suffix, time, "ms" });
+            }
+        }
+    }
+
+    // 相机原始帧转换：SIMD 并行实现与逐像素标量实现对比
+    {
+        const QPair<PixelFormat, const char*> rawFormats[] = {
+            { PixelFormat::Mono8, "Mono8" },
+            { PixelFormat::BayerRG8, "BayerRG8" },
+            { PixelFormat::YUYV, "YUYV" },
+            { PixelFormat::NV12, "NV12" }
+        };
+        for (const QSize& size : { QSize(1920, 1080), QSize(5472, 3648) })
+        {
+            const int iterations = qMax(3, m_nIterations / 3);
+            for (const auto& format : rawFormats)
+            {
+                const QByteArray data = testRawData(size, format.first);
+                RawFrame frame;
+                frame.data = reinterpret_cast<const uchar*>(data.constData());
+                frame.width = size.width();
+                frame.height = size.height();
+                frame.format = format.first;
+
+                const QString suffix = QString("%1/").arg(format.second) + sizeName(size);
+                QImage simd, scalar;
+                double time = measure(iterations, [&](int) { convertToRgb32(frame, simd); });
+                results.append({ "convert/simd/" + suffix, time, "ms" });
+                time = measure(iterations, [&](int) { convertToRgb32Reference(frame, scalar); });
+                results.append({ "convert/scalar/" + suffix, time, "ms" });
+                if (simd != scalar)
+                    qWarning("DisplayBenchmark: SIMD conversion differs from the scalar reference for %s",
+                             qPrintable(suffix));
+
+                // 相机原始帧的完整显示链路：转换、刷新与绘制
+                Host host;
+                host.view->DynamicMode();
+                host.view->setImage(frame);
+                host.present();
+                time = measure(iterations, [&](int)
+                {
+                    host.view->setImage(frame);
+                    host.present();
+                });
+                results.append({ "setImage/dynamic/raw/" + suffix, time, "ms" });
+            }
+        }
+    }
+
+    // A/B 比较：2000 万像素的整幅差值与统计，以及 1:1 视图只合成可见分块
+    {
+        const QSize size(5472, 3648);
+        const QImage a = testImage(size, QImage::Format_RGB32);
+        QImage b = a.copy();
+        for (int y = size.height() / 3; y < size.height() / 2; ++y)
+        {
+            uchar* line = b.scanLine(y);
+            for (int x = 0; x < size.width() * 4; x += 4)
+                line[x] = uchar(255 - line[x]);
+        }
+        const QString suffix = sizeName(size);
+        const int iterations = qMax(3, m_nIterations / 3);
+        double time = measure(iterations, [&](int) { absoluteDifference(a, b); });
+        results.append({ "compare/diff/" + suffix, time, "ms" });
+        time = measure(iterations, [&](int)
+        {
+            ImageComparator comparator;
+            comparator.setImages(a, b);
+            comparator.statistics();
+        });
+        results.append({ "compare/statistics/" + suffix, time, "ms" });
+
+        Host host;
+        host.view->setCompareImages(a, b);
+        host.view->setViewTransform(QTransform(), QPointF(size.width() / 2., size.height() / 2.));
+        time = measure(iterations, [&](int i)
+        {
+            host.view->setCompareImages(a, b);
+            host.view->setCompareMode(i % 2 ? CompareMode::Mask : CompareMode::Heatmap);
+            host.widget.grab();
+        });
+        results.append({ "compare/view/" + suffix, time, "ms" });
+    }
+
+    // 像素信息更新：合成的鼠标移动事件经 GraphicsView::mouseMoveEvent 与合并计时器到达 setPosInfo，
+    // 每个显示周期送入 MovesPerFrame 个事件，合并为一次更新；计时器间隔置零，不计入等待时间
+    {
+        constexpr int MovesPerFrame{ 16 };
+        ImagePlayer player;
+        player.resize(VIEW_SIZE);
+        player.show();
+        player.setImage(testImage(QSize(1920, 1080), QImage::Format_RGB32));
+        GraphicsView* graphicsView = player.findChild<GraphicsView*>();
+        QTimer* posTimer = player.findChild<QTimer*>("posInfoTimer");
+        if (graphicsView && posTimer)
+        {
+            posTimer->setInterval(0);
+            QWidget* viewport = graphicsView->viewport();
+            const auto move = [viewport](const QPoint& pos)
+            {
+                QMouseEvent event(QEvent::MouseMove, pos, viewport->mapToGlobal(pos), Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+                QCoreApplication::sendEvent(viewport, &event);
+            };
+            const double time = measure(m_nIterations * 10, [&](int i)
+            {
+                for (int j = 0; j < MovesPerFrame; ++j)
+                    move(QPoint((i * 37 + j * 5) % viewport->width(), (i * 11 + j * 3) % viewport->height()));
+                while (posTimer->isActive())
+                    QCoreApplication::processEvents();
+            });
+            results.append({ QString("mouseMove/%1").arg(MovesPerFrame), time * 1000., "us" });
+        }
+    }
+    return results;
+}
+
+QJsonObject DisplayBenchmark::toJson(const QVector<BenchmarkResult>& results)
+{
+    QJsonArray array;
+    for (const BenchmarkResult& result : results)
+    {
+        QJsonObject item;
+        item["name"] = result.name;
+        item["value"] = result.value;
+        item["unit"] = result.unit;
+        array.append(item);
+    }
+    QJsonObject json;
+    json["qtVersion"] = QString(qVersion());
+    json["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    json["results"] = array;
+    return json;
+}
+
+bool DisplayBenchmark::writeJson(const QString& path, const QVector<BenchmarkResult>& results)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    return file.write(QJsonDocument(toJson(results)).toJson()) > 0;
+}
+
+QJsonObject DisplayBenchmark::readJson(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QJsonObject();
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+/**
+ * @brief 与基线对比
+ *
+ * @param results 本次结果
+ * @param baseline 基线（toJson 的输出）
+ * @param tolerance 允许的相对增幅
+ * @return QStringList 超出允许增幅的测量项说明，为空表示没有回退
+ */
+QStringList DisplayBenchmark::compare(const QVector<BenchmarkResult>& results, const QJsonObject& baseline, double tolerance)
+{
+    QHash<QString, double> base;
+    for (const QJsonValue& value : baseline["results"].toArray())
+        base.insert(value["name"].toString(), value["value"].toDouble());
+
+    QStringList regressions;
+    for (const BenchmarkResult& result : results)
+    {
+        const double reference = base.value(result.name, 0.);
+        if (reference <= 0. || result.value <= reference * (1. + tolerance))
+            continue;
+        regressions.append(QString("%1: %2 -> %3 %4 (+%5%)")
+            .arg(result.name).arg(reference).arg(result.value).arg(result.unit)
+            .arg((result.value / reference - 1.) * 100., 0, 'f', 1));
+    }
+    return regressions;
+}
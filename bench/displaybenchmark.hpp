@@ -0,0 +1,61 @@
+/**
+ * @file displaybenchmark.hpp
+ * @author ldk
+ * @brief 图像显示控件的离屏性能测量与基线对比
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _DISPLAY_BENCHMARK_HPP_
+#define _DISPLAY_BENCHMARK_HPP_
+
+#include <QJsonObject>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief 单项测量结果，数值越小越好
+ */
+struct BenchmarkResult
+{
+    QString name;   // 测量项，如 "setImage/static/RGB32/1920x1080"
+    double  value;  // 测量值
+    QString unit;   // 单位
+};
+
+/**
+ * @brief
+ * 显示控件性能测量，测量静态/动态模式下 setImage 的耗时、各缩放倍数与平移的绘制耗时、
+ * 鼠标移动事件经合并后更新像素信息的耗时、每幅显示图像占用的内存、resample 与 QImage::scaled 的缩小耗时对比，
+ * 以及相机原始帧转换的 SIMD 与标量实现对比。
+ * 需要已创建 QApplication，可在 QT_QPA_PLATFORM=offscreen 下无界面运行；
+ * 结果可写为 JSON，并与之前保存的基线对比以发现性能回退。
+ * 命令行入口为 qttools_display_bench（bench/displaybench.cpp），出现回退时以非零值退出。
+ */
+class DisplayBenchmark
+{
+public:
+    explicit DisplayBenchmark(int iterations = 30);
+    ~DisplayBenchmark() = default;
+
+    inline void setIterations(int iterations) noexcept { m_nIterations = qMax(1, iterations); }
+    inline void setImageSizes(const QVector<QSize>& sizes) { m_sizes = sizes; }
+
+    QVector<BenchmarkResult> run() const;
+
+    static QJsonObject toJson(const QVector<BenchmarkResult>& results);
+    static bool        writeJson(const QString& path, const QVector<BenchmarkResult>& results);
+    static QJsonObject readJson(const QString& path);
+    static QStringList compare(const QVector<BenchmarkResult>& results, const QJsonObject& baseline, double tolerance = 0.1);
+
+private:
+    int             m_nIterations;  // 每项的迭代次数
+    QVector<QSize>  m_sizes;        // 测量的图像尺寸
+};
+
+#endif // !_DISPLAY_BENCHMARK_HPP_
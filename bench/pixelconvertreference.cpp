@@ -0,0 +1,155 @@
+/**
+ * @file pixelconvertreference.cpp
+ * @author ldk
+ * @brief 相机像素格式转换的标量参考实现，用于校验 SIMD 内核与性能对比
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+
+#include "pixelconvertreference.hpp"
+
+namespace
+{
+
+/* 与 SIMD 的 avg 指令一致，向上取整 */
+inline uchar average(uchar a, uchar b)
+{
+    return uchar((a + b + 1) >> 1);
+}
+
+inline void storeBgra(uchar* dst, uchar b, uchar g, uchar r)
+{
+    dst[0] = b;
+    dst[1] = g;
+    dst[2] = r;
+    dst[3] = 0xFF;
+}
+
+/* 定点 BT.601 有限范围转换，系数放大 64 倍 */
+inline void yuvPixel(int y, int u, int v, uchar* dst)
+{
+    const int c = (y - 16) * 75 + 32;
+    const int d = u - 128;
+    const int e = v - 128;
+    const auto clip = [](int value) { return uchar(std::clamp(value >> 6, 0, 255)); };
+    storeBgra(dst, clip(c + d * 129), clip(c - d * 25 - e * 52), clip(c + e * 102));
+}
+
+/* 像素 (x, y) 在 Bayer 阵列中的颜色：0 红，1 与红同行的绿，2 与蓝同行的绿，3 蓝 */
+int bayerColor(PixelFormat format, int x, int y)
+{
+    static const int PATTERNS[4][4] =
+    {
+        { 0, 1, 2, 3 },     // RG
+        { 1, 0, 3, 2 },     // GR
+        { 2, 3, 0, 1 },     // GB
+        { 3, 2, 1, 0 },     // BG
+    };
+    const int index = format == PixelFormat::BayerGR8 ? 1
+                    : format == PixelFormat::BayerGB8 ? 2
+                    : format == PixelFormat::BayerBG8 ? 3 : 0;
+    return PATTERNS[index][(y & 1) * 2 + (x & 1)];
+}
+
+/* 双线性插值，边界按镜像处理以保持颜色相位 */
+void bayerPixel(const uchar* src, int stride, int width, int height, PixelFormat format, int x, int y, uchar* dst)
+{
+    const auto at = [&](int px, int py)
+    {
+        px = px < 0 ? 1 : (px >= width ? width - 2 : px);
+        py = py < 0 ? 1 : (py >= height ? height - 2 : py);
+        return src[qsizetype(py) * stride + px];
+    };
+    const uchar C = at(x, y);
+    const uchar H = average(at(x - 1, y), at(x + 1, y));
+    const uchar V = average(at(x, y - 1), at(x, y + 1));
+    const uchar X = average(H, V);
+    const uchar D = average(average(at(x - 1, y - 1), at(x + 1, y - 1)), average(at(x - 1, y + 1), at(x + 1, y + 1)));
+    switch (bayerColor(format, x, y))
+    {
+    case 0:
+        storeBgra(dst, D, X, C);
+        break;
+    case 1:
+        storeBgra(dst, V, C, H);
+        break;
+    case 2:
+        storeBgra(dst, H, C, V);
+        break;
+    default:
+        storeBgra(dst, C, X, D);
+        break;
+    }
+}
+
+} // namespace
+
+bool convertToRgb32Reference(const RawFrame& frame, QImage& output)
+{
+    if (frame.isNull())
+        return false;
+
+    const int width = frame.width;
+    const int height = frame.height;
+    const int stride = frame.stride > 0 ? frame.stride : minimumStride(frame.format, width);
+    const bool bayer = frame.format != PixelFormat::Mono8 && frame.format != PixelFormat::YUYV
+                    && frame.format != PixelFormat::UYVY && frame.format != PixelFormat::NV12;
+    const bool yuv = frame.format == PixelFormat::YUYV || frame.format == PixelFormat::UYVY
+                  || frame.format == PixelFormat::NV12;
+    if (stride < minimumStride(frame.format, width) || (bayer && (width < 2 || height < 2))
+        || (yuv && width % 2 != 0) || (frame.format == PixelFormat::NV12 && height % 2 != 0))
+        return false;
+
+    if (output.size() != QSize(width, height) || output.format() != QImage::Format_RGB32 || !output.isDetached())
+        output = QImage(width, height, QImage::Format_RGB32);
+    if (output.isNull())
+        return false;
+
+    const uchar* src = frame.data;
+    const int yOffset = frame.format == PixelFormat::UYVY ? 1 : 0;
+    const int uOffset = 1 - yOffset;
+    for (int y = 0; y < height; ++y)
+    {
+        const uchar* row = src + qsizetype(y) * stride;
+        uchar* dst = output.scanLine(y);
+        switch (frame.format)
+        {
+        case PixelFormat::Mono8:
+            for (int x = 0; x < width; ++x)
+            {
+                const uchar gray = frame.lut ? frame.lut[row[x]] : row[x];
+                storeBgra(dst + 4 * x, gray, gray, gray);
+            }
+            break;
+        case PixelFormat::YUYV:
+        case PixelFormat::UYVY:
+            for (int x = 0; x < width; x += 2)
+            {
+                const uchar* p = row + 2 * x;
+                yuvPixel(p[yOffset], p[uOffset], p[uOffset + 2], dst + 4 * x);
+                yuvPixel(p[yOffset + 2], p[uOffset], p[uOffset + 2], dst + 4 * x + 4);
+            }
+            break;
+        case PixelFormat::NV12:
+        {
+            const uchar* uv = src + qsizetype(height + y / 2) * stride;
+            for (int x = 0; x < width; x += 2)
+            {
+                yuvPixel(row[x], uv[x], uv[x + 1], dst + 4 * x);
+                yuvPixel(row[x + 1], uv[x], uv[x + 1], dst + 4 * x + 4);
+            }
+            break;
+        }
+        default:
+            for (int x = 0; x < width; ++x)
+                bayerPixel(src, stride, width, height, frame.format, x, y, dst + 4 * x);
+            break;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,25 @@
+/**
+ * @file pixelconvertreference.hpp
+ * @author ldk
+ * @brief 相机像素格式转换的标量参考实现，用于校验 SIMD 内核与性能对比
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _PIXEL_CONVERT_REFERENCE_HPP_
+#define _PIXEL_CONVERT_REFERENCE_HPP_
+
+#include <QImage>
+
+#include "pixelconvert.hpp"
+
+/**
+ * @brief 将相机原始帧逐像素转换为 RGB32（单线程标量实现）
+ * @remarks 独立于库内的内核实现，结果应与 convertToRgb32 逐字节相同
+ */
+bool convertToRgb32Reference(const RawFrame& frame, QImage& output);
+
+#endif // !_PIXEL_CONVERT_REFERENCE_HPP_
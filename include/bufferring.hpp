@@ -0,0 +1,66 @@
+/**
+ * @file bufferring.hpp
+ * @author ldk
+ * @brief 显示数据的轮换缓冲
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _BUFFER_RING_HPP_
+#define _BUFFER_RING_HPP_
+
+#include <vector>
+
+#include <QImage>
+#include <QRegion>
+
+/**
+ * @brief
+ * 显示数据（显示映射、伪彩色、比较合成）的轮换缓冲。
+ * 显示控件持有最近显示的一帧，原地写入该缓冲会使 QImage 先深拷贝整幅图像；
+ * 轮换缓冲每次写入一个未被共享的缓冲，并记录各缓冲落后于最新一帧的区域，
+ * 取出时从最新一帧只复制这些区域，调用方只需写入本次变化的区域。
+ * 稳定运行时不再分配内存。只能在一个线程中使用。
+ */
+class BufferRing
+{
+public:
+    static constexpr int DefaultCount{ 2 };     // 默认缓冲数：控件显示一个，写入一个
+    static constexpr int MaxStaleRects{ 64 };   // 落后区域的矩形数超过该值时合并为外接矩形
+
+    explicit BufferRing(int count = DefaultCount);
+
+    QImage& acquire(const QSize& size, QImage::Format format, QRegion& region);
+    QImage  take();
+    void    clear();
+    void    releaseSpare();
+
+    /* 最近一次写入的缓冲 */
+    inline const QImage& current() const noexcept { return m_slots[size_t(m_nCurrent)].image; }
+
+    /* 缓冲数 */
+    inline int count() const noexcept { return int(m_slots.size()); }
+
+    /* 第 index 个缓冲，用于统计内存 */
+    inline const QImage& at(int index) const { return m_slots[size_t(index)].image; }
+
+    /* 累计分配次数 */
+    inline quint64 allocations() const noexcept { return m_nAllocations; }
+
+private:
+    struct Slot
+    {
+        QImage  image;          // 缓冲
+        QRegion stale;          // 之后写入其他缓冲的区域
+        bool    full = true;    // 内容整体无效
+    };
+
+    std::vector<Slot>   m_slots;        // 缓冲
+    int                 m_nCurrent;     // 最近一次写入的缓冲
+    quint64             m_nAllocations; // 累计分配次数
+};
+
+#endif // !_BUFFER_RING_HPP_
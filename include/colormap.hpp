@@ -0,0 +1,75 @@
+/**
+ * @file colormap.hpp
+ * @author ldk
+ * @brief 单通道图像的伪彩色映射
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _COLORMAP_HPP_
+#define _COLORMAP_HPP_
+
+#include <QGradientStops>
+#include <QImage>
+#include <QRegion>
+#include <QVector>
+
+/**
+ * @brief 内置颜色表
+ */
+enum class ColormapPreset
+{
+    Jet,        // 蓝 - 青 - 黄 - 红
+    Inferno,    // 黑 - 紫 - 橙 - 浅黄，感知均匀
+    Viridis     // 紫 - 青 - 黄绿，感知均匀
+};
+
+/**
+ * @brief
+ * 伪彩色颜色表，256 项按 8 位显示值索引；65536 项时 Grayscale16 图像按原始值直接索引（不经过显示窗口），
+ * 其他图像按 8 位显示值取其中等间隔的 256 项。颜色表隐式共享，cacheKey() 用于判断是否改变。
+ */
+class Colormap
+{
+public:
+    static constexpr int NarrowSize{ 256 };
+    static constexpr int WideSize{ 65536 };
+
+    Colormap() = default;
+    explicit Colormap(ColormapPreset preset);
+    explicit Colormap(const QVector<QRgb>& table);
+
+    static Colormap fromGradient(const QGradientStops& stops, int size = NarrowSize);
+
+    inline bool                 isNull() const noexcept { return m_table.isEmpty(); }
+    inline bool                 isWide() const noexcept { return m_table.size() == WideSize; }
+    inline const QVector<QRgb>& table() const noexcept { return m_table; }
+    inline const QVector<QRgb>& narrowTable() const noexcept { return m_narrow; }
+    inline qint64               cacheKey() const noexcept { return m_nKey; }
+
+private:
+    void setTable(const QVector<QRgb>& table);
+
+    QVector<QRgb>   m_table;        // 颜色表
+    QVector<QRgb>   m_narrow;       // 按 8 位显示值索引的 256 项颜色表
+    qint64          m_nKey = 0;     // 颜色表标识，每次构造新表时递增
+};
+
+/**
+ * @brief 以颜色表映射图像的指定区域，按行并行
+ * @remarks AVX2 下以 gather 查表；NEON 下 8 位图像按通道以 TBL 指令查表，每次 16 个像素；
+ * SSE2 没有可用于 256 项表的字节重排指令，使用展开的标量查表。
+ * 输出图像尺寸或格式不符、或缓冲区被共享时重新分配并映射整幅图像
+ *
+ * @param image 单通道图像：Grayscale8 按 256 项表映射；Grayscale16 需 65536 项表
+ * @param colormap 颜色表
+ * @param output RGB32 输出图像
+ * @param region 需要映射的区域（图像坐标），为空时映射整幅图像
+ * @return bool 图像格式与颜色表不匹配时返回 false
+ */
+bool applyColormap(const QImage& image, const Colormap& colormap, QImage& output, const QRegion& region = QRegion());
+
+#endif // !_COLORMAP_HPP_
@@ -0,0 +1,77 @@
+/**
+ * @file displaymapping.hpp
+ * @author ldk
+ * @brief 高位深图像的窗宽窗位显示映射
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _DISPLAY_MAPPING_HPP_
+#define _DISPLAY_MAPPING_HPP_
+
+#include <QImage>
+#include <QRegion>
+
+#include "floatimage.hpp"
+
+/**
+ * @brief 显示窗口
+ * 原始值 v 映射为 255 * t^(1/gamma)，其中 t = clamp((v - low) / (high - low), 0, 1)
+ */
+struct DisplayWindow
+{
+    double low   = 0.;      // 映射为 0 的原始值
+    double high  = 65535.;  // 映射为 255 的原始值
+    double gamma = 1.;      // 伽马
+
+    inline double window() const noexcept { return high - low; }
+    inline double level() const noexcept { return (high + low) / 2.; }
+
+    /* 由窗宽窗位构造 */
+    static inline
+    DisplayWindow fromWindowLevel(double window, double level, double gamma = 1.)
+    {
+        return DisplayWindow{ level - window / 2., level + window / 2., gamma };
+    }
+};
+
+/**
+ * @brief 是否为需要经过显示映射的高位深图像
+ */
+bool isHighBitDepth(const QImage& image) noexcept;
+
+/**
+ * @brief 计算高位深灰度图像的取值范围（并行）
+ *
+ * @return bool 图像是否为高位深灰度图像且非空
+ */
+bool imageRange(const QImage& image, double& min, double& max);
+
+/**
+ * @brief 将 Grayscale16 图像按显示窗口映射为 Grayscale8（SIMD 并行）
+ *
+ * @param image 原始图像
+ * @param window 显示窗口
+ * @param display 输出图像，尺寸与格式匹配且未被共享时复用其缓冲区
+ */
+void mapToDisplay(const QImage& image, const DisplayWindow& window, QImage& display);
+
+/**
+ * @brief 将浮点图像按显示窗口映射为 Grayscale8（SIMD 并行），NaN 映射为 0
+ */
+void mapToDisplay(const FloatImage& image, const DisplayWindow& window, QImage& display);
+
+/**
+ * @brief 只映射 region 内的像素，display 中其余像素保持不变
+ *
+ * @param region 变化区域，display 尺寸或格式不符、或缓冲区被共享时忽略并映射整幅图像
+ */
+void mapToDisplay(const QImage& image, const DisplayWindow& window, QImage& display, const QRegion& region);
+
+/* 只映射浮点图像 region 内的像素 */
+void mapToDisplay(const FloatImage& image, const DisplayWindow& window, QImage& display, const QRegion& region);
+
+#endif // !_DISPLAY_MAPPING_HPP_
@@ -0,0 +1,100 @@
+/**
+ * @file displaystatistics.hpp
+ * @author ldk
+ * @brief 显示链路的延迟与帧率统计
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _DISPLAY_STATISTICS_HPP_
+#define _DISPLAY_STATISTICS_HPP_
+
+#include <array>
+#include <mutex>
+
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief 生产者提供的帧信息
+ */
+struct FrameInfo
+{
+    quint64 sequence  = 0;  // 生产者的帧序号
+    qint64  timestamp = 0;  // 生产时间（纳秒，DisplayStatistics::now() 时钟），0 表示未知
+};
+
+/**
+ * @brief 一帧在显示链路各阶段的时间戳（纳秒）
+ */
+struct FrameTiming
+{
+    quint64   frameNumber = 0;  // 显示控件的帧序号
+    FrameInfo info;             // 生产者的帧信息
+    qint64    received  = 0;    // 进入 setImage
+    qint64    converted = 0;    // 转换（像素格式或显示映射）完成
+    qint64    presented = 0;    // 绘制完成
+};
+
+/**
+ * @brief 滚动窗口内的统计结果，时间单位为毫秒
+ */
+struct DisplayStats
+{
+    double      fps = 0.;               // 最近一秒的实际显示帧率
+    quint64     presented = 0;          // 已显示的帧数
+    quint64     dropped = 0;            // 到达后未被显示就被覆盖的帧数
+    quint64     duplicated = 0;         // 刷新时没有新帧、重复显示的次数
+    double      latencyP50 = 0.;        // 进入 setImage 到绘制完成的延迟
+    double      latencyP90 = 0.;
+    double      latencyP99 = 0.;
+    double      latencyMax = 0.;
+    double      producerLatencyP50 = 0.;  // 生产时间到绘制完成的延迟，未提供生产时间时为 0
+    double      producerLatencyP99 = 0.;
+    double      convertP50 = 0.;        // 转换耗时
+    FrameTiming lastFrame;              // 最近显示的一帧
+
+    QString toString() const;
+};
+
+/**
+ * @brief
+ * 显示链路统计，线程安全：
+ * 帧到达时（任意线程）记录到达与转换时间，显示刷新时检测丢帧与重复帧，
+ * 绘制完成后记录显示时间，延迟与帧率在最近的窗口内统计。
+ */
+class DisplayStatistics
+{
+public:
+    static constexpr int Window{ 512 };     // 统计窗口的帧数
+
+    static qint64 now() noexcept;
+
+    void setFrameInfo(const FrameInfo& info);
+    FrameInfo takeFrameInfo();
+    void frameReceived(quint64 frameNumber, qint64 received, qint64 converted);
+    void frameConverted(quint64 frameNumber, qint64 converted);
+    void frameScheduled(quint64 frameNumber);
+    void framePresented(qint64 presented);
+    DisplayStats snapshot() const;
+    void reset();
+
+private:
+    static constexpr int Pending{ 64 };     // 等待显示的帧记录数
+
+    mutable std::mutex              m_mutex;
+    FrameInfo                       m_nextInfo;             // 下一帧的生产者信息
+    std::array<FrameTiming, Pending> m_pending{};           // 按帧序号取模存放
+    quint64                         m_nScheduled = 0;       // 等待绘制的帧序号
+    quint64                         m_nLastScheduled = 0;   // 上一次刷新显示的帧序号
+    quint64                         m_nPresented = 0;
+    quint64                         m_nDropped = 0;
+    quint64                         m_nDuplicated = 0;
+    std::array<FrameTiming, Window> m_history{};            // 最近显示的帧
+    int                             m_nHistory = 0;         // 已写入的帧数，取模为写入位置
+};
+
+#endif // !_DISPLAY_STATISTICS_HPP_
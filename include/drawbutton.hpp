@@ -42,8 +42,13 @@ public slots:
 	inline const QPointF& getStartPoint() const noexcept { return m_start; }
 	inline const QPointF& getStopPoint() const noexcept { return m_stop; }
 
+signals:
+	/* 框选区域改变，拖动过程中持续发出，坐标为屏幕坐标 */
+	void selectionChanged(const QPoint& globalStart, const QPoint& globalStop);
+
 protected slots:
 	void setPoints();
+	void updateSelection();
 
 protected:
 	QWidget*    m_pCanvas;
@@ -31,6 +31,7 @@ public:
     ~DrawWidget() = default;
 
 signals:
+    void drawChanged();
     void drawFinished();
 
 protected:
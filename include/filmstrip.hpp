@@ -0,0 +1,133 @@
+/**
+ * @file filmstrip.hpp
+ * @author ldk
+ * @brief 虚拟化的缩略图浏览控件
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _FILMSTRIP_HPP_
+#define _FILMSTRIP_HPP_
+
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+
+#include <QAbstractListModel>
+#include <QCache>
+#include <QImage>
+#include <QListView>
+#include <QThreadPool>
+
+class ImagePlayer;
+
+/**
+ * @brief 生成缩略图
+ * @remarks 优先使用 JPEG 内嵌的 EXIF 缩略图，其次通过 QImageReader::setScaledSize 按缩小后的尺寸解码
+ * （JPEG 在解码时即以 DCT 缩放，无需解码全尺寸图像），都不支持时加载原图后缩小
+ *
+ * @param path 图像路径
+ * @param size 缩略图最长边
+ * @return QImage 加载失败时为空
+ */
+QImage createThumbnail(const QString& path, int size);
+
+/**
+ * @brief
+ * 缩略图列表模型。
+ * 视图只对可见的行调用 data()，模型在此时才把该行加入解码队列，
+ * 后台线程池按"最近请求优先"的顺序生成缩略图，并以 路径 + 修改时间 为键保存在磁盘缓存中，
+ * 再次打开同一文件夹时直接读取缓存。
+ */
+class FilmstripModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultThumbnailSize{ 128 };   // 默认缩略图最长边
+    static constexpr int MaxPendingRequests{ 256 };     // 排队请求上限，超出时丢弃最早的请求
+
+    enum Roles
+    {
+        PathRole = Qt::UserRole + 1     // 文件路径
+    };
+
+    explicit FilmstripModel(QObject* parent = nullptr);
+    ~FilmstripModel();
+
+    bool setDirectory(const QString& directory, const QStringList& nameFilters = QStringList());
+    void setFiles(const QStringList& files);
+    void setThumbnailSize(int size);
+    void setCacheDirectory(const QString& directory);
+    void setThreadCount(int count);
+
+    int      rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    inline const QStringList& files() const noexcept { return m_files; }
+    inline int     thumbnailSize() const noexcept { return m_nThumbnailSize; }
+
+private:
+    struct Request
+    {
+        int     row         = 0;
+        QString path;
+        quint64 generation  = 0;
+        int     size        = 0;
+    };
+
+    void request(int row) const;
+    void drain();
+    void finish(const Request& request, const QImage& thumbnail);
+
+    static QImage  loadThumbnail(const QString& path, int size, const QString& cacheDirectory);
+    static QString cachePath(const QString& path, int size, const QString& cacheDirectory);
+
+    QStringList                     m_files;            // 文件列表
+    mutable QCache<int, QImage>     m_thumbnails;       // 已生成的缩略图，以行号为键
+    mutable std::mutex              m_mutex;            // 保护请求队列
+    mutable std::deque<Request>     m_requests;         // 等待生成的请求
+    mutable std::unordered_set<int> m_requested;        // 已请求、尚未完成的行
+    quint64                         m_nGeneration;      // 文件列表版本，用于丢弃过期结果
+    int                             m_nThumbnailSize;   // 缩略图最长边
+    QString                         m_cacheDirectory;   // 磁盘缓存目录，为空时不使用磁盘缓存
+    QImage                          m_placeholder;      // 缩略图生成前显示的占位图
+    mutable QThreadPool             m_pool;             // 缩略图线程池
+};
+
+/**
+ * @brief
+ * 胶片条控件，横向排列文件夹中的缩略图。
+ * 所有行的尺寸相同，视图只布局并请求可见的行，数万个文件也能立即打开。
+ * 点击缩略图发出 imageActivated，并在设置了 ImagePlayer 时显示该图像。
+ */
+class FilmstripWidget : public QListView
+{
+    Q_OBJECT
+
+public:
+    explicit FilmstripWidget(QWidget* parent = nullptr);
+
+    bool setDirectory(const QString& directory, const QStringList& nameFilters = QStringList());
+    void setFiles(const QStringList& files);
+    void setThumbnailSize(int size);
+    void setPlayer(ImagePlayer* player);
+
+    inline FilmstripModel* filmstripModel() const noexcept { return m_pModel; }
+    inline ImagePlayer*    player() const noexcept { return m_pPlayer; }
+
+signals:
+    void imageActivated(const QString& path, int index);
+
+private slots:
+    void activate(const QModelIndex& index);
+
+private:
+    FilmstripModel* m_pModel;   // 缩略图模型
+    ImagePlayer*    m_pPlayer;  // 显示选中图像的播放器
+};
+
+#endif // !_FILMSTRIP_HPP_
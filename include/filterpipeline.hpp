@@ -0,0 +1,131 @@
+/**
+ * @file filterpipeline.hpp
+ * @author ldk
+ * @brief 显示前的异步图像处理流水线
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _FILTER_PIPELINE_HPP_
+#define _FILTER_PIPELINE_HPP_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QImage>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+#include "displaystatistics.hpp"
+
+/**
+ * @brief 流水线中流转的一帧
+ */
+struct FilterFrame
+{
+    QImage      image;          // 图像
+    FrameInfo   info;           // 生产者的帧信息
+    qint64      received = 0;   // 进入流水线的时间（DisplayStatistics::now() 时钟）
+};
+
+/**
+ * @brief 单个处理阶段的统计，时间单位为毫秒
+ */
+struct FilterStageStatistics
+{
+    QString name;               // 阶段名称
+    quint64 processed   = 0;    // 已处理的帧数
+    quint64 dropped     = 0;    // 等待期间被新帧覆盖或处理函数拒绝的帧数
+    double  lastMs      = 0.;   // 最近一帧的处理耗时
+    double  meanMs      = 0.;   // 平均处理耗时
+    double  maxMs       = 0.;   // 最大处理耗时
+};
+
+/**
+ * @brief 流水线统计
+ */
+struct FilterPipelineStatistics
+{
+    quint64 received    = 0;    // 送入的帧数
+    quint64 delivered   = 0;    // 输出的帧数
+    double  latencyMs   = 0.;   // 最近一帧从送入到输出的耗时
+    double  latencyMaxMs = 0.;  // 最大耗时
+    std::vector<FilterStageStatistics> stages;  // 各阶段统计
+
+    QString toString() const;
+};
+
+/**
+ * @brief
+ * 显示前的图像处理流水线（模糊、阈值、锐化、平场校正等）。
+ * 每个阶段同一时刻至多处理一帧，各阶段在线程池中独立运行：第 N 个阶段处理第 k 帧时，
+ * 第 N-1 个阶段可以同时处理第 k+1 帧。阶段忙碌时只保留最新到达的一帧，旧帧丢弃，
+ * 因此处理跟不上帧率时延迟不会累积。
+ * 每个阶段的输出缓冲在帧离开流水线、不再被引用后回收，下一帧作为 output 传给处理函数，
+ * 尺寸与格式不变时可以直接写入而不重新分配（见 prepareBuffer）。
+ * 可通过 GraphicsViewInterface::setFilterPipeline() 接入显示控件，控件只显示流水线的输出。
+ */
+class FilterPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 处理函数，在线程池中调用，同一阶段不会并发调用
+     *
+     * @param input 输入图像，只读
+     * @param output 输出图像，为该阶段回收的缓冲（可能为空或尺寸不符）
+     * @return bool 返回 false 或输出为空时丢弃该帧
+     */
+    using Filter = std::function<bool(const QImage& input, QImage& output)>;
+    using OutputCallback = std::function<void(const FilterFrame& frame)>;
+
+    static constexpr int BufferCount{ 3 };  // 每个阶段回收的输出缓冲数
+
+    explicit FilterPipeline(QObject* parent = nullptr);
+    ~FilterPipeline();
+
+    int  addStage(const QString& name, Filter filter);
+    void clearStages();
+    void setStageEnabled(int index, bool enabled);
+    bool isStageEnabled(int index) const;
+    int  stageCount() const;
+
+    bool push(const QImage& image, const FrameInfo& info = FrameInfo(), qint64 received = 0);
+    void setOutputCallback(OutputCallback callback);
+    void waitForIdle();
+
+    FilterPipelineStatistics statistics() const;
+    void resetStatistics();
+
+    static bool prepareBuffer(QImage& buffer, const QSize& size, QImage::Format format);
+
+private:
+    struct Stage;
+
+    void reconfigure(const std::function<void()>& change);
+    void schedule(int index, FilterFrame frame, int owner);
+    void run(int index, FilterFrame frame, int owner, quint64 generation);
+    void finish(FilterFrame frame, int owner);
+    void recycle(int owner, QImage image);
+
+    mutable std::mutex                  m_mutex;            // 保护阶段的调度状态与统计
+    std::vector<std::unique_ptr<Stage>> m_stages;           // 处理阶段
+    quint64                             m_nGeneration;      // 阶段配置的版本，改变后正在运行的任务不再传递
+    bool                                m_bReconfiguring;   // 是否正在修改阶段配置
+    quint64                             m_nReceived;        // 送入的帧数
+    quint64                             m_nDelivered;       // 输出的帧数
+    qint64                              m_nLatencyNs;       // 最近一帧的耗时
+    qint64                              m_nLatencyMaxNs;    // 最大耗时
+    std::mutex                          m_outputMutex;      // 保护输出回调
+    OutputCallback                      m_output;           // 输出回调
+    QThreadPool                         m_pool;             // 处理线程池，线程数等于阶段数
+};
+
+#endif // !_FILTER_PIPELINE_HPP_
@@ -0,0 +1,59 @@
+/**
+ * @file floatimage.hpp
+ * @author ldk
+ * @brief 单通道 32 位浮点图像（深度图等）
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _FLOAT_IMAGE_HPP_
+#define _FLOAT_IMAGE_HPP_
+
+#include <QSize>
+#include <QVector>
+
+/**
+ * @brief
+ * QImage 没有单通道浮点格式，FloatImage 作为其配套的缓冲区类型保存原始浮点数据。
+ * 与 QImage 一样采用隐式共享，拷贝不复制像素，写访问时才分离。
+ */
+class FloatImage
+{
+public:
+    FloatImage() = default;
+    FloatImage(int width, int height);
+    FloatImage(const float* data, int width, int height, int stride = 0);
+
+    bool minMax(float& min, float& max) const;
+
+    inline bool   isNull() const noexcept { return m_data.isEmpty(); }
+    inline int    width() const noexcept { return m_nWidth; }
+    inline int    height() const noexcept { return m_nHeight; }
+    inline QSize  size() const noexcept { return QSize(m_nWidth, m_nHeight); }
+    inline qint64 sizeInBytes() const noexcept { return qint64(m_data.size()) * sizeof(float); }
+
+    inline
+    bool valid(int x, int y) const noexcept
+    {
+        return x >= 0 && y >= 0 && x < m_nWidth && y < m_nHeight;
+    }
+
+    inline
+    const float* constScanLine(int y) const { return m_data.constData() + qint64(y) * m_nWidth; }
+
+    inline
+    float* scanLine(int y) { return m_data.data() + qint64(y) * m_nWidth; }
+
+    inline
+    float value(int x, int y) const { return constScanLine(y)[x]; }
+
+private:
+    int            m_nWidth = 0;    // 宽度
+    int            m_nHeight = 0;   // 高度
+    QVector<float> m_data;          // 按行连续存储的像素
+};
+
+#endif // !_FLOAT_IMAGE_HPP_
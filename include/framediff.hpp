@@ -0,0 +1,30 @@
+/**
+ * @file framediff.hpp
+ * @author ldk
+ * @brief 相邻帧的分块差异检测
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _FRAME_DIFF_HPP_
+#define _FRAME_DIFF_HPP_
+
+#include <QImage>
+#include <QRegion>
+
+/**
+ * @brief 按分块比较两帧，返回发生变化的分块组成的区域（SIMD 并行）
+ * @remarks 同一行中相邻的变化分块合并为一个矩形
+ *
+ * @param previous 上一帧
+ * @param current 当前帧
+ * @param tileSize 分块边长
+ * @param threshold 逐字节差值超过该值才视为变化，0 表示任何差异
+ * @return QRegion 尺寸或格式不同时返回整幅图像
+ */
+QRegion changedTiles(const QImage& previous, const QImage& current, int tileSize = 64, int threshold = 0);
+
+#endif // !_FRAME_DIFF_HPP_
@@ -0,0 +1,75 @@
+/**
+ * @file framepool.hpp
+ * @author ldk
+ * @brief 动态显示的帧缓冲池
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _FRAME_POOL_HPP_
+#define _FRAME_POOL_HPP_
+
+#include <memory>
+
+#include <QImage>
+
+/**
+ * @brief 帧缓冲池统计
+ */
+struct FramePoolStatistics
+{
+    quint64 acquired    = 0;    // 取出次数
+    quint64 allocated   = 0;    // 新分配的缓冲数
+    quint64 freed       = 0;    // 因空闲缓冲过多或尺寸不再使用而释放的缓冲数
+    int     inUse       = 0;    // 正在使用的缓冲数
+    int     peakInUse   = 0;    // 同时使用的缓冲数峰值
+    int     idle        = 0;    // 空闲缓冲数
+    qint64  bytes       = 0;    // 全部缓冲的字节数（使用中 + 空闲）
+    qint64  peakBytes   = 0;    // 字节数峰值
+
+    /* 取出时复用已有缓冲的比例 */
+    inline double reuseRatio() const noexcept { return acquired ? 1. - double(allocated) / double(acquired) : 0.; }
+};
+
+/**
+ * @brief
+ * 帧缓冲池：取出的 QImage 包装池中的缓冲，像素起始地址与每行字节数按 64 字节对齐，
+ * 新缓冲分配时即逐页写零，避免显示时才触发缺页。
+ * 图像的最后一个副本（包括显示控件、录制队列与处理流水线中的副本）释放时，
+ * 缓冲经 QImage 的释放函数自动归还，稳定运行时不再分配像素内存。
+ * 池对象可以先于取出的图像析构，之后归还的缓冲直接释放。所有接口均线程安全。
+ */
+class FramePool
+{
+public:
+    static constexpr int Alignment{ 64 };           // 缓冲与每行的对齐字节数
+    static constexpr int DefaultMaxIdle{ 8 };       // 默认保留的空闲缓冲数
+
+    explicit FramePool(int maxIdle = DefaultMaxIdle);
+    ~FramePool();
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    QImage acquire(const QSize& size, QImage::Format format);
+    void   reserve(const QSize& size, QImage::Format format, int count);
+    void   setMaxIdle(int count);
+    void   trim();
+    void   resetStatistics();
+    FramePoolStatistics statistics() const;
+
+    static qsizetype alignedBytesPerLine(int width, QImage::Format format);
+
+private:
+    struct State;
+    struct Buffer;
+
+    static void release(void* info);
+
+    std::shared_ptr<State> m_pState;    // 与取出的图像共享，池析构后仍可接收归还的缓冲
+};
+
+#endif // !_FRAME_POOL_HPP_
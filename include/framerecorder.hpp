@@ -0,0 +1,191 @@
+/**
+ * @file framerecorder.hpp
+ * @author ldk
+ * @brief 动态显示帧的后台录制
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _FRAME_RECORDER_HPP_
+#define _FRAME_RECORDER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <QFile>
+#include <QImage>
+#include <QObject>
+#include <QThreadPool>
+
+/**
+ * @brief 录制统计
+ */
+struct RecorderStatistics
+{
+    quint64 received    = 0;    // 送入的帧数
+    quint64 written     = 0;    // 已写入的帧数
+    quint64 dropped     = 0;    // 因队列已满丢弃的帧数
+    quint64 bytes       = 0;    // 已写入的字节数
+    qint64  blockedNs   = 0;    // Block 策略下生产者累计等待的时间（纳秒）
+    int     queued      = 0;    // 当前排队的帧数
+    int     peakQueued  = 0;    // 排队帧数峰值
+};
+
+/**
+ * @brief
+ * 后台帧录制器。
+ * push() 只把隐式共享的 QImage 放入有界队列（不复制像素），编码与写入在线程池中进行。
+ * 支持三种输出：
+ * Raw 为未压缩的像素数据，Mjpeg 为首尾相接的 JPEG 数据，二者都附带 <path>.idx 索引，
+ * 可由 RecordingReader 直接定位任意一帧；ImageSequence 在目录中逐帧写出图像文件。
+ * 队列已满时按策略丢弃新帧（Drop）或阻塞调用 push() 的线程（Block）。
+ * 可通过 GraphicsViewInterface::setRecorder() 录制显示的每一帧。
+ */
+class FrameRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Format
+    {
+        Raw,            // 未压缩像素 + 索引
+        Mjpeg,          // JPEG 数据流 + 索引
+        ImageSequence   // 目录中的逐帧图像文件
+    };
+
+    enum class Policy
+    {
+        Drop,           // 队列已满时丢弃新帧
+        Block           // 队列已满时阻塞生产者
+    };
+
+    static constexpr int DefaultCapacity{ 32 };     // 默认队列长度
+    static constexpr int DefaultWorkerCount{ 2 };   // 默认编码线程数
+    static constexpr int DefaultQuality{ 90 };      // 默认 JPEG 质量
+
+    explicit FrameRecorder(QObject* parent = nullptr);
+    ~FrameRecorder();
+
+    bool start(const QString& path, Format format = Format::Raw);
+    void stop();
+    bool push(const QImage& frame, quint64 frameNumber, qint64 timestamp);
+
+    void setPolicy(Policy policy);
+    void setCapacity(int capacity);
+    void setWorkerCount(int count);
+    void setQuality(int quality);
+    void setImageFormat(const QByteArray& format);
+    void resetStatistics();
+
+    RecorderStatistics statistics() const;
+    QString errorString() const;
+
+    inline bool   isRecording() const noexcept { return m_bRecording.load(std::memory_order_acquire); }
+    inline Format format() const noexcept { return m_Format; }
+    inline Policy policy() const noexcept { return m_Policy; }
+    inline int    capacity() const noexcept { return m_nCapacity; }
+    inline int    workerCount() const noexcept { return m_nWorkerCount; }
+
+signals:
+    /* 写入失败，录制已停止 */
+    void errorOccurred(const QString& message);
+
+private:
+    struct Entry
+    {
+        QImage  image;
+        quint64 sequence    = 0;
+        quint64 frameNumber = 0;
+        qint64  timestamp   = 0;
+    };
+
+    struct Encoded
+    {
+        Entry       entry;
+        QByteArray  header;     // Raw 的帧头
+        QByteArray  data;       // 帧数据，Raw 时直接引用图像像素
+    };
+
+    void work();
+    void process(Entry entry);
+    void commit(Encoded encoded);
+    bool writeFrame(const Encoded& encoded);
+    void fail(const QString& message);
+
+    mutable std::mutex          m_queueMutex;       // 保护队列
+    std::condition_variable     m_notEmpty;         // 队列非空
+    std::condition_variable     m_notFull;          // 队列未满
+    std::deque<Entry>           m_queue;            // 待编码的帧
+    bool                        m_bStopping;        // 是否正在停止
+    int                         m_nPeakQueued;      // 排队帧数峰值
+    quint64                     m_nSequence;        // 下一帧的录制序号
+
+    std::mutex                  m_writeMutex;       // 保护输出文件
+    std::map<quint64, Encoded>  m_pending;          // 已编码、等待按顺序写入的帧
+    quint64                     m_nNextWrite;       // 下一个写入的录制序号
+    QFile                       m_dataFile;         // 数据文件
+    QFile                       m_indexFile;        // 索引文件
+
+    mutable std::mutex          m_errorMutex;       // 保护错误信息
+    QString                     m_Error;            // 最近的错误
+
+    std::atomic_bool            m_bRecording;       // 是否正在录制
+    std::atomic_bool            m_bFailed;          // 是否因写入失败而停止
+    std::atomic<quint64>        m_nReceived;        // 送入的帧数
+    std::atomic<quint64>        m_nWritten;         // 写入的帧数
+    std::atomic<quint64>        m_nDropped;         // 丢弃的帧数
+    std::atomic<quint64>        m_nBytes;           // 写入的字节数
+    std::atomic<qint64>         m_nBlockedNs;       // 生产者等待的时间
+
+    QString                     m_Path;             // 输出路径
+    QByteArray                  m_ImageFormat;      // ImageSequence 的图像格式
+    Format                      m_Format;           // 输出格式
+    Policy                      m_Policy;           // 队列已满时的策略
+    int                         m_nCapacity;        // 队列长度
+    int                         m_nWorkerCount;     // 编码线程数
+    int                         m_nQuality;         // 编码质量
+    QThreadPool                 m_pool;             // 编码线程池
+};
+
+/**
+ * @brief
+ * 读取 FrameRecorder 以 Raw 或 Mjpeg 格式录制的文件，
+ * 通过索引直接定位任意一帧，无需从头解析。
+ */
+class RecordingReader
+{
+public:
+    RecordingReader() = default;
+
+    bool   open(const QString& path);
+    void   close();
+    QImage frame(int index);
+
+    inline bool    isOpen() const noexcept { return m_dataFile.isOpen(); }
+    inline int     frameCount() const noexcept { return int(m_index.size()); }
+    inline quint64 frameNumber(int index) const { return m_index[index].frameNumber; }
+    inline qint64  timestamp(int index) const { return m_index[index].timestamp; }
+    inline FrameRecorder::Format format() const noexcept { return m_Format; }
+
+private:
+    struct IndexEntry
+    {
+        quint64 frameNumber = 0;
+        qint64  timestamp   = 0;
+        quint64 offset      = 0;
+        quint64 size        = 0;
+    };
+
+    QFile                   m_dataFile;     // 数据文件
+    std::vector<IndexEntry> m_index;        // 帧索引
+    FrameRecorder::Format   m_Format = FrameRecorder::Format::Raw;
+};
+
+#endif // !_FRAME_RECORDER_HPP_
@@ -0,0 +1,71 @@
+/**
+ * @file framesource.hpp
+ * @author ldk
+ * @brief 帧源接口
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _FRAME_SOURCE_HPP_
+#define _FRAME_SOURCE_HPP_
+
+#include <functional>
+#include <mutex>
+
+#include <QImage>
+
+#include "displaystatistics.hpp"
+#include "pixelconvert.hpp"
+
+/**
+ * @brief 帧格式
+ */
+struct FrameFormat
+{
+    QSize           size;                                   // 帧尺寸
+    QImage::Format  format  = QImage::Format_Grayscale8;    // 承载帧数据的图像格式
+    PixelFormat     pixel   = PixelFormat::Mono8;           // 像素排列，Bayer 时帧为 Grayscale8 承载的马赛克数据
+    double          fps     = 30.;                          // 帧率
+
+    inline bool isBayer() const noexcept { return pixel >= PixelFormat::BayerRG8 && pixel <= PixelFormat::BayerBG8; }
+};
+
+/**
+ * @brief
+ * 帧源接口，相机、共享内存、模拟器等按此接口向显示端推送帧。
+ * 使用方先 negotiate() 请求格式并以返回值为准，再设置回调并 start()；
+ * 回调可能在帧源自己的线程中调用，不应阻塞。
+ */
+class FrameSource
+{
+public:
+    using FrameCallback = std::function<void(const QImage& frame, const FrameInfo& info)>;
+
+    virtual ~FrameSource() = default;
+
+    /**
+     * @brief 协商帧格式
+     *
+     * @param requested 请求的格式
+     * @return FrameFormat 帧源实际采用的格式，不支持的部分调整为最接近的取值；运行中调用时返回当前格式
+     */
+    virtual FrameFormat negotiate(const FrameFormat& requested) = 0;
+    virtual FrameFormat format() const = 0;
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    virtual bool isRunning() const = 0;
+
+    void setFrameCallback(FrameCallback callback);
+
+protected:
+    void deliver(const QImage& frame, const FrameInfo& info);
+
+private:
+    std::mutex      m_callbackMutex;    // 保证回调替换后不再调用旧回调
+    FrameCallback   m_callback;         // 帧回调
+};
+
+#endif // !_FRAME_SOURCE_HPP_
@@ -16,6 +16,9 @@
 #include <QGraphicsView>
 
 class GraphicsViewInterface;
+class ImageItem;
+class OverlayItem;
+class RegionItem;
 
 class GraphicsView : public QGraphicsView
 {
@@ -32,6 +35,8 @@ public:
 	~GraphicsView();
 
     void setImage();
+    void refreshImage();
+    void refreshOverlay();
 
     inline int    width() { return viewport()->width(); }
     inline int    height() { return viewport()->height(); }
@@ -40,6 +45,11 @@ public:
     inline void   setMinZoom(double minZoom) { m_dMinZoom = minZoom; }
     inline void   setMaxZoom(double maxZoom) { m_dMaxZoom = maxZoom; }
     inline QPoint getMousePosition() { return m_qtLastMousePos; }
+    inline ImageItem* imageItem() const noexcept { return m_pImageItem; }
+    inline OverlayItem* overlayItem() const noexcept { return m_pOverlayItem; }
+    inline RegionItem* regionItem() const noexcept { return m_pRegionItem; }
+    inline bool   isHudVisible() const noexcept { return m_bHudVisible; }
+    inline void   setHudVisible(bool visible) { m_bHudVisible = visible; viewport()->update(); }
     inline void   dynamicMode(int _time) { m_pTimer->start(_time); }
     inline void   staticMode() { m_pTimer->stop(); }
 
@@ -48,6 +58,8 @@ protected:
     virtual void mouseMoveEvent(QMouseEvent*) override;
     virtual void mouseReleaseEvent(QMouseEvent*) override;
     virtual void wheelEvent(QWheelEvent*) override;
+    virtual void paintEvent(QPaintEvent*) override;
+    virtual void drawForeground(QPainter* painter, const QRectF& rect) override;
 
 public slots:
     void ZoomIn() { Zoom(1.05); }
@@ -56,12 +68,22 @@ public slots:
     void Translate(QPointF);
 
 private:
+    static constexpr int SplitGrip{ 5 };         // 拖动分割线的可选中距离（屏幕像素）
+
+    bool isSplitVisible() const;
+    int  splitViewX() const;
+    void drawSplitLine(QPainter* painter);
+
     bool                    m_bIsTranslate;      // 是否通过鼠标对图像进行仿射变换操作
+    bool                    m_bDraggingSplit;    // 是否正在拖动 A/B 分割线
+    bool                    m_bHudVisible;       // 是否显示帧率与延迟统计
     double                  m_dMaxZoom;          // 图像缩放最大倍数
     double                  m_dMinZoom;          // 图像缩放最小倍数
     QPoint                  m_qtLastMousePos;    // 鼠标最后落在位置
     QGraphicsScene*         m_pScene;            // 放置图像控件地场景
-    QGraphicsPixmapItem*    m_pImageItem;        // 放置图像的控件
+    ImageItem*              m_pImageItem;        // 放置图像的控件
+    OverlayItem*            m_pOverlayItem;      // 叠加层
+    RegionItem*             m_pRegionItem;       // 按区域解码的超大图像
     QTimer*                 m_pTimer;            // 用于动态更新图像的计时器
     GraphicsViewInterface*  m_pController;       // 接口控件
 };
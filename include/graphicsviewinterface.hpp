@@ -13,11 +13,43 @@
 #define _GRAPHICS_CONTROLLER_HPP_
 
 #include <atomic>
+#include <memory>
+#include <mutex>
 
 #include <QImage>
+#include <QRegion>
+#include <QTransform>
+
+#include "bufferring.hpp"
+#include "colormap.hpp"
+#include "displaymapping.hpp"
+#include "displaystatistics.hpp"
+#include "filterpipeline.hpp"
+#include "floatimage.hpp"
+#include "framepool.hpp"
+#include "imagecompare.hpp"
+#include "overlayitem.hpp"
+#include "pixelconvert.hpp"
+#include "regiondecoder.hpp"
 
 class QBoxLayout;
+class FrameRecorder;
 class GraphicsView;
+class ImageCache;
+
+/**
+ * @brief 显示控件的内存占用（字节），多处引用的同一块像素数据只计一次
+ */
+struct ViewMemoryReport
+{
+    qint64  sourceBytes  = 0;   // 源图像：当前图像、浮点图像、相机帧转换缓冲、A/B 比较的两幅图像
+    qint64  displayBytes = 0;   // 显示数据：显示映射、伪彩色、A/B 合成、多级纹理与重采样图像
+    qint64  cacheBytes   = 0;   // 图像缓存（可能由多个控件共享）与区域解码的概览图、分块
+
+    inline qint64 total() const noexcept { return sourceBytes + displayBytes + cacheBytes; }
+
+    QString toString() const;
+};
 
 /**
  * @brief 
@@ -45,6 +77,14 @@ public:
         double        minZoom = 0.005,
         double        maxZoom = 200
     );
+    explicit GraphicsViewInterface
+    (
+        QBoxLayout*   panel,
+        QImage&&      image,
+        QWidget*      parent = nullptr,
+        double        minZoom = 0.005,
+        double        maxZoom = 200
+    );
     ~GraphicsViewInterface();
 
     void    Init(QBoxLayout* panel);
@@ -57,8 +97,119 @@ public:
     void    DynamicMode(int _RefreshTime = 15);
     void    StaticMode();
     void    setImageStatically(const QImage& _image);
+    void    setImageStatically(QImage&& _image);
     void    setImageStatically(const QString& _path);
+    void    setImageStatically(const FloatImage& _image);
+    void    setImageDynamically(const FloatImage& _image);
+    void    setSharedImage(const QImage& _image);
+    bool    setSharedImage(const uchar* data, int width, int height, qsizetype bytesPerLine,
+                           QImage::Format format, std::shared_ptr<const void> owner);
+    QImage  acquireFrame(const QSize& size, QImage::Format format);
+    void    setImageDynamically(const QImage& _image);
+    void    setImage(const QImage& _image, const QRegion& _dirty);
+    bool    setImage(const RawFrame& _frame);
+    void    setAutoDirtyDetection(bool enabled, int tileSize = 64, int threshold = 0);
     QPoint  getIamgePosition(const QPoint& _pos);
+    QRect   visibleImageRect() const;
+    QPoint  mapGlobalToImage(const QPoint& _global) const;
+    QTransform viewTransform() const;
+    QPointF viewCenter() const;
+    void    setViewTransform(const QTransform& transform, const QPointF& center);
+
+    void    setDisplayWindow(const DisplayWindow& window);
+    void    setDisplayWindow(double low, double high);
+    void    setWindowLevel(double window, double level);
+    void    setGamma(double gamma);
+    void    setAutoWindow(bool enabled);
+    void    setColormap(const Colormap& colormap);
+    void    setRetainSource(bool retain);
+    void    setRegionDecoding(bool enabled, qint64 threshold = RegionDecoder::DefaultThreshold);
+    ViewMemoryReport memoryReport() const;
+    double  getPositionValue() const noexcept;
+    bool    getPositionRgb(QRgb& rgb) const noexcept;
+    int     getNeighborhoodValues(int size, QVector<double>& values) const;
+    void    getRegionValues(const QRect& rect, QVector<double>& values) const;
+    void    setPixelGridVisible(bool visible);
+    void    setPixelValuesVisible(bool visible);
+    void    setOverlay(OverlayFrame _overlay);
+    void    clearOverlay();
+    OverlayHit overlayHitTest(const QPointF& _pos, double tolerance = 3) const;
+    void    setHudVisible(bool visible);
+    bool    isHudVisible() const noexcept;
+    bool    setCompareImages(const QImage& a, const QImage& b);
+    void    setCompareMode(CompareMode mode);
+    void    setCompareThreshold(int threshold);
+    void    setSplitPosition(double position);
+    void    clearCompare();
+    void    setFilterPipeline(FilterPipeline* pipeline);
+
+    /* 是否处于 A/B 比较模式 */
+    inline
+    bool isCompareActive() const noexcept { return !m_comparator.isNull(); }
+
+    /* 获取比较的显示方式 */
+    inline
+    CompareMode compareMode() const noexcept { return m_comparator.mode(); }
+
+    /* 获取分割位置（相对宽度） */
+    inline
+    double splitPosition() const noexcept { return m_comparator.splitPosition(); }
+
+    /* 获取整幅图像的差值统计，首次调用时计算 */
+    inline
+    CompareStatistics compareStatistics() const { return m_comparator.statistics(); }
+
+    /**
+     * @brief 设置下一次 setImage 的生产者帧信息，用于端到端延迟统计
+     *
+     * @param info 帧序号与生产时间（DisplayStatistics::now() 时钟）
+     */
+    inline
+    void setFrameInfo(const FrameInfo& info) { m_statistics.setFrameInfo(info); }
+
+    /* 获取显示链路统计 */
+    inline
+    DisplayStats displayStatistics() const { return m_statistics.snapshot(); }
+
+    /* 重置显示链路统计 */
+    inline
+    void resetDisplayStatistics() { m_statistics.reset(); }
+    const QImage& displayImage();
+
+    static QImage loadImage(const QString& _path);
+
+    /**
+     * @brief 设置图像缓存，setImageStatically(path) 将优先从缓存获取图像
+     *
+     * @param cache 图像缓存，为空时不使用缓存，所有权不转移
+     */
+    inline
+    void setImageCache(ImageCache* cache) noexcept { m_pImageCache = cache; }
+
+    /* 获取图像缓存 */
+    inline
+    ImageCache* imageCache() const noexcept { return m_pImageCache; }
+
+    /**
+     * @brief 设置录制器，此后每一帧图像都送入录制器的队列
+     * @remarks 只增加图像的引用计数，编码在录制器的线程池中进行；浮点图像不录制
+     *
+     * @param recorder 录制器，为空时停止送入，所有权不转移
+     */
+    inline
+    void setRecorder(FrameRecorder* recorder) noexcept { m_pRecorder.store(recorder, std::memory_order_release); }
+
+    /* 获取录制器 */
+    inline
+    FrameRecorder* recorder() const noexcept { return m_pRecorder.load(std::memory_order_acquire); }
+
+    /* 获取处理流水线 */
+    inline
+    FilterPipeline* filterPipeline() const noexcept { return m_pPipeline.load(std::memory_order_acquire); }
+
+    /* 获取动态显示的帧缓冲池 */
+    inline
+    FramePool& framePool() noexcept { return m_framePool; }
 
     /* 是否动态显示模式 */
     inline
@@ -80,6 +231,72 @@ public:
     inline
     const QImage& getImage() noexcept { return m_qtImage; }
 
+    /**
+     * @brief 获取当前浮点图像
+     *
+     * @return const FloatImage& 当前显示的不是浮点图像时为空
+     */
+    inline
+    const FloatImage& getFloatImage() const noexcept { return m_floatImage; }
+
+    /**
+     * @brief 获取帧序号，每设置一次图像加一
+     *
+     * @return quint64 帧序号
+     */
+    inline
+    quint64 frameNumber() const noexcept { return m_nFrameNumber.load(std::memory_order_acquire); }
+
+    /* 是否有图像 */
+    inline
+    bool hasImage() const noexcept { return !m_qtImage.isNull() || !m_floatImage.isNull() || isRegionActive(); }
+
+    /* 是否开启了超大图像的区域解码 */
+    inline
+    bool isRegionDecoding() const noexcept { return m_bRegionDecoding; }
+
+    /* 当前是否显示按区域解码的图像，此时 getImage() 为空，像素读数不可用 */
+    inline
+    bool isRegionActive() const noexcept
+    {
+        return m_pRegionDecoder && m_pRegionDecoder->isOpen() && m_qtImage.isNull() && m_floatImage.isNull();
+    }
+
+    /* 获取区域解码器 */
+    inline
+    RegionDecoder* regionDecoder() const noexcept { return m_pRegionDecoder; }
+
+    /* 当前图像是否需要经过窗宽窗位映射显示（Grayscale16 或浮点图像） */
+    inline
+    bool isHighBitDepth() const noexcept { return !m_floatImage.isNull() || ::isHighBitDepth(m_qtImage); }
+
+    /* 获取显示窗口 */
+    inline
+    const DisplayWindow& displayWindow() const noexcept { return m_displayWindow; }
+
+    /* 是否根据图像取值范围自动设置显示窗口 */
+    inline
+    bool isAutoWindow() const noexcept { return m_bAutoWindow; }
+
+    /* 获取伪彩色颜色表，为空时按灰度显示 */
+    inline
+    const Colormap& colormap() const noexcept { return m_colormap; }
+
+    /* 静态模式下高位深或伪彩色图像生成显示数据后是否保留源图像 */
+    inline
+    bool isSourceRetained() const noexcept { return m_bRetainSource; }
+
+    /* 像素读数是否为原始值：不保留源图像且源图像已被显示数据代替时为 false */
+    inline
+    bool hasRawValues() const noexcept { return !m_bSourceReleased.load(std::memory_order_relaxed); }
+
+    /* 当前图像是否以伪彩色显示（单通道图像且设置了颜色表） */
+    inline
+    bool isColormapActive() const noexcept
+    {
+        return !m_colormap.isNull() && (isHighBitDepth() || m_qtImage.format() == QImage::Format_Grayscale8);
+    }
+
     /**
      * @brief 设置图像
      *
@@ -94,6 +311,21 @@ public:
             setImageStatically(_image);
     }
 
+    /**
+     * @brief 设置图像，接管图像数据，静态模式下也不深拷贝
+     * @remarks 调用方不得再通过其他副本或原始指针修改其像素
+     *
+     * @param image 待展示的图像
+     */
+    inline
+    void setImage(QImage&& _image)
+    {
+        if (m_bDynamically.load(std::memory_order_acquire))
+            setImageDynamically(_image);
+        else
+            setImageStatically(std::move(_image));
+    }
+
     /**
      * @brief 设置图像
      *
@@ -103,12 +335,18 @@ public:
     void setImage(const QString& _path) { setImageStatically(_path); }
 
     /**
-     * @brief 动态设置图像
+     * @brief 设置浮点图像
      *
-     * @param image 待展示图像的路径
+     * @param image 待展示的浮点图像
      */
     inline
-    void setImageDynamically(const QImage& _image) { m_qtImage = _image; }
+    void setImage(const FloatImage& _image)
+    {
+        if (m_bDynamically.load(std::memory_order_acquire))
+            setImageDynamically(_image);
+        else
+            setImageStatically(_image);
+    }
 
     /**
      * @brief 设置当前鼠标位置
@@ -134,21 +372,70 @@ public:
     inline
     QColor getPositionColor() const noexcept
     {
-        if (!m_qtImage.isNull())
-            return m_qtImage.pixelColor(m_Position);
-        else
-            return QColor();
+        QRgb rgb;
+        return getPositionRgb(rgb) ? QColor::fromRgba(rgb) : QColor();
     }
     
 signals:
     void mouseMoveEvent();
+    /* 通过鼠标缩放或平移了视图 */
+    void viewChanged();
+    /* 左键点击了叠加层中的形状 */
+    void overlayClicked(const OverlayHit& hit);
 
 private:
+    bool takeOverlay(OverlayFrame& _overlay);
+    bool takeViewRegion(QRegion& _region);
+    void markNewFrame(qint64 received = 0, const QRegion* dirty = nullptr);
+    void invalidateDisplay();
+    const QImage& compareImage();
+    void refreshCompare();
+    bool filterFrame(const QImage& _image, qint64 received = 0);
+    void presentFiltered();
+
     friend class        GraphicsView;
     std::atomic_bool    m_bDynamically;    // 是否动态更新图像
     GraphicsView*       m_pWidget;         // 用于操作绘图的控件
     QImage              m_qtImage;         // 当前显示图像
+    FloatImage          m_floatImage;      // 当前显示的浮点图像
+    BufferRing          m_displayBuffers;  // 高位深图像的 8 位显示映射，轮换写入不与控件共享
+    DisplayWindow       m_displayWindow;   // 高位深图像的显示窗口
+    bool                m_bAutoWindow;     // 是否自动设置显示窗口
+    Colormap            m_colormap;        // 伪彩色颜色表
+    BufferRing          m_colorBuffers;    // 单通道图像的伪彩色显示，轮换写入不与控件共享
+    bool                m_bColorFull;      // 伪彩色是否需要整幅重新查表
+    bool                m_bRetainSource;   // 静态模式下生成显示数据后是否保留源图像
+    std::atomic_bool    m_bSourceReleased; // 源图像是否已被显示数据代替，此时没有原始值读数
+    RegionDecoder*      m_pRegionDecoder;  // 超大图像的区域解码器
+    bool                m_bRegionDecoding; // 是否开启区域解码
+    qint64              m_nRegionThreshold; // 启用区域解码的最小像素数
+    std::atomic_bool    m_bDisplayDirty;   // 显示映射是否需要重新计算
+    std::atomic<quint64> m_nFrameNumber;   // 帧序号
+    std::mutex          m_dirtyMutex;      // 保护变化区域
+    QRegion             m_mapRegion;       // 显示映射待重新计算的区域
+    QRegion             m_viewRegion;      // 控件待重绘的区域
+    bool                m_bMapFull;        // 显示映射是否需要整幅重新计算
+    bool                m_bViewFull;       // 控件是否需要整幅重绘
+    bool                m_bAutoDirty;      // 是否自动检测相邻帧的变化区域
+    int                 m_nDirtyTileSize;  // 自动检测的分块边长
+    int                 m_nDirtyThreshold; // 自动检测的逐通道差值阈值
+    QImage              m_dirtyReference;  // 自动检测时调用线程保存的上一帧，只在调用线程访问
+    ImageCache*         m_pImageCache;     // 图像缓存
+    std::atomic<FrameRecorder*> m_pRecorder; // 录制器
+    std::atomic<FilterPipeline*> m_pPipeline; // 显示前的处理流水线
+    std::mutex          m_filterMutex;     // 保护待显示的流水线输出
+    FilterFrame         m_filteredFrame;   // 待显示的流水线输出
+    bool                m_bFilteredPending; // 是否已投递显示流水线输出的事件
+    FramePool           m_framePool;       // 动态显示与相机原始帧转换的帧缓冲池
+    std::mutex          m_overlayMutex;    // 保护待显示的叠加层
+    OverlayFrame        m_pendingOverlay;  // 待显示的叠加层
+    bool                m_bOverlayDirty;   // 是否有待显示的叠加层
+    DisplayStatistics   m_statistics;      // 显示链路统计
+    ImageComparator     m_comparator;      // A/B 比较，未比较时为空
     mutable QPoint      m_Position;        // 当前像素点颜色
+    mutable std::atomic_bool m_bMemoryDirty; // 源图像或显示数据是否改变，需要重新统计内存
+    mutable qint64      m_nMemoryImageKey; // 统计内存时控件图像的 cacheKey
+    mutable ViewMemoryReport m_memoryReport; // 源图像与显示数据的内存统计
 };
 
 
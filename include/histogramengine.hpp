@@ -0,0 +1,103 @@
+/**
+ * @file histogramengine.hpp
+ * @author ldk
+ * @brief 图像直方图的并行计算与限频更新
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _HISTOGRAM_ENGINE_HPP_
+#define _HISTOGRAM_ENGINE_HPP_
+
+#include <array>
+
+#include <QImage>
+#include <QObject>
+#include <QRect>
+#include <QThreadPool>
+
+class GraphicsViewInterface;
+class QTimer;
+
+/**
+ * @brief 各通道 256 级直方图
+ * 灰度图像只有一个通道，Grayscale16 在整幅图像的实际取值范围内均匀分级，彩色图像依次为 R、G、B
+ */
+struct Histogram
+{
+    static constexpr int Bins{ 256 };
+    using Channel = std::array<quint32, Bins>;
+
+    int                    channelCount = 0;    // 通道数
+    std::array<Channel, 3> counts{};            // 各通道计数
+    double                 minimum = 0.;        // 第一级对应的像素值
+    double                 maximum = 255.;      // 最后一级对应的像素值
+    quint64                frameNumber = 0;     // 对应的帧序号
+    QRect                  region;              // 统计的图像区域
+
+    inline bool isNull() const noexcept { return channelCount == 0; }
+};
+
+/**
+ * @brief 按行分段并行统计直方图，每段使用独立的局部直方图最后合并
+ *
+ * @param image 图像
+ * @param region 统计区域，为空时统计整幅图像
+ * @return Histogram 直方图
+ */
+Histogram computeHistogram(const QImage& image, const QRect& region = QRect());
+
+/**
+ * @brief
+ * 直方图引擎，按显示帧率轮询 GraphicsViewInterface，
+ * 只有帧序号或统计区域改变时才在后台线程重新计算，同一时刻至多一个计算任务，
+ * 计算期间到来的更新只保留最新的一次。
+ */
+class HistogramEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Region
+    {
+        Frame,      // 整幅图像
+        Viewport    // 视口中可见的区域
+    };
+
+    explicit HistogramEngine(GraphicsViewInterface* source, QObject* parent = nullptr, int interval = 33);
+    ~HistogramEngine();
+
+    void setEnabled(bool enabled);
+    void setRegion(Region region);
+    void setUpdateInterval(int interval);
+
+    inline bool             isEnabled() const noexcept { return m_bEnabled; }
+    inline Region           region() const noexcept { return m_Region; }
+    inline const Histogram& histogram() const noexcept { return m_Histogram; }
+
+signals:
+    void histogramReady(const Histogram& histogram);
+
+private slots:
+    void poll();
+
+private:
+    void start(const QImage& image, const QRect& region, quint64 frameNumber);
+    void finish(const Histogram& histogram);
+
+    GraphicsViewInterface*  m_pSource;          // 图像来源
+    QTimer*                 m_pTimer;           // 轮询计时器
+    Region                  m_Region;           // 统计区域
+    Histogram               m_Histogram;        // 最近一次的结果
+    quint64                 m_nFrameNumber;     // 最近一次请求的帧序号
+    QRect                   m_LastRegion;       // 最近一次请求的区域
+    bool                    m_bEnabled;         // 是否启用
+    bool                    m_bBusy;            // 是否有计算任务
+    bool                    m_bPending;         // 计算期间是否有新的请求
+    QThreadPool             m_pool;             // 计算线程
+};
+
+#endif // !_HISTOGRAM_ENGINE_HPP_
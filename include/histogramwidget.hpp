@@ -0,0 +1,49 @@
+/**
+ * @file histogramwidget.hpp
+ * @author ldk
+ * @brief 直方图显示控件
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _HISTOGRAM_WIDGET_HPP_
+#define _HISTOGRAM_WIDGET_HPP_
+
+#include <QWidget>
+
+#include "histogramengine.hpp"
+
+/**
+ * @brief 按通道绘制直方图曲线，单通道为灰色，三通道依次为红、绿、蓝
+ */
+class HistogramWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit HistogramWidget(QWidget* parent = nullptr);
+    ~HistogramWidget() = default;
+
+    inline
+    const Histogram& histogram() const noexcept { return m_Histogram; }
+
+    inline
+    bool isLogScale() const noexcept { return m_bLogScale; }
+
+    void setLogScale(bool enabled);
+
+public slots:
+    void setHistogram(const Histogram& histogram);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    Histogram   m_Histogram;    // 显示的直方图
+    bool        m_bLogScale;    // 是否使用对数纵轴
+};
+
+#endif // !_HISTOGRAM_WIDGET_HPP_
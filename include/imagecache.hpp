@@ -0,0 +1,113 @@
+/**
+ * @file imagecache.hpp
+ * @author ldk
+ * @brief 已解码图像的 LRU 缓存，支持内存预算与按浏览方向预取
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _IMAGE_CACHE_HPP_
+#define _IMAGE_CACHE_HPP_
+
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+
+/**
+ * @brief 缓存命中统计
+ */
+struct ImageCacheStatistics
+{
+    quint64 hits        = 0;    // 命中次数
+    quint64 misses      = 0;    // 未命中次数（同步解码）
+    quint64 prefetched  = 0;    // 后台预取完成的图像数
+    quint64 evictions   = 0;    // 因超出预算被淘汰的图像数
+    qint64  bytes       = 0;    // 当前占用字节数
+    qint64  budget      = 0;    // 字节预算
+    int     entries     = 0;    // 当前缓存的图像数
+
+    inline
+    double hitRate() const noexcept
+    {
+        const quint64 total = hits + misses;
+        return total == 0 ? 0. : double(hits) / total;
+    }
+};
+
+/**
+ * @brief
+ * 以 路径 + 修改时间 为键缓存已解码的图像，超过字节预算时淘汰最久未使用的图像。
+ * prefetch() 会在后台线程池中按浏览方向预先解码相邻文件，
+ * 使前后翻页时直接命中缓存。所有接口均线程安全。
+ */
+class ImageCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr qint64 DefaultBudget{ qint64(512) << 20 };  // 默认预算 512 MB
+    static constexpr int    DefaultPrefetchCount{ 2 };           // 默认预取数量
+
+    explicit ImageCache(qint64 budget = DefaultBudget, QObject* parent = nullptr);
+    ~ImageCache();
+
+    QImage image(const QString& path);
+    bool   contains(const QString& path) const;
+    void   prefetch(const QStringList& files, int current, int direction);
+    void   cancelPrefetch();
+    void   clear();
+    void   setBudget(qint64 bytes);
+    void   setPrefetchCount(int count);
+    void   setPrefetchThreadCount(int count);
+    void   resetStatistics();
+
+    ImageCacheStatistics statistics() const;
+
+    inline qint64 budget() const noexcept { return m_nBudget; }
+    inline int    prefetchCount() const noexcept { return m_nPrefetchCount; }
+
+private:
+    struct Entry
+    {
+        QString key;
+        QImage  image;
+        qint64  bytes;
+    };
+    using EntryList = std::list<Entry>;
+
+    /* std::hash<QString> 自 Qt 5.14 起才提供，以 qHash 代替 */
+    struct KeyHash
+    {
+        inline size_t operator()(const QString& key) const noexcept { return size_t(qHash(key)); }
+    };
+
+    static QString cacheKey(const QString& path);
+
+    void insert(const QString& key, const QImage& image, bool mostRecent = true);
+    void evict();
+    void prefetchOne(const QString& path);
+
+    mutable std::mutex                             m_mutex;
+    std::condition_variable                        m_loaded;       // 后台解码完成通知
+    EntryList                                      m_entries;      // 按使用时间排序，头部最新
+    std::unordered_map<QString, EntryList::iterator, KeyHash> m_index; // 键到缓存项的索引
+    std::unordered_set<QString, KeyHash>           m_pending;      // 正在解码的键
+    qint64                                         m_nBudget;      // 字节预算
+    qint64                                         m_nBytes;       // 当前占用字节数
+    int                                            m_nPrefetchCount; // 浏览方向上的预取数量
+    ImageCacheStatistics                           m_statistics;   // 命中统计
+    QThreadPool                                    m_pool;         // 预取线程池
+};
+
+#endif // !_IMAGE_CACHE_HPP_
@@ -0,0 +1,73 @@
+/**
+ * @file imageitem.hpp
+ * @author ldk
+ * @brief 按缩放倍数选择绘制方式的图像控件
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _IMAGE_ITEM_HPP_
+#define _IMAGE_ITEM_HPP_
+
+#include <memory>
+
+#include <QGraphicsItem>
+#include <QImage>
+#include <QRegion>
+
+class GraphicsViewInterface;
+struct MipChain;
+
+/**
+ * @brief
+ * 图像控件，替代 QGraphicsPixmapItem：
+ * 缩小时使用预先计算的 2x2 盒式滤波多级纹理（mipmap），再把相邻一级中暴露的区域重采样到屏幕分辨率，
+ * 多级纹理在图像到达时于线程池中生成，绘制时使用已生成的最合适的一级，
+ * 显示同一幅图像（相同 cacheKey）的多个控件共享同一组多级纹理；
+ * 放大时只绘制可见区域的源像素并使用最近邻插值，
+ * 放大到一定倍数后可叠加像素网格与像素原始值。
+ */
+class ImageItem : public QGraphicsItem
+{
+public:
+    static constexpr double GridZoom{ 8. };     // 显示像素网格的最小缩放倍数
+    static constexpr double TextZoom{ 40. };    // 显示像素值的最小缩放倍数
+    static constexpr qint64 MaxRefinedPixels{ qint64(16) << 20 };  // 缩小时重采样到屏幕分辨率的最大像素数
+
+    explicit ImageItem(QGraphicsItem* parent = nullptr);
+    ~ImageItem();
+
+    void setImage(const QImage& image);
+    void setImage(const QImage& image, const QRegion& region);
+    void setPixelGridVisible(bool visible);
+    void setPixelValuesVisible(bool visible, const GraphicsViewInterface* source = nullptr);
+    qint64 cacheBytes() const;
+
+    inline const QImage& image() const noexcept { return m_image; }
+    inline bool isPixelGridVisible() const noexcept { return m_bGridVisible; }
+    inline bool isPixelValuesVisible() const noexcept { return m_pValueSource != nullptr; }
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
+
+private:
+    void drawPixelGrid(QPainter* painter, const QRect& pixels);
+    void drawPixelValues(QPainter* painter, const QRect& pixels);
+    void setMipChain(std::shared_ptr<MipChain> chain);
+
+    QImage                          m_image;        // 原图
+    std::shared_ptr<MipChain>       m_pMipChain;    // 多级纹理，按需生成
+    QImage                          m_scaled;       // 缩小时暴露区域重采样到屏幕分辨率的图像
+    qint64                          m_nScaledKey;   // m_scaled 对应的多级纹理 cacheKey
+    double                          m_dScaledZoom;  // m_scaled 对应的缩放倍数
+    QRect                           m_ScaledArea;   // m_scaled 覆盖的该级纹理范围
+    QSize                           m_ScaledSize;   // m_scaled 中有效的范围，缓冲可能更大
+    double                          m_dZoom;        // 最近一次绘制的缩放倍数
+    bool                            m_bGridVisible; // 是否显示像素网格
+    const GraphicsViewInterface*    m_pValueSource; // 像素值来源，为空时不显示像素值
+};
+
+#endif // !_IMAGE_ITEM_HPP_
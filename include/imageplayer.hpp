@@ -12,11 +12,26 @@
 #ifndef _IMAGE_PLAYER_HPP_
 #define _IMAGE_PLAYER_HPP_
 
+#include <memory>
+
 #include <QLabel>
+#include <QtNumeric>
+#include <QStringList>
 #include <QWidget>
 
 class GraphicsViewInterface;
+class Colormap;
+class FloatImage;
+class FrameSource;
+struct RawFrame;
+struct SourceFrameSlot;
+enum class CompareMode;
+class ImageCache;
+class SequencePlayer;
+class HistogramEngine;
+class HistogramWidget;
 class QHBoxLayout;
+class QTimer;
 class QVBoxLayout;
 
 enum class QColorType
@@ -49,6 +64,27 @@ void setPositionInfo(const QPoint& position, QLabel* label)
     label->setText(info);
 }
 
+/**
+ * @brief 设置像素原始值信息
+ *
+ * @param value 原始值
+ * @param label 显示信息的控件
+ */
+inline
+void setValueInfo(double value, QLabel* label)
+{
+    label->setText("Value: " + (qIsNaN(value) ? QString("-") : QString::number(value, 'g', 7)));
+}
+
+/**
+ * @brief 设置邻域原始值信息，按行排列为网格
+ *
+ * @param values 按行排列的原始值，NaN 显示为 "-"
+ * @param size 邻域边长
+ * @param label 显示信息的控件
+ */
+void setNeighborhoodInfo(const QVector<double>& values, int size, QLabel* label);
+
 class ImagePlayer : public QWidget
 {
     Q_OBJECT;
@@ -71,18 +107,62 @@ public:
     bool isStaticMode() const noexcept;
     const QImage& getImage() noexcept;
     void setImage(const QImage& image);
+    void setImage(QImage&& image);
+    void setImage(const QString& path);
+    void setImage(const FloatImage& image);
+    bool setImage(const RawFrame& frame);
+    void setDisplayWindow(double low, double high);
+    void setAutoWindow(bool enabled);
+    void setColormap(const Colormap& colormap);
+    void setImageList(const QStringList& files, int index = 0);
+    void setImageCache(ImageCache* cache);
+    bool setSequence(const QString& directory);
+    void setSequence(const QStringList& frames);
+    SequencePlayer* sequencePlayer();
+    void bindSource(FrameSource* source);
+    bool setCompareImages(const QImage& a, const QImage& b);
+    void setCompareMode(CompareMode mode);
+    void clearCompare();
+    void setHistogramVisible(bool visible);
+    void setNeighborhoodSize(int size);
+    HistogramEngine* histogramEngine();
     QPoint getImagePosition(const QPoint& pos);
 
+    inline const QStringList& imageList() const noexcept { return m_imageList; }
+    inline int currentIndex() const noexcept { return m_nCurrentIndex; }
+    inline int neighborhoodSize() const noexcept { return m_nNeighborhoodSize; }
+    inline ImageCache* imageCache() const noexcept { return m_pImageCache; }
+    inline FrameSource* frameSource() const noexcept { return m_pSource; }
+    inline GraphicsViewInterface* viewInterface() const noexcept { return m_pInterface; }
+    inline HistogramWidget* histogramWidget() const noexcept { return m_pHistogramWidget; }
+
 public slots:
     void setPosInfo();
+    void setCurrentIndex(int index);
+    void nextImage();
+    void previousImage();
+
+private slots:
+    void requestPosInfo();
 
 private:
     GraphicsViewInterface*  m_pInterface;
+    ImageCache*             m_pImageCache;      // 浏览文件夹时使用的图像缓存，不归播放器所有，默认为空
+    SequencePlayer*         m_pSequencePlayer;  // 图像序列播放引擎，首次使用时创建
+    FrameSource*            m_pSource;          // 绑定的帧源
+    std::shared_ptr<SourceFrameSlot> m_pSourceSlot; // 帧源推送、尚未显示的最新一帧
+    HistogramEngine*        m_pHistogramEngine; // 直方图引擎，首次使用时创建
+    HistogramWidget*        m_pHistogramWidget; // 直方图面板
+    QStringList             m_imageList;        // 浏览的文件列表
+    int                     m_nCurrentIndex;    // 当前显示的文件序号
     QVBoxLayout*            m_pImageLayout;
     QHBoxLayout*            m_pBottomLayout;
     QLabel*                 m_pPosLabel;
     QLabel*                 m_pRGBLabel;
     QLabel*                 m_pHSVLabel;
+    QLabel*                 m_pNeighborhoodLabel; // 邻域原始值网格，首次使用时创建
+    int                     m_nNeighborhoodSize;  // 邻域边长，0 表示不显示
+    QTimer*                 m_pPosTimer;        // 合并鼠标移动事件的计时器
 };
 
 #endif // !_CYS_IMAGE_DISPLAY_IMAGE_PLAYER_HPP_
\ No newline at end of file
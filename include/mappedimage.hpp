@@ -0,0 +1,57 @@
+/**
+ * @file mappedimage.hpp
+ * @author ldk
+ * @brief 基于内存映射的无拷贝图像加载
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _MAPPED_IMAGE_HPP_
+#define _MAPPED_IMAGE_HPP_
+
+#include <QImage>
+#include <QString>
+
+/**
+ * @brief
+ * 支持内存映射加载的未压缩格式：
+ * - 带有 sidecar 头文件的 raw 文件（<file>.hdr 或 <basename>.hdr，INI 格式，
+ *   键为 width/height/format/stride/offset）
+ * - 8 位 PGM(P5) / PPM(P6)
+ * - 自顶向下存储、未压缩的 8 位灰度 / 24 位 / 32 位 BMP
+ *
+ * 单字节像素（灰度、RGB888/BGR888，含 8 位灰度与 24 位 BMP）在任意偏移处都直接引用映射页面；
+ * 多字节像素要求像素数据偏移与行跨度按像素大小对齐，否则从映射逐行拷贝一次（不经解码）。
+ * 常见 32 位 BMP 的像素偏移为 54/122/138（对应 BITMAPINFOHEADER/V4/V5），均未按 4 字节对齐，
+ * 因此只有像素偏移为 4 的倍数的 32 位 BMP 才是无拷贝的。
+ */
+enum class MappedImageType
+{
+    None,
+    Raw,
+    PNM,
+    BMP
+};
+
+/**
+ * @brief 判断文件能否以内存映射方式加载
+ *
+ * @param path 图像路径
+ * @return MappedImageType 可映射的格式，不可映射时返回 None
+ */
+MappedImageType mappedImageType(const QString& path);
+
+/**
+ * @brief 以内存映射方式加载图像
+ * 返回的 QImage 直接引用映射的页面（只读），页面在访问时按需载入，
+ * 最后一个引用释放时自动解除映射。对图像的写操作会触发深拷贝。
+ *
+ * @param path 图像路径
+ * @return QImage 不支持的格式或映射失败时返回空图像
+ */
+QImage loadMappedImage(const QString& path);
+
+#endif // !_MAPPED_IMAGE_HPP_
@@ -0,0 +1,131 @@
+/**
+ * @file overlayitem.hpp
+ * @author ldk
+ * @brief 批量绘制检测框、轮廓与标签的叠加层
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _OVERLAY_ITEM_HPP_
+#define _OVERLAY_ITEM_HPP_
+
+#include <vector>
+
+#include <QGraphicsItem>
+#include <QPen>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief
+ * 一帧的叠加图形，以紧凑数组保存，坐标为图像坐标。
+ * 每个形状通过下标引用画笔表中的画笔，画笔统一设为 cosmetic，线宽不随缩放变化。
+ * 第 i 条折线的顶点为 polylinePoints[polylineStarts[i], polylineStarts[i + 1])。
+ */
+struct OverlayFrame
+{
+    QVector<QPen>       pens;               // 画笔表
+    QVector<QRectF>     rects;              // 矩形
+    QVector<int>        rectPens;
+    QVector<QLineF>     lines;              // 线段
+    QVector<int>        linePens;
+    QVector<QPointF>    polylinePoints;     // 所有折线的顶点
+    QVector<int>        polylineStarts;     // 各折线首个顶点的下标
+    QVector<int>        polylinePens;
+    QVector<QPointF>    labelPositions;     // 标签位置
+    QStringList         labels;             // 标签文字
+    QVector<int>        labelPens;
+
+    int  addPen(const QPen& pen);
+    void addRect(const QRectF& rect, int pen = 0);
+    void addLine(const QLineF& line, int pen = 0);
+    void addPolyline(const QPointF* points, int count, int pen = 0);
+    void addLabel(const QPointF& position, const QString& text, int pen = 0);
+    void reserve(int rectCount, int lineCount = 0, int polylineCount = 0, int labelCount = 0);
+    void clear();
+
+    inline int shapeCount() const noexcept
+    {
+        return rects.size() + lines.size() + polylineStarts.size() + labels.size();
+    }
+};
+
+/**
+ * @brief 命中测试结果
+ */
+struct OverlayHit
+{
+    enum Kind
+    {
+        None,
+        Rect,
+        Line,
+        Polyline,
+        Label
+    };
+
+    Kind kind  = None;
+    int  index = -1;    // 在对应数组中的下标
+
+    inline bool isValid() const noexcept { return kind != None; }
+};
+
+/**
+ * @brief
+ * 叠加层控件，用一个 QGraphicsItem 绘制整帧的形状：
+ * 设置新帧时按画笔分组，绘制时每组一次 drawRects / drawLines，折线展开为线段一并绘制，
+ * 只绘制与暴露区域相交的形状；命中测试使用均匀网格索引，首次查询时才建立。
+ */
+class OverlayItem : public QGraphicsItem
+{
+public:
+    explicit OverlayItem(QGraphicsItem* parent = nullptr);
+    ~OverlayItem() = default;
+
+    void setFrame(OverlayFrame frame);
+    OverlayHit hitTest(const QPointF& position, double tolerance) const;
+
+    inline const OverlayFrame& frame() const noexcept { return m_Frame; }
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
+
+private:
+    /* 同一画笔的形状 */
+    struct Batch
+    {
+        QVector<QRectF> rects;
+        QVector<QLineF> lines;      // 线段与展开后的折线
+        QVector<int>    labels;     // 标签下标
+    };
+
+    /* 均匀网格，entries 保存每个格子中形状的全局编号 */
+    struct Grid
+    {
+        QRectF       bounds;
+        int          columns = 0;
+        int          rows = 0;
+        double       cellWidth = 1.;
+        double       cellHeight = 1.;
+        QVector<int> offsets;
+        QVector<int> entries;
+    };
+
+    void   buildBatches();
+    void   buildGrid() const;
+    QRectF shapeBounds(int id) const;
+    double shapeDistance(int id, const QPointF& position) const;
+
+    OverlayFrame            m_Frame;        // 当前帧
+    std::vector<Batch>      m_batches;      // 与画笔表一一对应
+    QRectF                  m_bounds;       // 所有形状的包围盒
+    mutable Grid            m_grid;         // 命中测试索引
+    mutable bool            m_bGridDirty;   // 索引是否需要重建
+    QVector<QRectF>         m_visibleRects; // 绘制时裁剪后的矩形
+    QVector<QLineF>         m_visibleLines; // 绘制时裁剪后的线段
+};
+
+#endif // !_OVERLAY_ITEM_HPP_
@@ -0,0 +1,107 @@
+/**
+ * @file parallel.hpp
+ * @author ldk
+ * @brief 线程池辅助函数
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _PARALLEL_HPP_
+#define _PARALLEL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+/**
+ * @brief 将可调用对象包装为 QRunnable（兼容没有 QThreadPool::start(std::function) 的 Qt 版本）
+ */
+class FunctionRunnable : public QRunnable
+{
+public:
+    explicit FunctionRunnable(std::function<void()> function)
+        : m_function(std::move(function))
+    {
+        setAutoDelete(true);
+    }
+
+    virtual void run() override { m_function(); }
+
+private:
+    std::function<void()> m_function;
+};
+
+/**
+ * @brief 在线程池中异步执行任务
+ *
+ * @param pool 线程池，为空时使用全局线程池
+ * @param function 任务
+ * @param priority 任务优先级
+ */
+inline
+void runAsync(QThreadPool* pool, std::function<void()> function, int priority = 0)
+{
+    if (pool == nullptr)
+        pool = QThreadPool::globalInstance();
+    pool->start(new FunctionRunnable(std::move(function)), priority);
+}
+
+/**
+ * @brief 将 [begin, end) 划分为若干段在全局线程池中并行执行，调用线程也参与计算
+ * @remarks 调用线程会处理所有尚未被领取的分段，因此在线程池线程中嵌套调用也不会死锁
+ *
+ * @param begin 起始序号
+ * @param end 结束序号（不含）
+ * @param function 形如 void(int first, int last) 的任务
+ * @param grain 每段的最小长度
+ */
+template <typename Function>
+void parallelFor(int begin, int end, Function&& function, int grain = 64)
+{
+    const int count = end - begin;
+    if (count <= 0)
+        return;
+
+    const int threads = std::max(1, QThreadPool::globalInstance()->maxThreadCount());
+    const int bands = std::clamp(count / std::max(1, grain), 1, threads * 4);
+    if (bands == 1 || threads == 1)
+    {
+        function(begin, end);
+        return;
+    }
+
+    struct State
+    {
+        std::atomic_int next{ 0 };  // 下一个待领取的分段
+        QSemaphore      done;       // 已完成的分段数
+    };
+    auto state = std::make_shared<State>();
+    // 分段全部完成前调用线程不会返回，因此按引用捕获 function 是安全的；
+    // 之后才开始执行的任务领取不到分段，只会访问共享的 state
+    auto run = [state, begin, count, bands, &function]
+    {
+        for (int band = state->next.fetch_add(1); band < bands; band = state->next.fetch_add(1))
+        {
+            const int first = begin + int(qint64(count) * band / bands);
+            const int last = begin + int(qint64(count) * (band + 1) / bands);
+            function(first, last);
+            state->done.release();
+        }
+    };
+
+    for (int i = 1; i < std::min(bands, threads); ++i)
+        runAsync(nullptr, run);
+    run();
+    state->done.acquire(bands);
+}
+
+#endif // !_PARALLEL_HPP_
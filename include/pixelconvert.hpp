@@ -0,0 +1,70 @@
+/**
+ * @file pixelconvert.hpp
+ * @author ldk
+ * @brief 相机像素格式（Bayer / YUV / Mono）到 RGB32 的转换
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _PIXEL_CONVERT_HPP_
+#define _PIXEL_CONVERT_HPP_
+
+#include <QImage>
+
+/**
+ * @brief 相机输出的像素格式
+ */
+enum class PixelFormat
+{
+    Mono8,      // 8 位灰度
+    BayerRG8,   // 8 位 Bayer，首行为 R G
+    BayerGR8,   // 8 位 Bayer，首行为 G R
+    BayerGB8,   // 8 位 Bayer，首行为 G B
+    BayerBG8,   // 8 位 Bayer，首行为 B G
+    YUYV,       // YUV 4:2:2 打包格式，字节顺序 Y0 U Y1 V
+    UYVY,       // YUV 4:2:2 打包格式，字节顺序 U Y0 V Y1
+    NV12        // YUV 4:2:0 半平面格式，Y 平面后紧跟交错的 UV 平面
+};
+
+/**
+ * @brief 相机原始帧，不持有数据
+ */
+struct RawFrame
+{
+    const uchar* data   = nullptr;  // 像素数据
+    int          width  = 0;        // 宽度
+    int          height = 0;        // 高度
+    int          stride = 0;        // 每行字节数，为 0 时按格式计算最小值
+    PixelFormat  format = PixelFormat::Mono8;
+    const uchar* lut    = nullptr;  // Mono8 可选的 256 项查找表
+
+    inline bool isNull() const noexcept { return data == nullptr || width <= 0 || height <= 0; }
+};
+
+/**
+ * @brief 获取像素格式的最小行字节数
+ */
+int minimumStride(PixelFormat format, int width) noexcept;
+
+/**
+ * @brief 将相机原始帧转换为 RGB32（SIMD 并行）
+ * @remarks Bayer 使用双线性插值去马赛克，YUV 按 BT.601 有限范围转换，
+ * 4:2:2/4:2:0 格式的宽度（NV12 的高度）需为偶数
+ *
+ * @param frame 原始帧
+ * @param output 输出图像，尺寸与格式匹配且未被共享时复用其缓冲区
+ * @return bool 参数是否有效
+ */
+bool convertToRgb32(const RawFrame& frame, QImage& output);
+
+/**
+ * @brief 将相机原始帧转换为 RGB32
+ *
+ * @return QImage 参数无效时返回空图像
+ */
+QImage convertToRgb32(const RawFrame& frame);
+
+#endif // !_PIXEL_CONVERT_HPP_
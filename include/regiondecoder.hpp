@@ -0,0 +1,119 @@
+/**
+ * @file regiondecoder.hpp
+ * @author ldk
+ * @brief 超大压缩图像按视口区域解码
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _REGION_DECODER_HPP_
+#define _REGION_DECODER_HPP_
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <QImage>
+#include <QObject>
+#include <QRectF>
+#include <QThreadPool>
+
+/**
+ * @brief 区域解码统计
+ */
+struct RegionDecoderStatistics
+{
+    quint64 decoded     = 0;    // 已解码的分块数
+    quint64 skipped     = 0;    // 排队期间移出视口、未解码的分块数
+    quint64 evictions   = 0;    // 因超出预算被淘汰的分块数
+    qint64  decodeNs    = 0;    // 累计解码时间（纳秒）
+    qint64  bytes       = 0;    // 当前缓存的字节数（含概览图）
+    int     tiles       = 0;    // 当前缓存的分块数
+};
+
+/**
+ * @brief
+ * 超大压缩图像的按区域解码器，整幅图像不会被完整解码：
+ * 打开时只读取文件头，随后在线程池中以 QImageReader::setScaledSize 解码长边不超过 OverviewSize 的概览图；
+ * request() 按视口与缩放倍数选择分辨率级别（第 L 级为原图的 1 / 2^L），
+ * 以 setClipRect + setScaledSize 只解码可见的分块，解码在线程池中进行，靠近视口中心的分块优先。
+ * 分块按字节预算以最近最少使用的顺序淘汰；视口移动后排队中不再可见的分块直接跳过。
+ * 只接受图像插件支持 ClipRect 与 ScaledSize 的格式（如 JPEG），否则 QImageReader 会先解码整幅图像。
+ */
+class RegionDecoder : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int    TileSize{ 512 };                            // 分块边长（解码后的像素）
+    static constexpr int    OverviewSize{ 2048 };                       // 概览图长边
+    static constexpr qint64 DefaultBudget{ qint64(256) << 20 };         // 默认分块缓存预算 256 MB
+    static constexpr qint64 DefaultThreshold{ qint64(64) << 20 };       // 默认启用区域解码的像素数
+
+    explicit RegionDecoder(QObject* parent = nullptr);
+    ~RegionDecoder();
+
+    static bool canDecode(const QString& path, QSize* size = nullptr);
+
+    bool   open(const QString& path);
+    void   close();
+    void   request(const QRectF& visible, double zoom);
+    QImage tile(int level, int x, int y) const;
+    int    levelForZoom(double zoom) const;
+    void   setBudget(qint64 bytes);
+    void   setThreadCount(int count);
+    RegionDecoderStatistics statistics() const;
+
+    QImage overview() const;
+
+    inline bool          isOpen() const noexcept { return m_Size.isValid(); }
+    inline const QString& path() const noexcept { return m_Path; }
+    inline QSize         imageSize() const noexcept { return m_Size; }
+    inline qint64        budget() const noexcept { return m_nBudget; }
+
+    /* 第 level 级一个分块在原图中的边长 */
+    static inline int tileSpan(int level) noexcept { return TileSize << level; }
+
+signals:
+    /* 概览图或新分块解码完成，在解码器所在的线程中发出，连续完成的多个分块合并为一次 */
+    void tileReady();
+
+private:
+    struct Entry
+    {
+        quint64 key;
+        QImage  image;
+    };
+    using EntryList = std::list<Entry>;
+
+    static quint64 tileKey(int level, int x, int y) noexcept;
+
+    void decode(quint64 key, quint64 generation);
+    void decodeOverview(quint64 generation);
+    void notify();
+    void evict();
+
+    mutable std::mutex                              m_mutex;        // 保护缓存与请求状态
+    EntryList                                       m_entries;      // 按使用时间排序，头部最新
+    std::unordered_map<quint64, EntryList::iterator> m_index;       // 分块到缓存项的索引
+    std::unordered_set<quint64>                     m_queued;       // 排队或正在解码的分块
+    std::unordered_set<quint64>                     m_wanted;       // 最近一次请求的可见分块
+    std::unordered_set<quint64>                     m_failed;       // 解码失败的分块，不再重试
+    quint64                                         m_nGeneration;  // 打开的文件版本，关闭后旧任务不再写入
+    qint64                                          m_nBudget;      // 分块缓存预算
+    qint64                                          m_nBytes;       // 分块缓存的字节数
+    int                                             m_nMaxLevel;    // 最低分辨率级别，更低时使用概览图
+    RegionDecoderStatistics                         m_statistics;   // 统计
+    QString                                         m_Path;         // 图像路径
+    QSize                                           m_Size;         // 原图尺寸
+    QImage                                          m_overview;     // 概览图，在线程池中解码
+    std::atomic_bool                                m_bNotifyPending; // 是否已投递尚未发出的 tileReady()
+    QThreadPool                                     m_pool;         // 解码线程池
+};
+
+#endif // !_REGION_DECODER_HPP_
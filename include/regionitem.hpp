@@ -0,0 +1,45 @@
+/**
+ * @file regionitem.hpp
+ * @author ldk
+ * @brief 按视口区域解码的超大图像控件
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _REGION_ITEM_HPP_
+#define _REGION_ITEM_HPP_
+
+#include <QGraphicsItem>
+
+class RegionDecoder;
+
+/**
+ * @brief
+ * 绘制 RegionDecoder 打开的图像，场景坐标为原图像素坐标：
+ * 先以概览图（就绪前为占位色）铺满暴露区域，再叠加已解码的分块（先画较粗一级作为过渡）；
+ * 每次绘制按整个视口向解码器请求当前缩放倍数所需的分块，分块解码完成后重绘。
+ */
+class RegionItem : public QGraphicsItem
+{
+public:
+    explicit RegionItem(QGraphicsItem* parent = nullptr);
+    ~RegionItem() = default;
+
+    void setDecoder(RegionDecoder* decoder);
+
+    inline RegionDecoder* decoder() const noexcept { return m_pDecoder; }
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
+
+private:
+    void drawTiles(QPainter* painter, const QRect& area, int level);
+
+    RegionDecoder*  m_pDecoder;     // 解码器，为空时不绘制，所有权不转移
+    QRectF          m_Bounds;       // 原图范围
+};
+
+#endif // !_REGION_ITEM_HPP_
@@ -0,0 +1,64 @@
+/**
+ * @file resample.hpp
+ * @author ldk
+ * @brief 并行 SIMD 图像重采样
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _RESAMPLE_HPP_
+#define _RESAMPLE_HPP_
+
+#include <QImage>
+
+/**
+ * @brief 重采样滤波器，缩小时按缩小倍数扩展支撑范围，不会跳过源像素
+ */
+enum class ResampleFilter
+{
+    Box,        // 盒式，支撑半径 0.5
+    Bilinear,   // 三角（双线性），支撑半径 1
+    Lanczos     // Lanczos-3，支撑半径 3
+};
+
+/**
+ * @brief 可分离滤波重采样：先水平后垂直，两趟均按行分段并行，内层以 SSE2 / AVX2 定点运算
+ * @remarks Grayscale8、RGB32、ARGB32_Premultiplied 直接处理，其他格式先转换为
+ * RGB32 或 ARGB32_Premultiplied（带透明度时），结果为处理时的格式
+ *
+ * @param image 源图像
+ * @param size 目标尺寸
+ * @param filter 滤波器
+ * @return QImage 源图像或目标尺寸为空时返回空图像
+ */
+QImage resample(const QImage& image, const QSize& size, ResampleFilter filter = ResampleFilter::Lanczos);
+
+/**
+ * @brief 将源图像 area 内的像素重采样到 output 左上角 size 大小的范围，不复制源像素
+ * @remarks 只支持 Grayscale8、RGB32、ARGB32_Premultiplied；output 不小于 size、格式相同且未被共享时
+ * 复用其缓冲区，否则重新分配为 size 大小，用于连续重采样到同一缓冲
+ *
+ * @param image 源图像
+ * @param area 源图像中的范围
+ * @param size 目标尺寸
+ * @param output 输出图像
+ * @param filter 滤波器
+ * @return bool 格式不支持或范围、尺寸为空时返回 false
+ */
+bool resample(const QImage& image, const QRect& area, const QSize& size, QImage& output,
+              ResampleFilter filter = ResampleFilter::Lanczos);
+
+/**
+ * @brief 按宽高比模式重采样，用法与 QImage::scaled 相同
+ */
+inline
+QImage resample(const QImage& image, const QSize& size, Qt::AspectRatioMode mode,
+                ResampleFilter filter = ResampleFilter::Lanczos)
+{
+    return resample(image, image.size().scaled(size, mode), filter);
+}
+
+#endif // !_RESAMPLE_HPP_
@@ -0,0 +1,99 @@
+/**
+ * @file roistatistics.hpp
+ * @author ldk
+ * @brief 基于分块统计表的 ROI 统计（均值/方差/最值/像素数）
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _ROI_STATISTICS_HPP_
+#define _ROI_STATISTICS_HPP_
+
+#include <memory>
+
+#include <QMap>
+#include <QObject>
+#include <QRect>
+#include <QThreadPool>
+
+class DrawButton;
+class GraphicsViewInterface;
+class QTimer;
+struct RoiTables;
+
+/**
+ * @brief 单个矩形区域的统计结果
+ * 彩色图像按亮度（qGray）统计，Grayscale16 与浮点图像按原始值统计，浮点图像的 NaN 不参与统计
+ */
+struct RoiStatistics
+{
+    QRect   rect;               // 与图像求交后的区域
+    qint64  count    = 0;       // 有效像素数，浮点图像不计 NaN
+    double  sum      = 0.;      // 总和
+    double  mean     = 0.;      // 均值
+    double  variance = 0.;      // 方差
+    double  stddev   = 0.;      // 标准差
+    double  min      = 0.;      // 最小值
+    double  max      = 0.;      // 最大值
+    quint64 frameNumber = 0;    // 对应的帧序号
+
+    inline bool isNull() const noexcept { return count == 0; }
+};
+
+/**
+ * @brief
+ * ROI 统计引擎，按显示帧率轮询 GraphicsViewInterface，
+ * 每一帧在后台线程构建一次 32 x 32 分块的总和、平方和与最值表（约每像素 0.04 字节，不随 ROI 增长），
+ * 查询任意矩形时完整覆盖的分块直接查表，只扫描矩形边缘未完整覆盖的分块。
+ * 整数图像的方差由精确的整数累加值求得，浮点图像减去偏移后补偿求和，避免 E[x²] - mean² 的相消误差。
+ * 查询在 GUI 线程进行。
+ */
+class RoiStatisticsEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RoiStatisticsEngine(GraphicsViewInterface* source, QObject* parent = nullptr, int interval = 33);
+    ~RoiStatisticsEngine();
+
+    void setEnabled(bool enabled);
+    void setUpdateInterval(int interval);
+
+    int  addRoi(const QRect& rect);
+    void setRoi(int id, const QRect& rect);
+    void removeRoi(int id);
+    void clearRois();
+    int  trackDrawButton(DrawButton* button, int id = -1);
+
+    RoiStatistics statistics(const QRect& rect) const;
+    RoiStatistics roiStatistics(int id) const;
+
+    inline bool                     isEnabled() const noexcept { return m_bEnabled; }
+    inline const QMap<int, QRect>&  rois() const noexcept { return m_rois; }
+
+signals:
+    /* 统计表更新或 ROI 改变 */
+    void statisticsUpdated();
+
+private slots:
+    void poll();
+
+private:
+    void finish(std::shared_ptr<RoiTables> tables);
+
+    GraphicsViewInterface*              m_pSource;          // 图像来源
+    QTimer*                             m_pTimer;           // 轮询计时器
+    std::shared_ptr<const RoiTables>    m_pTables;          // 当前帧的分块统计表
+    std::shared_ptr<RoiTables>          m_pSpare;           // 上一帧的分块统计表，复用其内存
+    QMap<int, QRect>                    m_rois;             // ROI（图像坐标）
+    int                                 m_nNextId;          // 下一个 ROI 编号
+    quint64                             m_nFrameNumber;     // 最近一次请求的帧序号
+    bool                                m_bEnabled;         // 是否启用
+    bool                                m_bBusy;            // 是否有构建任务
+    QThreadPool                         m_pool;             // 构建线程
+};
+
+#endif // !_ROI_STATISTICS_HPP_
@@ -0,0 +1,124 @@
+/**
+ * @file sequenceplayer.hpp
+ * @author ldk
+ * @brief 图像序列播放引擎，在线程池中预先解码并按目标帧率呈现
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _SEQUENCE_PLAYER_HPP_
+#define _SEQUENCE_PLAYER_HPP_
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+
+class QTimer;
+
+/**
+ * @brief 播放统计
+ */
+struct PlaybackStatistics
+{
+    double  targetFps   = 0.;   // 目标帧率（已乘以播放速度）
+    double  achievedFps = 0.;   // 最近一秒实际呈现的帧率
+    quint64 presented   = 0;    // 已呈现的帧数
+    quint64 dropped     = 0;    // 因解码跟不上而跳过的帧数
+    int     queued      = 0;    // 已解码等待呈现的帧数
+};
+
+/**
+ * @brief
+ * 图像序列播放引擎。
+ * 解码线程池按顺序预先解码后续帧并放入有界队列，播放时钟决定每个时刻应呈现的帧，
+ * 若该帧尚未解码完成，则呈现已解码的最新一帧并丢弃过期帧，保证播放不落后于时钟。
+ * 呈现通过 frameReady 信号完成，信号在创建对象的线程中发出。
+ */
+class SequencePlayer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr double DefaultFps{ 30. };       // 默认目标帧率
+    static constexpr int    DefaultQueueSize{ 8 };   // 默认预解码帧数
+
+    explicit SequencePlayer(QObject* parent = nullptr);
+    ~SequencePlayer();
+
+    bool setDirectory(const QString& directory, const QStringList& nameFilters = QStringList());
+    void setFrames(const QStringList& files);
+    void setTargetFps(double fps);
+    void setSpeed(double speed);
+    void setQueueSize(int size);
+    void setDecodeThreadCount(int count);
+
+    PlaybackStatistics statistics() const;
+
+    inline const QStringList& frames() const noexcept { return m_frames; }
+    inline int    frameCount() const noexcept { return m_frames.size(); }
+    inline int    currentFrame() const noexcept { return m_nPresented; }
+    inline double targetFps() const noexcept { return m_dFps; }
+    inline double speed() const noexcept { return m_dSpeed; }
+    inline int    queueSize() const noexcept { return m_nQueueSize; }
+    inline bool   isPlaying() const noexcept { return m_bPlaying; }
+    inline bool   isLooping() const noexcept { return m_bLoop; }
+    inline void   setLoop(bool loop) noexcept { m_bLoop = loop; }
+
+public slots:
+    void play();
+    void pause();
+    void stop();
+    void seek(int frame);
+    void stepForward();
+    void stepBackward();
+
+signals:
+    void frameReady(const QImage& image, int frame);
+    void stateChanged(bool playing);
+    void finished();
+
+private slots:
+    void tick();
+
+private:
+    void rebaseClock(int frame);
+    void schedule();
+    void decode(int frame, quint64 generation);
+    void present(int frame, const QImage& image);
+    void updateInterval();
+
+    static QImage decodeFrame(const QString& path);
+
+    mutable std::mutex      m_mutex;
+    QStringList             m_frames;           // 帧文件列表
+    std::map<int, QImage>   m_decoded;          // 已解码等待呈现的帧
+    std::set<int>           m_scheduled;        // 正在解码的帧
+    std::deque<qint64>      m_presentTimes;     // 最近一秒内的呈现时间（毫秒）
+    quint64                 m_nGeneration;      // 帧列表版本，用于丢弃过期的解码结果
+    quint64                 m_nPresentedCount;  // 已呈现的帧数
+    quint64                 m_nDroppedCount;    // 丢弃的帧数
+    int                     m_nPresented;       // 当前呈现的帧
+    int                     m_nDue;             // 播放时钟对应的帧
+    int                     m_nStartFrame;      // 播放时钟起点对应的帧
+    int                     m_nQueueSize;       // 预解码帧数上限
+    double                  m_dFps;             // 目标帧率
+    double                  m_dSpeed;           // 播放速度
+    bool                    m_bPlaying;         // 是否正在播放
+    bool                    m_bLoop;            // 是否循环播放
+    QElapsedTimer           m_clock;            // 播放时钟
+    QElapsedTimer           m_statisticsClock;  // 统计时钟
+    QTimer*                 m_pTimer;           // 呈现计时器
+    QThreadPool             m_pool;             // 解码线程池
+};
+
+#endif // !_SEQUENCE_PLAYER_HPP_
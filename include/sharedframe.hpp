@@ -0,0 +1,132 @@
+/**
+ * @file sharedframe.hpp
+ * @author ldk
+ * @brief 跨进程共享内存帧环形缓冲：内存布局与生产者
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _SHARED_FRAME_HPP_
+#define _SHARED_FRAME_HPP_
+
+#include <atomic>
+#include <thread>
+
+#include <QImage>
+#include <QSharedMemory>
+
+/*
+ * 共享内存布局：SharedFrameHeader | SharedFrameSlot * slotCount | 槽位数据 * slotCount，各部分按 64 字节对齐。
+ * 每个槽位以序号实现顺序锁（seqlock）：写入期间为奇数，写完为偶数。
+ * 消费者使用某个槽位的图像时在 pinned 中置位，生产者跳过被占用的槽位以及最新的槽位，
+ * 因此消费者可以直接包装共享内存显示而无需拷贝；槽位全部被占用时生产者丢弃新帧。
+ */
+
+constexpr quint32 SHARED_FRAME_MAGIC{ 0x51544652 };    // "QTFR"
+constexpr quint32 SHARED_FRAME_VERSION{ 1 };
+constexpr int     SHARED_FRAME_MAX_SLOTS{ 64 };         // pinned 为 64 位掩码
+
+/**
+ * @brief 共享内存头
+ */
+struct alignas(64) SharedFrameHeader
+{
+    quint32                 magic;
+    quint32                 version;
+    quint32                 slotCount;      // 槽位数
+    quint32                 generation;     // 生产者接管共享内存的次数
+    quint64                 slotBytes;      // 每个槽位的数据容量
+    std::atomic<quint64>    published;      // 已发布的帧数
+    std::atomic<quint32>    latestSlot;     // 最新一帧所在的槽位
+    std::atomic<quint64>    pinned;         // 消费者正在使用的槽位
+    std::atomic<quint64>    dropped;        // 槽位全部被占用而丢弃的帧数
+};
+
+/**
+ * @brief 槽位头
+ */
+struct alignas(64) SharedFrameSlot
+{
+    std::atomic<quint32>    sequence;       // 顺序锁序号
+    quint32                 width;
+    quint32                 height;
+    quint32                 format;         // QImage::Format
+    quint32                 bytesPerLine;
+    quint64                 frameNumber;    // 生产者的帧序号
+    qint64                  timestamp;      // 生产时间（DisplayStatistics::now() 时钟）
+};
+
+static_assert(std::atomic<quint64>::is_always_lock_free && std::atomic<quint32>::is_always_lock_free,
+              "shared frame ring requires address-free atomics");
+
+/* 共享内存总字节数 */
+qint64 sharedFrameMemorySize(int slotCount, qint64 slotBytes);
+
+/* 第 index 个槽位头 */
+SharedFrameSlot* sharedFrameSlot(SharedFrameHeader* header, int index);
+
+/* 第 index 个槽位的数据 */
+uchar* sharedFrameData(SharedFrameHeader* header, int index);
+
+/**
+ * @brief
+ * 共享内存帧的生产者，供采集进程使用，只依赖 QtCore 与 QImage。
+ * 可以先 beginFrame() 取得槽位缓冲直接写入（如相机驱动的目标缓冲），再 endFrame() 发布，
+ * 也可以用 publish() 拷贝一幅已有的图像。只允许一个生产者线程。
+ */
+class SharedFrameWriter
+{
+public:
+    static constexpr int DefaultSlotCount{ 4 };
+
+    SharedFrameWriter() = default;
+    ~SharedFrameWriter();
+
+    bool create(const QString& key, qint64 slotBytes, int slotCount = DefaultSlotCount);
+    void close();
+
+    uchar* beginFrame(int width, int height, QImage::Format format, int bytesPerLine = 0);
+    void   endFrame(quint64 frameNumber, qint64 timestamp = 0);
+    bool   publish(const QImage& image, quint64 frameNumber, qint64 timestamp = 0);
+
+    inline bool    isOpen() const noexcept { return m_pHeader != nullptr; }
+    inline QString errorString() const { return m_memory.errorString(); }
+    inline quint64 droppedCount() const noexcept { return m_pHeader ? m_pHeader->dropped.load() : 0; }
+
+private:
+    QSharedMemory       m_memory;               // 共享内存
+    SharedFrameHeader*  m_pHeader = nullptr;    // 共享内存头
+    int                 m_nWriting = -1;        // 正在写入的槽位
+    int                 m_nNext = 0;            // 下一次开始查找的槽位
+};
+
+/**
+ * @brief
+ * 模拟的共享内存帧生产者，在独立线程中按指定帧率发布移动的渐变图像，
+ * 用于在没有采集进程时测试 SharedFrameSource。
+ */
+class SharedFrameSimulator
+{
+public:
+    SharedFrameSimulator() = default;
+    ~SharedFrameSimulator();
+
+    bool start(const QString& key, const QSize& size, double fps = 60., QImage::Format format = QImage::Format_Grayscale8);
+    void stop();
+
+    inline bool    isRunning() const noexcept { return m_thread.joinable(); }
+    inline quint64 publishedCount() const noexcept { return m_nPublished.load(); }
+
+private:
+    void run(QSize size, double fps, QImage::Format format);
+
+    SharedFrameWriter       m_writer;               // 生产者
+    std::thread             m_thread;               // 发布线程
+    std::atomic_bool        m_bStop{ false };       // 是否停止
+    std::atomic<quint64>    m_nPublished{ 0 };      // 已发布的帧数
+};
+
+#endif // !_SHARED_FRAME_HPP_
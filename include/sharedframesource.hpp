@@ -0,0 +1,89 @@
+/**
+ * @file sharedframesource.hpp
+ * @author ldk
+ * @brief 跨进程共享内存帧环形缓冲：消费者
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _SHARED_FRAME_SOURCE_HPP_
+#define _SHARED_FRAME_SOURCE_HPP_
+
+#include <memory>
+
+#include <QImage>
+#include <QObject>
+
+#include "framesource.hpp"
+
+class QTimer;
+class GraphicsViewInterface;
+struct SharedFrameMapping;
+
+/**
+ * @brief 共享内存帧接收统计
+ */
+struct SharedFrameStatistics
+{
+    quint64 received    = 0;    // 取得的帧数
+    quint64 skipped     = 0;    // 两次取帧之间被更新的帧覆盖的帧数
+    quint64 retries     = 0;    // 读到正在写入的槽位而重试的次数
+    quint64 dropped     = 0;    // 生产者因槽位全部被占用而丢弃的帧数
+};
+
+/**
+ * @brief
+ * 共享内存帧的消费者。
+ * acquire() 返回的 QImage 直接包装共享内存中的槽位（只读，不拷贝），
+ * 槽位在该图像的最后一个副本析构前不会被生产者覆盖；
+ * 作为 FrameSource 时 start() 后在所属线程按协商帧率的两倍轮询并通过帧回调推送；
+ * bind() 后按间隔轮询并把新帧直接送入 GraphicsViewInterface，应配合 DynamicMode 使用。
+ */
+class SharedFrameSource : public QObject, public FrameSource
+{
+    Q_OBJECT
+
+public:
+    explicit SharedFrameSource(QObject* parent = nullptr);
+    ~SharedFrameSource();
+
+    bool attach(const QString& key);
+    void detach();
+    bool acquire(QImage& image, FrameInfo* info = nullptr);
+    void bind(GraphicsViewInterface* view, int interval = 2);
+    void unbind();
+
+    FrameFormat negotiate(const FrameFormat& requested) override;
+    FrameFormat format() const override;
+    bool start() override;
+    void stop() override;
+    bool isRunning() const override;
+
+    SharedFrameStatistics statistics() const;
+
+    inline bool isAttached() const noexcept { return m_pMapping != nullptr; }
+    inline GraphicsViewInterface* boundView() const noexcept { return m_pView; }
+
+signals:
+    /* 取得并推送了新的一帧 */
+    void frameDelivered(quint64 frameNumber);
+
+private slots:
+    void poll();
+
+private:
+    void updateTimer(int interval);
+
+    std::shared_ptr<SharedFrameMapping> m_pMapping;     // 共享内存映射，被包装的图像共同持有
+    GraphicsViewInterface*              m_pView;        // 接收帧的显示控件
+    QTimer*                             m_pTimer;       // 轮询计时器
+    bool                                m_bStarted;     // 是否作为 FrameSource 启动
+    double                              m_dFps;         // 协商的帧率
+    quint64                             m_nPublished;   // 上一次取帧时的发布计数
+    SharedFrameStatistics               m_Statistics;   // 接收统计
+};
+
+#endif // !_SHARED_FRAME_SOURCE_HPP_
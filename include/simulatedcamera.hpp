@@ -0,0 +1,86 @@
+/**
+ * @file simulatedcamera.hpp
+ * @author ldk
+ * @brief 生成合成图像的模拟相机
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _SIMULATED_CAMERA_HPP_
+#define _SIMULATED_CAMERA_HPP_
+
+#include <atomic>
+#include <thread>
+
+#include "framesource.hpp"
+
+/**
+ * @brief 模拟图像内容，均随帧序号移动
+ */
+enum class SimulatedPattern
+{
+    Gradient,       // 彩色渐变
+    Checkerboard,   // 棋盘格
+    MovingBar       // 扫过渐变背景的竖条
+};
+
+/**
+ * @brief 模拟相机统计
+ */
+struct SimulatedCameraStatistics
+{
+    quint64 generated   = 0;    // 生成的帧数
+    quint64 late        = 0;    // 未能按帧率准时生成的帧数
+    qint64  renderNs    = 0;    // 最近一帧的生成耗时（纳秒）
+};
+
+/**
+ * @brief
+ * 模拟相机：在独立线程中按协商的尺寸、格式与帧率生成图像并通过帧回调推送，
+ * 支持 Grayscale8、Grayscale16、RGB32 与 8 位 Bayer 输出，可叠加噪声。
+ * 相同的种子与参数生成逐帧相同的内容，可用于无相机的负载与延迟测试。
+ */
+class SimulatedCamera : public FrameSource
+{
+public:
+    static constexpr int    MinSize{ 16 };
+    static constexpr int    MaxSize{ 16384 };
+    static constexpr double MaxFps{ 1000. };
+    static constexpr int    BufferCount{ 3 };   // 复用的帧缓冲数
+
+    SimulatedCamera();
+    ~SimulatedCamera() override;
+
+    FrameFormat negotiate(const FrameFormat& requested) override;
+    FrameFormat format() const override;
+    bool start() override;
+    void stop() override;
+    bool isRunning() const override;
+
+    void setPattern(SimulatedPattern pattern);
+    void setNoise(int amplitude);
+    void setSeed(quint32 seed);
+    SimulatedCameraStatistics statistics() const;
+
+    inline SimulatedPattern pattern() const noexcept { return SimulatedPattern(m_nPattern.load()); }
+    inline int noise() const noexcept { return m_nNoise.load(); }
+
+private:
+    void run();
+    void render(QImage& frame, quint64 index) const;
+
+    FrameFormat             m_Format;               // 协商后的格式
+    std::atomic_int         m_nPattern;             // 图像内容
+    std::atomic_int         m_nNoise;               // 噪声幅度（8 位灰度级）
+    quint32                 m_nSeed;                // 噪声种子
+    std::thread             m_thread;               // 生成线程
+    std::atomic_bool        m_bStop;                // 是否停止
+    std::atomic<quint64>    m_nGenerated;           // 生成的帧数
+    std::atomic<quint64>    m_nLate;                // 未能准时生成的帧数
+    std::atomic<qint64>     m_nRenderNs;            // 最近一帧的生成耗时
+};
+
+#endif // !_SIMULATED_CAMERA_HPP_
@@ -0,0 +1,59 @@
+/**
+ * @file viewgroup.hpp
+ * @author ldk
+ * @brief 共享图像并同步缩放平移的多视图组
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _VIEW_GROUP_HPP_
+#define _VIEW_GROUP_HPP_
+
+#include <QImage>
+#include <QList>
+#include <QObject>
+
+class GraphicsViewInterface;
+class ImagePlayer;
+class QTimer;
+
+/**
+ * @brief
+ * 视图组，用于并排对比同一帧或对齐的多帧图像：
+ * 组内视图共享同一份不可变的图像与多级纹理，对比布局的内存与显示单幅图像相同；
+ * 任一视图缩放或平移后，在下一个显示周期把变换一次性同步到其他视图，避免视图之间相互触发。
+ */
+class ViewGroup : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ViewGroup(QObject* parent = nullptr, int interval = 16);
+    ~ViewGroup() = default;
+
+    void addView(GraphicsViewInterface* view);
+    void addView(ImagePlayer* player);
+    void removeView(GraphicsViewInterface* view);
+    void setLinked(bool linked);
+    void setImage(const QImage& image);
+    void setImages(const QList<QImage>& images);
+
+    inline bool isLinked() const noexcept { return m_bLinked; }
+    inline const QList<GraphicsViewInterface*>& views() const noexcept { return m_views; }
+
+public slots:
+    void synchronize();
+
+private:
+    void scheduleSync(GraphicsViewInterface* leader);
+
+    QList<GraphicsViewInterface*>   m_views;    // 组内视图
+    GraphicsViewInterface*          m_pLeader;  // 最近一次被操作的视图
+    QTimer*                         m_pTimer;   // 合并同步请求的计时器
+    bool                            m_bLinked;  // 是否同步变换
+};
+
+#endif // !_VIEW_GROUP_HPP_
@@ -0,0 +1,150 @@
+/**
+ * @file bufferring.cpp
+ * @author ldk
+ * @brief 显示数据的轮换缓冲
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "bufferring.hpp"
+#include "parallel.hpp"
+
+namespace
+{
+
+constexpr int ROW_GRAIN{ 64 };  // 并行复制时每段的最小行数
+
+/* 复制 region 内的像素，两幅图像尺寸与格式相同 */
+void copyRegion(const QImage& source, QImage& target, const QRegion& region)
+{
+    const int pixelBytes = source.depth() / 8;
+    const uchar* src = source.constBits();
+    const qsizetype srcBytesPerLine = source.bytesPerLine();
+    uchar* dst = target.bits();
+    const qsizetype dstBytesPerLine = target.bytesPerLine();
+    for (const QRect& rect : region)
+    {
+        const size_t offset = size_t(rect.left()) * pixelBytes;
+        const size_t bytes = size_t(rect.width()) * pixelBytes;
+        parallelFor(rect.top(), rect.bottom() + 1, [&](int first, int last)
+        {
+            for (int y = first; y < last; ++y)
+                std::memcpy(dst + y * dstBytesPerLine + offset, src + y * srcBytesPerLine + offset, bytes);
+        }, ROW_GRAIN);
+    }
+}
+
+} // namespace
+
+BufferRing::BufferRing(int count)
+    : m_slots(size_t(std::max(1, count)))
+    , m_nCurrent(0)
+    , m_nAllocations(0)
+{}
+
+/**
+ * @brief 取得下一次写入的缓冲
+ * @remarks 优先原地写入未被共享的当前缓冲，其次复用其他未被共享的缓冲，
+ * 都被共享（如控件与录制队列仍持有）或尺寸、格式不符时重新分配。
+ * 返回的缓冲在 region 之外与上一次写入的结果一致；无法补齐时 region 被设为整幅图像。
+ * 只支持 8 位整数倍深度的格式
+ *
+ * @param size 尺寸
+ * @param format 像素格式
+ * @param region 本次写入的区域，为空时整幅写入
+ * @return QImage& 可直接写入而不触发深拷贝的缓冲，分配失败时为空图像
+ */
+QImage& BufferRing::acquire(const QSize& size, QImage::Format format, QRegion& region)
+{
+    const QRect bounds(QPoint(0, 0), size);
+    const Slot& latest = m_slots[size_t(m_nCurrent)];
+    bool reusable = latest.image.size() == size && latest.image.format() == format && !latest.full;
+
+    auto usable = [&](const Slot& slot)
+    {
+        return slot.image.size() == size && slot.image.format() == format && slot.image.isDetached();
+    };
+    const int count = int(m_slots.size());
+    int index = -1;
+    for (int i = 0; i < count && index < 0; ++i)
+    {
+        const int candidate = (m_nCurrent + i) % count;
+        if (usable(m_slots[size_t(candidate)]))
+            index = candidate;
+    }
+    if (index < 0)
+    {
+        // 没有可复用的缓冲，替换当前缓冲之后的一个，持有旧缓冲的一方不受影响
+        index = (m_nCurrent + 1) % count;
+        // 只有一个缓冲时最新结果随之丢弃
+        reusable = reusable && index != m_nCurrent;
+        Slot& slot = m_slots[size_t(index)];
+        slot.image = QImage(size, format);
+        slot.full = true;
+        slot.stale = QRegion();
+        ++m_nAllocations;
+    }
+
+    Slot& slot = m_slots[size_t(index)];
+    region &= bounds;
+    const bool whole = region.isEmpty() || region == QRegion(bounds);
+    if (whole || !reusable)
+    {
+        region = QRegion(bounds);
+    }
+    else if (index != m_nCurrent)
+    {
+        const QRegion missing = (slot.full ? QRegion(bounds) : slot.stale) - region;
+        if (!missing.isEmpty())
+            copyRegion(latest.image, slot.image, missing);
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        Slot& other = m_slots[size_t(i)];
+        if (i == index || other.full)
+            continue;
+        if (region == QRegion(bounds))
+        {
+            other.full = true;
+            other.stale = QRegion();
+            continue;
+        }
+        other.stale += region;
+        if (other.stale.rectCount() > MaxStaleRects)
+            other.stale = QRegion(other.stale.boundingRect());
+    }
+    slot.full = false;
+    slot.stale = QRegion();
+    m_nCurrent = index;
+    return slot.image;
+}
+
+/* 取出最近一次写入的缓冲并清空 */
+QImage BufferRing::take()
+{
+    QImage image = std::move(m_slots[size_t(m_nCurrent)].image);
+    clear();
+    return image;
+}
+
+void BufferRing::clear()
+{
+    for (Slot& slot : m_slots)
+        slot = Slot();
+    m_nCurrent = 0;
+}
+
+/* 释放当前缓冲以外的缓冲，不需要连续更新时减少内存占用 */
+void BufferRing::releaseSpare()
+{
+    for (int i = 0; i < int(m_slots.size()); ++i)
+        if (i != m_nCurrent)
+            m_slots[size_t(i)] = Slot();
+}
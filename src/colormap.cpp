@@ -0,0 +1,300 @@
+/**
+ * @file colormap.cpp
+ * @author ldk
+ * @brief 单通道图像的伪彩色映射
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "colormap.hpp"
+#include "displaymapping.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+
+namespace
+{
+
+qint64 nextKey()
+{
+    static std::atomic<qint64> key{ 0 };
+    return ++key;
+}
+
+inline int toByte(double value) noexcept
+{
+    return int(std::lround(std::clamp(value, 0., 1.) * 255.));
+}
+
+/* 6 次多项式拟合的感知均匀颜色表，系数按 r g b 排列，从常数项开始 */
+QRgb polynomial(const double (&c)[7][3], double t)
+{
+    double rgb[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        double value = c[6][k];
+        for (int i = 5; i >= 0; --i)
+            value = value * t + c[i][k];
+        rgb[k] = value;
+    }
+    return qRgb(toByte(rgb[0]), toByte(rgb[1]), toByte(rgb[2]));
+}
+
+constexpr double INFERNO[7][3] = {
+    { 0.0002189403691192265, 0.001651004631001012, -0.01948089843709184 },
+    { 0.1065134194856116, 0.5639564367884091, 3.932712388889277 },
+    { 11.60249308247187, -3.972853965665698, -15.9423941062914 },
+    { -41.70399613139459, 17.43639888205313, 44.35414519872813 },
+    { 77.162935699427, -33.40235894210092, -81.80730925738993 },
+    { -71.31942824499214, 32.62606426397723, 73.20951985803202 },
+    { 25.13112622477341, -12.24266895238567, -23.07032500287172 }
+};
+
+constexpr double VIRIDIS[7][3] = {
+    { 0.2777273272234177, 0.005407344544966578, 0.3340998053353061 },
+    { 0.1050930431085774, 1.404613529898575, 1.384590162594685 },
+    { -0.3308618287255563, 0.214847559468213, 0.09509516302823659 },
+    { -4.634230498983486, -5.799100973351585, -19.33244095627987 },
+    { 6.228269936347081, 14.17993336680509, 56.69055260068105 },
+    { 4.776384997670288, -13.74514537774601, -65.35303263337234 },
+    { -5.435455855934631, 4.645852612178535, 26.3124352495832 }
+};
+
+QRgb presetColor(ColormapPreset preset, double t)
+{
+    switch (preset)
+    {
+    case ColormapPreset::Inferno:
+        return polynomial(INFERNO, t);
+    case ColormapPreset::Viridis:
+        return polynomial(VIRIDIS, t);
+    default:
+        return qRgb(toByte(1.5 - std::abs(4. * t - 3.)), toByte(1.5 - std::abs(4. * t - 2.)),
+                    toByte(1.5 - std::abs(4. * t - 1.)));
+    }
+}
+
+/*
+ * 一行查表。AVX2 以 gather 一次取 8 项；SSE2 没有字节重排与 gather 指令，
+ * 展开为每次 4 项的标量查表，65536 项的表在 NEON 下同样如此
+ */
+template <typename T>
+void lookupRow(const T* source, QRgb* target, int count, const QRgb* table)
+{
+    int x = 0;
+#if defined(QTTOOLS_AVX2)
+    const int* base = reinterpret_cast<const int*>(table);
+    for (; x + 8 <= count; x += 8)
+    {
+        __m256i index;
+        if constexpr (sizeof(T) == 1)
+            index = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + x)));
+        else
+            index = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + x), _mm256_i32gather_epi32(base, index, 4));
+    }
+#endif
+    for (; x + 4 <= count; x += 4)
+    {
+        const QRgb c0 = table[source[x]];
+        const QRgb c1 = table[source[x + 1]];
+        const QRgb c2 = table[source[x + 2]];
+        const QRgb c3 = table[source[x + 3]];
+        target[x] = c0;
+        target[x + 1] = c1;
+        target[x + 2] = c2;
+        target[x + 3] = c3;
+    }
+    for (; x < count; ++x)
+        target[x] = table[source[x]];
+}
+
+#if defined(QTTOOLS_NEON)
+
+/* 256 项颜色表按通道拆成的字节表，每个通道为 4 个 64 字节的 TBL 表 */
+struct ChannelTables
+{
+    uint8x16x4_t b[4];
+    uint8x16x4_t g[4];
+    uint8x16x4_t r[4];
+};
+
+ChannelTables splitTable(const QRgb* table)
+{
+    uchar planes[3][256];
+    for (int i = 0; i < 256; ++i)
+    {
+        planes[0][i] = uchar(qBlue(table[i]));
+        planes[1][i] = uchar(qGreen(table[i]));
+        planes[2][i] = uchar(qRed(table[i]));
+    }
+    ChannelTables tables;
+    uint8x16x4_t* targets[3] = { tables.b, tables.g, tables.r };
+    for (int c = 0; c < 3; ++c)
+        for (int t = 0; t < 4; ++t)
+            for (int v = 0; v < 4; ++v)
+                targets[c][t].val[v] = vld1q_u8(planes[c] + t * 64 + v * 16);
+    return tables;
+}
+
+/* 以 4 次 64 字节查表覆盖 256 项，超出当前表范围的索引保留之前查得的值 */
+inline uint8x16_t lookup256(const uint8x16x4_t table[4], uint8x16_t index)
+{
+    const uint8x16_t step = vdupq_n_u8(64);
+    uint8x16_t result = vqtbl4q_u8(table[0], index);
+    for (int t = 1; t < 4; ++t)
+    {
+        index = vsubq_u8(index, step);
+        result = vqtbx4q_u8(result, table[t], index);
+    }
+    return result;
+}
+
+/* 8 位图像一行查表，每次 16 个像素 */
+void lookupRow8(const uchar* source, QRgb* target, int count, const ChannelTables& tables, const QRgb* table)
+{
+    int x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        const uint8x16_t index = vld1q_u8(source + x);
+        const uint8x16x4_t pixels{ { lookup256(tables.b, index), lookup256(tables.g, index),
+                                     lookup256(tables.r, index), vdupq_n_u8(0xFF) } };
+        vst4q_u8(reinterpret_cast<uchar*>(target + x), pixels);
+    }
+    for (; x < count; ++x)
+        target[x] = table[source[x]];
+}
+
+#endif
+
+template <typename T>
+void lookupArea(const QImage& image, const QRect& area, const QRgb* table, uchar* bits, qsizetype bytesPerLine)
+{
+    const uchar* source = image.constBits();
+    const qsizetype sourceBytesPerLine = image.bytesPerLine();
+#if defined(QTTOOLS_NEON)
+    if constexpr (sizeof(T) == 1)
+    {
+        const ChannelTables tables = splitTable(table);
+        parallelFor(area.top(), area.bottom() + 1, [&](int first, int last)
+        {
+            for (int y = first; y < last; ++y)
+                lookupRow8(source + y * sourceBytesPerLine + area.left(),
+                           reinterpret_cast<QRgb*>(bits + y * bytesPerLine) + area.left(), area.width(), tables, table);
+        }, 32);
+        return;
+    }
+#endif
+    parallelFor(area.top(), area.bottom() + 1, [&](int first, int last)
+    {
+        for (int y = first; y < last; ++y)
+            lookupRow(reinterpret_cast<const T*>(source + y * sourceBytesPerLine) + area.left(),
+                      reinterpret_cast<QRgb*>(bits + y * bytesPerLine) + area.left(), area.width(), table);
+    }, 32);
+}
+
+} // namespace
+
+Colormap::Colormap(ColormapPreset preset)
+{
+    QVector<QRgb> table(NarrowSize);
+    for (int i = 0; i < NarrowSize; ++i)
+        table[i] = presetColor(preset, i / double(NarrowSize - 1));
+    setTable(table);
+}
+
+/**
+ * @brief 自定义颜色表
+ *
+ * @param table 256 或 65536 项，其他长度构造为空颜色表
+ */
+Colormap::Colormap(const QVector<QRgb>& table)
+{
+    if (table.size() == NarrowSize || table.size() == WideSize)
+        setTable(table);
+}
+
+/**
+ * @brief 由渐变色标生成颜色表
+ *
+ * @param stops 色标，位置在 [0, 1] 内递增
+ * @param size 颜色表长度，256 或 65536
+ */
+Colormap Colormap::fromGradient(const QGradientStops& stops, int size)
+{
+    if (stops.isEmpty() || (size != NarrowSize && size != WideSize))
+        return Colormap();
+
+    QVector<QRgb> table(size);
+    int k = 0;
+    for (int i = 0; i < size; ++i)
+    {
+        const double t = i / double(size - 1);
+        while (k + 1 < stops.size() && stops[k + 1].first < t)
+            ++k;
+        const QGradientStop& a = stops[k];
+        const QGradientStop& b = stops[qMin(k + 1, stops.size() - 1)];
+        const double span = b.first - a.first;
+        const double f = span > 0. ? std::clamp((t - a.first) / span, 0., 1.) : 0.;
+        table[i] = qRgb(int(std::lround(a.second.red() + (b.second.red() - a.second.red()) * f)),
+                        int(std::lround(a.second.green() + (b.second.green() - a.second.green()) * f)),
+                        int(std::lround(a.second.blue() + (b.second.blue() - a.second.blue()) * f)));
+    }
+    return Colormap(table);
+}
+
+void Colormap::setTable(const QVector<QRgb>& table)
+{
+    m_table = table;
+    // 表中颜色按不透明处理
+    for (QRgb& color : m_table)
+        color |= 0xff000000u;
+    if (isWide())
+    {
+        m_narrow.resize(NarrowSize);
+        for (int i = 0; i < NarrowSize; ++i)
+            m_narrow[i] = m_table[i * 257];
+    }
+    else
+    {
+        m_narrow = m_table;
+    }
+    m_nKey = nextKey();
+}
+
+bool applyColormap(const QImage& image, const Colormap& colormap, QImage& output, const QRegion& region)
+{
+    if (image.isNull() || colormap.isNull())
+        return false;
+    const bool wide = image.format() != QImage::Format_Grayscale8;
+    if (wide && (!isHighBitDepth(image) || !colormap.isWide()))
+        return false;
+
+    QRegion area = region.isEmpty() ? QRegion(image.rect()) : region & image.rect();
+    // 输出图像被共享时原地写入会先深拷贝整幅图像，改为新分配并整幅查表
+    if (output.size() != image.size() || output.format() != QImage::Format_RGB32 || !output.isDetached())
+    {
+        output = QImage(image.size(), QImage::Format_RGB32);
+        if (output.isNull())
+            return false;
+        area = QRegion(image.rect());
+    }
+
+    // 在并行区域之外取得可写指针，避免各线程分别触发分离
+    uchar* bits = output.bits();
+    const qsizetype bytesPerLine = output.bytesPerLine();
+    for (const QRect& rect : area)
+    {
+        if (wide)
+            lookupArea<quint16>(image, rect, colormap.table().constData(), bits, bytesPerLine);
+        else
+            lookupArea<uchar>(image, rect, colormap.narrowTable().constData(), bits, bytesPerLine);
+    }
+    return true;
+}
@@ -0,0 +1,329 @@
+/**
+ * @file displaymapping.cpp
+ * @author ldk
+ * @brief 高位深图像的窗宽窗位显示映射
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+#include "displaymapping.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+
+namespace
+{
+
+constexpr int ROW_GRAIN{ 16 };  // 并行时每段的最小行数
+
+/* 线性映射参数：out = (v - low) * scale */
+struct LinearMap
+{
+    float low;
+    float scale;
+};
+
+LinearMap linearMap(const DisplayWindow& window)
+{
+    const double range = window.high - window.low;
+    // 窗宽为 0 时退化为阈值
+    const float scale = range > 0. ? float(255. / range) : 1e30f;
+    return LinearMap{ float(window.low), scale };
+}
+
+/* 伽马查找表，gamma 为 1 时返回 false */
+bool gammaTable(double gamma, std::array<uchar, 256>& table)
+{
+    if (gamma <= 0. || std::abs(gamma - 1.) < 1e-6)
+        return false;
+    for (int i = 0; i < 256; ++i)
+        table[i] = uchar(std::lround(255. * std::pow(i / 255., 1. / gamma)));
+    return true;
+}
+
+template <typename T>
+inline uchar mapScalar(T value, const LinearMap& map)
+{
+    const float f = (float(value) - map.low) * map.scale;
+    // 取反比较使 NaN 映射为 0
+    if (!(f > 0.f))
+        return 0;
+    if (f >= 255.f)
+        return 255;
+    return uchar(f + 0.5f);
+}
+
+#if defined(QTTOOLS_AVX2)
+
+inline __m256i mapVector(__m256 f, const LinearMap& map)
+{
+    f = _mm256_mul_ps(_mm256_sub_ps(f, _mm256_set1_ps(map.low)), _mm256_set1_ps(map.scale));
+    // max 的第一个操作数为 NaN 时返回第二个操作数
+    f = _mm256_min_ps(_mm256_max_ps(f, _mm256_setzero_ps()), _mm256_set1_ps(255.f));
+    return _mm256_cvttps_epi32(_mm256_add_ps(f, _mm256_set1_ps(0.5f)));
+}
+
+/* 将两组 8 个 int32 压缩为 16 个 uint8 */
+inline __m128i packVector(__m256i a, __m256i b)
+{
+    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+    return _mm_packus_epi16(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1));
+}
+
+#elif defined(QTTOOLS_SSE2)
+
+inline __m128i mapVector(__m128 f, const LinearMap& map)
+{
+    f = _mm_mul_ps(_mm_sub_ps(f, _mm_set1_ps(map.low)), _mm_set1_ps(map.scale));
+    // max 的第一个操作数为 NaN 时返回第二个操作数
+    f = _mm_min_ps(_mm_max_ps(f, _mm_setzero_ps()), _mm_set1_ps(255.f));
+    return _mm_cvttps_epi32(_mm_add_ps(f, _mm_set1_ps(0.5f)));
+}
+
+#elif defined(QTTOOLS_NEON)
+
+inline uint32x4_t mapVector(float32x4_t f, const LinearMap& map)
+{
+    f = vmulq_f32(vsubq_f32(f, vdupq_n_f32(map.low)), vdupq_n_f32(map.scale));
+    // vmaxnm 在一个操作数为 NaN 时返回另一个操作数
+    f = vminq_f32(vmaxnmq_f32(f, vdupq_n_f32(0.f)), vdupq_n_f32(255.f));
+    return vcvtq_u32_f32(vaddq_f32(f, vdupq_n_f32(0.5f)));
+}
+
+inline uint8x8_t packVector(uint32x4_t a, uint32x4_t b)
+{
+    return vqmovn_u16(vcombine_u16(vqmovn_u32(a), vqmovn_u32(b)));
+}
+
+#endif
+
+void mapRow(const quint16* src, uchar* dst, int count, const LinearMap& map)
+{
+    int x = 0;
+#if defined(QTTOOLS_AVX2)
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m256i a = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x)));
+        const __m256i b = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x + 8)));
+        const __m128i result = packVector(mapVector(_mm256_cvtepi32_ps(a), map),
+                                          mapVector(_mm256_cvtepi32_ps(b), map));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), result);
+    }
+#elif defined(QTTOOLS_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x + 8));
+        const __m128i a16 = _mm_packs_epi32(mapVector(_mm_cvtepi32_ps(_mm_unpacklo_epi16(a, zero)), map),
+                                            mapVector(_mm_cvtepi32_ps(_mm_unpackhi_epi16(a, zero)), map));
+        const __m128i b16 = _mm_packs_epi32(mapVector(_mm_cvtepi32_ps(_mm_unpacklo_epi16(b, zero)), map),
+                                            mapVector(_mm_cvtepi32_ps(_mm_unpackhi_epi16(b, zero)), map));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(a16, b16));
+    }
+#elif defined(QTTOOLS_NEON)
+    for (; x + 8 <= count; x += 8)
+    {
+        const uint16x8_t v = vld1q_u16(src + x);
+        const uint32x4_t lo = mapVector(vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))), map);
+        const uint32x4_t hi = mapVector(vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))), map);
+        vst1_u8(dst + x, packVector(lo, hi));
+    }
+#endif
+    for (; x < count; ++x)
+        dst[x] = mapScalar(src[x], map);
+}
+
+void mapRow(const float* src, uchar* dst, int count, const LinearMap& map)
+{
+    int x = 0;
+#if defined(QTTOOLS_AVX2)
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m128i result = packVector(mapVector(_mm256_loadu_ps(src + x), map),
+                                          mapVector(_mm256_loadu_ps(src + x + 8), map));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), result);
+    }
+#elif defined(QTTOOLS_SSE2)
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m128i a16 = _mm_packs_epi32(mapVector(_mm_loadu_ps(src + x), map),
+                                            mapVector(_mm_loadu_ps(src + x + 4), map));
+        const __m128i b16 = _mm_packs_epi32(mapVector(_mm_loadu_ps(src + x + 8), map),
+                                            mapVector(_mm_loadu_ps(src + x + 12), map));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(a16, b16));
+    }
+#elif defined(QTTOOLS_NEON)
+    for (; x + 8 <= count; x += 8)
+        vst1_u8(dst + x, packVector(mapVector(vld1q_f32(src + x), map), mapVector(vld1q_f32(src + x + 4), map)));
+#endif
+    for (; x < count; ++x)
+        dst[x] = mapScalar(src[x], map);
+}
+
+/* 输出图像尺寸或格式不符、或缓冲区被共享时重新分配 */
+void prepareDisplay(QImage& display, const QSize& size)
+{
+    if (display.size() != size || display.format() != QImage::Format_Grayscale8 || !display.isDetached())
+        display = QImage(size, QImage::Format_Grayscale8);
+}
+
+/**
+ * @brief 按行分段并行映射
+ * @remarks 在进入并行区域前取得缓冲区指针，避免多个线程同时调用 QImage::scanLine() 触发分离检查
+ */
+template <typename RowAt>
+void mapRows(RowAt rowAt, const QRect& rect, const DisplayWindow& window, QImage& display)
+{
+    const LinearMap map = linearMap(window);
+    std::array<uchar, 256> gamma;
+    const bool useGamma = gammaTable(window.gamma, gamma);
+    uchar* bits = display.bits();
+    const qsizetype bytesPerLine = display.bytesPerLine();
+    const int left = rect.left();
+    const int width = rect.width();
+
+    parallelFor(rect.top(), rect.bottom() + 1, [&](int first, int last)
+    {
+        for (int y = first; y < last; ++y)
+        {
+            uchar* dst = bits + y * bytesPerLine + left;
+            mapRow(rowAt(y) + left, dst, width, map);
+            if (useGamma)
+                for (int x = 0; x < width; ++x)
+                    dst[x] = gamma[dst[x]];
+        }
+    }, ROW_GRAIN);
+}
+
+/**
+ * @brief 输出图像可以复用时只映射区域内的像素，否则映射整幅图像
+ * @remarks 输出图像被共享（如控件仍持有上一帧）时原地写入会先深拷贝整幅图像，
+ * 此时改为新分配并整幅映射
+ */
+template <typename RowAt>
+void mapRegion(RowAt rowAt, const QSize& size, const DisplayWindow& window, QImage& display, const QRegion& region)
+{
+    if (display.size() != size || display.format() != QImage::Format_Grayscale8 || !display.isDetached())
+    {
+        prepareDisplay(display, size);
+        mapRows(rowAt, QRect(QPoint(0, 0), size), window, display);
+        return;
+    }
+    for (const QRect& rect : region)
+    {
+        const QRect area = rect & QRect(QPoint(0, 0), size);
+        if (!area.isEmpty())
+            mapRows(rowAt, area, window, display);
+    }
+}
+
+} // namespace
+
+bool isHighBitDepth(const QImage& image) noexcept
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+    return image.format() == QImage::Format_Grayscale16;
+#else
+    Q_UNUSED(image);
+    return false;
+#endif
+}
+
+bool imageRange(const QImage& image, double& min, double& max)
+{
+    if (image.isNull() || !isHighBitDepth(image))
+        return false;
+
+    quint16 low = std::numeric_limits<quint16>::max();
+    quint16 high = 0;
+    std::mutex mutex;
+    const uchar* bits = image.constBits();
+    const qsizetype bytesPerLine = image.bytesPerLine();
+    const int width = image.width();
+
+    parallelFor(0, image.height(), [&](int first, int last)
+    {
+        quint16 bandLow = std::numeric_limits<quint16>::max();
+        quint16 bandHigh = 0;
+        for (int y = first; y < last; ++y)
+        {
+            const quint16* row = reinterpret_cast<const quint16*>(bits + y * bytesPerLine);
+            const auto range = std::minmax_element(row, row + width);
+            bandLow = std::min(bandLow, *range.first);
+            bandHigh = std::max(bandHigh, *range.second);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        low = std::min(low, bandLow);
+        high = std::max(high, bandHigh);
+    }, ROW_GRAIN);
+
+    min = low;
+    max = high;
+    return true;
+}
+
+void mapToDisplay(const QImage& image, const DisplayWindow& window, QImage& display)
+{
+    if (image.isNull() || !isHighBitDepth(image))
+    {
+        display = QImage();
+        return;
+    }
+
+    prepareDisplay(display, image.size());
+    const uchar* bits = image.constBits();
+    const qsizetype bytesPerLine = image.bytesPerLine();
+    mapRows([bits, bytesPerLine](int y) { return reinterpret_cast<const quint16*>(bits + y * bytesPerLine); },
+            image.rect(), window, display);
+}
+
+void mapToDisplay(const FloatImage& image, const DisplayWindow& window, QImage& display)
+{
+    if (image.isNull())
+    {
+        display = QImage();
+        return;
+    }
+
+    prepareDisplay(display, image.size());
+    mapRows([&image](int y) { return image.constScanLine(y); },
+            QRect(QPoint(0, 0), image.size()), window, display);
+}
+
+/**
+ * @brief 只重新映射变化的区域，其余像素保留上一次的结果
+ * @remarks 显示窗口需与上一次映射相同，输出图像尺寸不符时映射整幅图像
+ */
+void mapToDisplay(const QImage& image, const DisplayWindow& window, QImage& display, const QRegion& region)
+{
+    if (image.isNull() || !isHighBitDepth(image))
+    {
+        display = QImage();
+        return;
+    }
+
+    const uchar* bits = image.constBits();
+    const qsizetype bytesPerLine = image.bytesPerLine();
+    mapRegion([bits, bytesPerLine](int y) { return reinterpret_cast<const quint16*>(bits + y * bytesPerLine); },
+              image.size(), window, display, region);
+}
+
+void mapToDisplay(const FloatImage& image, const DisplayWindow& window, QImage& display, const QRegion& region)
+{
+    if (image.isNull())
+    {
+        display = QImage();
+        return;
+    }
+
+    mapRegion([&image](int y) { return image.constScanLine(y); }, image.size(), window, display, region);
+}
@@ -0,0 +1,184 @@
+/**
+ * @file displaystatistics.cpp
+ * @author ldk
+ * @brief 显示链路的延迟与帧率统计
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "displaystatistics.hpp"
+
+namespace
+{
+
+constexpr double NS_PER_MS{ 1e6 };
+
+/* 取第 p 百分位数，会重排 values */
+double percentile(std::vector<qint64>& values, double p)
+{
+    if (values.empty())
+        return 0.;
+    const size_t index = std::min(values.size() - 1, size_t(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index] / NS_PER_MS;
+}
+
+} // namespace
+
+QString DisplayStats::toString() const
+{
+    QString text = QString("FPS %1  shown %2  dropped %3  dup %4\n"
+                           "latency p50 %5  p90 %6  p99 %7  max %8 ms")
+        .arg(fps, 0, 'f', 1).arg(presented).arg(dropped).arg(duplicated)
+        .arg(latencyP50, 0, 'f', 1).arg(latencyP90, 0, 'f', 1)
+        .arg(latencyP99, 0, 'f', 1).arg(latencyMax, 0, 'f', 1);
+    if (producerLatencyP50 > 0.)
+        text += QString("\nproducer p50 %1  p99 %2 ms").arg(producerLatencyP50, 0, 'f', 1).arg(producerLatencyP99, 0, 'f', 1);
+    if (convertP50 > 0.)
+        text += QString("\nconvert p50 %1 ms").arg(convertP50, 0, 'f', 2);
+    return text;
+}
+
+/**
+ * @brief 单调时钟，纳秒
+ * @remarks 生产者的时间戳需使用同一时钟才能计算端到端延迟
+ */
+qint64 DisplayStatistics::now() noexcept
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief 设置下一次 setImage 的帧信息
+ */
+void DisplayStatistics::setFrameInfo(const FrameInfo& info)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_nextInfo = info;
+}
+
+/* 取出尚未被下一帧使用的生产者信息 */
+FrameInfo DisplayStatistics::takeFrameInfo()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const FrameInfo info = m_nextInfo;
+    m_nextInfo = FrameInfo();
+    return info;
+}
+
+void DisplayStatistics::frameReceived(quint64 frameNumber, qint64 received, qint64 converted)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    FrameTiming& timing = m_pending[frameNumber % Pending];
+    timing = FrameTiming();
+    timing.frameNumber = frameNumber;
+    timing.info = m_nextInfo;
+    timing.received = received;
+    timing.converted = converted;
+    m_nextInfo = FrameInfo();
+}
+
+/* 显示映射在绘制前才进行，完成后更新转换时间 */
+void DisplayStatistics::frameConverted(quint64 frameNumber, qint64 converted)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    FrameTiming& timing = m_pending[frameNumber % Pending];
+    if (timing.frameNumber == frameNumber)
+        timing.converted = converted;
+}
+
+/**
+ * @brief 显示刷新时调用，帧序号相同为重复帧，序号的间隔为丢帧
+ */
+void DisplayStatistics::frameScheduled(quint64 frameNumber)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (frameNumber == m_nLastScheduled)
+    {
+        ++m_nDuplicated;
+        return;
+    }
+    if (m_nLastScheduled != 0 && frameNumber > m_nLastScheduled)
+        m_nDropped += frameNumber - m_nLastScheduled - 1;
+    m_nLastScheduled = frameNumber;
+    m_nScheduled = frameNumber;
+}
+
+/* 绘制完成后调用，只统计新调度的帧 */
+void DisplayStatistics::framePresented(qint64 presented)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_nScheduled == 0)
+        return;
+    const FrameTiming& pending = m_pending[m_nScheduled % Pending];
+    m_nScheduled = 0;
+    if (pending.frameNumber != m_nLastScheduled)
+        return;
+
+    FrameTiming& timing = m_history[m_nHistory % Window];
+    timing = pending;
+    timing.presented = presented;
+    ++m_nHistory;
+    ++m_nPresented;
+}
+
+DisplayStats DisplayStatistics::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    DisplayStats stats;
+    stats.presented = m_nPresented;
+    stats.dropped = m_nDropped;
+    stats.duplicated = m_nDuplicated;
+    const int count = std::min(m_nHistory, Window);
+    if (count == 0)
+        return stats;
+
+    const FrameTiming& last = m_history[(m_nHistory - 1) % Window];
+    stats.lastFrame = last;
+
+    std::vector<qint64> latency, producer, convert;
+    latency.reserve(count);
+    int recent = 0;
+    qint64 earliest = last.presented;
+    for (int i = 0; i < count; ++i)
+    {
+        const FrameTiming& timing = m_history[i];
+        latency.push_back(timing.presented - timing.received);
+        convert.push_back(timing.converted - timing.received);
+        if (timing.info.timestamp > 0)
+            producer.push_back(timing.presented - timing.info.timestamp);
+        if (last.presented - timing.presented < qint64(1e9))
+        {
+            ++recent;
+            earliest = std::min(earliest, timing.presented);
+        }
+    }
+
+    if (recent > 1 && last.presented > earliest)
+        stats.fps = (recent - 1) * 1e9 / (last.presented - earliest);
+    stats.latencyMax = *std::max_element(latency.begin(), latency.end()) / NS_PER_MS;
+    stats.latencyP50 = percentile(latency, 0.5);
+    stats.latencyP90 = percentile(latency, 0.9);
+    stats.latencyP99 = percentile(latency, 0.99);
+    stats.producerLatencyP50 = percentile(producer, 0.5);
+    stats.producerLatencyP99 = percentile(producer, 0.99);
+    stats.convertP50 = percentile(convert, 0.5);
+    return stats;
+}
+
+void DisplayStatistics::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_nPresented = 0;
+    m_nDropped = 0;
+    m_nDuplicated = 0;
+    m_nHistory = 0;
+}
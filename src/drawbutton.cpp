@@ -30,6 +30,7 @@ void DrawButton::startDraw(const QRect& canvas)
     finishDraw();
     m_pDrawWidget = new DrawWidget(parentWidget(), DrawShape::Rectangle, Qt::red, 2);
     connect(m_pDrawWidget, &DrawWidget::drawFinished, this, &DrawButton::setPoints);
+    connect(m_pDrawWidget, &DrawWidget::drawChanged, this, &DrawButton::updateSelection);
     m_pDrawWidget->setGeometry(canvas);
     m_pDrawWidget->show();
 }
@@ -39,6 +40,7 @@ void DrawButton::startDraw(int canvas_x, int canvas_y, int canvasWidth, int canv
     finishDraw();
     m_pDrawWidget = new DrawWidget(parentWidget(), DrawShape::Rectangle, Qt::red, 2);
     connect(m_pDrawWidget, &DrawWidget::drawFinished, this, &DrawButton::setPoints);
+    connect(m_pDrawWidget, &DrawWidget::drawChanged, this, &DrawButton::updateSelection);
     m_pDrawWidget->setGeometry(QRect(canvas_x, canvas_y, canvasWidth, canvasHeight));
     m_pDrawWidget->show();
 }
@@ -48,6 +50,7 @@ void DrawButton::startDraw(QWidget* canvas)
     finishDraw();
     m_pDrawWidget = new DrawWidget(canvas, DrawShape::Rectangle, Qt::red, 2);
     connect(m_pDrawWidget, &DrawWidget::drawFinished, this, &DrawButton::setPoints);
+    connect(m_pDrawWidget, &DrawWidget::drawChanged, this, &DrawButton::updateSelection);
     m_pDrawWidget->setGeometry(0, 0, INT_MAX, INT_MAX);
     m_pDrawWidget->show();
 }
@@ -65,4 +68,11 @@ void DrawButton::setPoints()
 {
     m_start = m_pDrawWidget->startPoint();
     m_stop = m_pDrawWidget->stopPoint();
+    updateSelection();
+}
+
+void DrawButton::updateSelection()
+{
+    emit selectionChanged(m_pDrawWidget->mapToGlobal(m_pDrawWidget->startPoint().toPoint()),
+                          m_pDrawWidget->mapToGlobal(m_pDrawWidget->stopPoint().toPoint()));
 }
@@ -37,6 +37,7 @@ void DrawWidget::mouseMoveEvent(QMouseEvent *event)
         return;
     setStopPoint(event->pos());
     update();
+    emit drawChanged();
 }
 
 void DrawWidget::mouseReleaseEvent(QMouseEvent *event)
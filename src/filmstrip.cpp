@@ -0,0 +1,440 @@
+/**
+ * @file filmstrip.cpp
+ * @author ldk
+ * @brief 虚拟化的缩略图浏览控件
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+
+#include <QCollator>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QScrollBar>
+#include <QStandardPaths>
+#include <QThread>
+
+#include "filmstrip.hpp"
+#include "displaymapping.hpp"
+#include "graphicsviewinterface.hpp"
+#include "imageplayer.hpp"
+#include "parallel.hpp"
+#include "resample.hpp"
+
+namespace
+{
+
+constexpr int EXIF_SCAN_BYTES{ 64 * 1024 };     // 查找 EXIF 段时读取的文件头长度
+constexpr int MEMORY_BUDGET_KB{ 64 * 1024 };    // 内存中缩略图的总大小（KB）
+constexpr int CACHE_QUALITY{ 85 };              // 磁盘缓存的 JPEG 质量
+
+/**
+ * @brief 从 EXIF（TIFF 结构）中取出 IFD1 指向的 JPEG 缩略图
+ */
+QImage parseExifThumbnail(const QByteArray& tiff)
+{
+    if (tiff.size() < 8)
+        return QImage();
+    const bool little = tiff.startsWith("II");
+    if (!little && !tiff.startsWith("MM"))
+        return QImage();
+
+    const auto* data = reinterpret_cast<const uchar*>(tiff.constData());
+    const quint32 size = quint32(tiff.size());
+    auto read16 = [=](quint32 offset) -> quint32 {
+        if (offset + 2 > size)
+            return 0;
+        return little ? quint32(data[offset] | data[offset + 1] << 8)
+                      : quint32(data[offset] << 8 | data[offset + 1]);
+    };
+    auto read32 = [=](quint32 offset) -> quint32 {
+        if (offset + 4 > size)
+            return 0;
+        return little ? read16(offset) | read16(offset + 2) << 16
+                      : read16(offset) << 16 | read16(offset + 2);
+    };
+
+    // IFD0 之后的下一个 IFD 为缩略图目录
+    const quint32 ifd0 = read32(4);
+    const quint32 ifd1 = read32(ifd0 + 2 + read16(ifd0) * 12);
+    if (ifd1 == 0)
+        return QImage();
+
+    quint32 offset = 0, length = 0;
+    const quint32 count = read16(ifd1);
+    for (quint32 i = 0; i < count; ++i)
+    {
+        const quint32 entry = ifd1 + 2 + i * 12;
+        const quint32 tag = read16(entry);
+        if (tag == 0x0201)
+            offset = read32(entry + 8);
+        else if (tag == 0x0202)
+            length = read32(entry + 8);
+    }
+    if (offset == 0 || length == 0 || quint64(offset) + length > size)
+        return QImage();
+    return QImage::fromData(tiff.mid(int(offset), int(length)), "JPEG");
+}
+
+/**
+ * @brief 读取 JPEG 文件 APP1 段中的 EXIF 缩略图，只读取文件头
+ */
+QImage exifThumbnail(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QImage();
+    const QByteArray head = file.read(EXIF_SCAN_BYTES);
+    if (head.size() < 4 || uchar(head[0]) != 0xFF || uchar(head[1]) != 0xD8)
+        return QImage();
+
+    int pos = 2;
+    while (pos + 4 <= head.size() && uchar(head[pos]) == 0xFF)
+    {
+        const uchar marker = uchar(head[pos + 1]);
+        // 到达图像数据
+        if (marker == 0xDA || marker == 0xD9)
+            break;
+        const int length = uchar(head[pos + 2]) << 8 | uchar(head[pos + 3]);
+        if (marker == 0xE1 && length > 8 && head.mid(pos + 4, 6) == QByteArray("Exif\0\0", 6))
+        {
+            QByteArray tiff = head.mid(pos + 10, length - 8);
+            if (tiff.size() < length - 8 && file.seek(pos + 10))
+                tiff = file.read(length - 8);
+            return parseExifThumbnail(tiff);
+        }
+        pos += 2 + length;
+    }
+    return QImage();
+}
+
+/* 高位深图像按取值范围映射为 8 位 */
+QImage displayable(const QImage& image)
+{
+    double min = 0., max = 0.;
+    if (!imageRange(image, min, max))
+        return image;
+    QImage display;
+    mapToDisplay(image, DisplayWindow{ min, max, 1. }, display);
+    return display;
+}
+
+/* 缩小到最长边不超过 size */
+QImage fitTo(const QImage& image, int size)
+{
+    if (image.isNull() || (image.width() <= size && image.height() <= size))
+        return image;
+    return resample(image, QSize(size, size), Qt::KeepAspectRatio, ResampleFilter::Lanczos);
+}
+
+} // namespace
+
+QImage createThumbnail(const QString& path, int size)
+{
+    const QImage exif = exifThumbnail(path);
+    if (std::max(exif.width(), exif.height()) >= size / 2)
+        return fitTo(exif, size);
+
+    QImageReader reader(path);
+    reader.setAutoTransform(true);
+    if (reader.canRead())
+    {
+        const QSize full = reader.size();
+        if (full.isValid() && (full.width() > size || full.height() > size))
+            reader.setScaledSize(full.scaled(size, size, Qt::KeepAspectRatio));
+        const QImage image = reader.read();
+        if (!image.isNull())
+            return fitTo(displayable(image), size);
+    }
+
+    // 带 .hdr 的 raw 等 QImageReader 不支持的格式
+    return fitTo(displayable(GraphicsViewInterface::loadImage(path)), size);
+}
+
+FilmstripModel::FilmstripModel(QObject* parent)
+    : QAbstractListModel(parent)
+    , m_thumbnails(MEMORY_BUDGET_KB)
+    , m_nGeneration(0)
+    , m_nThumbnailSize(0)
+    , m_cacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/thumbnails"))
+{
+    m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
+    setThumbnailSize(DefaultThumbnailSize);
+}
+
+FilmstripModel::~FilmstripModel()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests.clear();
+    }
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+/**
+ * @brief 显示文件夹中的图像，按文件名自然顺序排列
+ * @remarks 只列出文件名，不读取任何图像
+ *
+ * @param directory 文件夹路径
+ * @param nameFilters 文件名过滤器，为空时使用所有支持的图像格式
+ * @return bool 文件夹中是否有图像
+ */
+bool FilmstripModel::setDirectory(const QString& directory, const QStringList& nameFilters)
+{
+    QStringList filters = nameFilters;
+    if (filters.isEmpty())
+    {
+        for (const QByteArray& format : QImageReader::supportedImageFormats())
+            filters << "*." + QString::fromLatin1(format);
+        filters << "*.raw";
+    }
+
+    const QDir dir(directory);
+    QStringList names = dir.entryList(filters, QDir::Files, QDir::NoSort);
+    QCollator collator;
+    collator.setNumericMode(true);
+    std::sort(names.begin(), names.end(), collator);
+
+    QStringList files;
+    files.reserve(names.size());
+    for (const QString& name : names)
+        files << dir.absoluteFilePath(name);
+    setFiles(files);
+    return !files.isEmpty();
+}
+
+void FilmstripModel::setFiles(const QStringList& files)
+{
+    beginResetModel();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests.clear();
+        m_requested.clear();
+    }
+    m_pool.clear();
+    ++m_nGeneration;
+    m_files = files;
+    m_thumbnails.clear();
+    endResetModel();
+}
+
+/**
+ * @brief 设置缩略图最长边，已生成的缩略图全部作废
+ */
+void FilmstripModel::setThumbnailSize(int size)
+{
+    size = std::max(16, size);
+    if (size == m_nThumbnailSize)
+        return;
+    m_nThumbnailSize = size;
+    m_placeholder = QImage(size, size * 3 / 4, QImage::Format_RGB32);
+    m_placeholder.fill(QColor(64, 64, 64));
+    setFiles(m_files);
+}
+
+/**
+ * @brief 设置磁盘缓存目录，为空时不使用磁盘缓存
+ */
+void FilmstripModel::setCacheDirectory(const QString& directory)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cacheDirectory = directory;
+}
+
+void FilmstripModel::setThreadCount(int count)
+{
+    m_pool.setMaxThreadCount(std::max(1, count));
+}
+
+int FilmstripModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_files.size();
+}
+
+/* 缩略图尚未生成时返回占位图并请求生成 */
+QVariant FilmstripModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_files.size())
+        return QVariant();
+
+    const int row = index.row();
+    switch (role)
+    {
+    case Qt::DecorationRole:
+        if (const QImage* thumbnail = m_thumbnails.object(row))
+            return thumbnail->isNull() ? m_placeholder : *thumbnail;
+        request(row);
+        return m_placeholder;
+    case Qt::ToolTipRole:
+    case PathRole:
+        return m_files[row];
+    default:
+        return QVariant();
+    }
+}
+
+/**
+ * @brief 请求生成一行的缩略图
+ * @remarks 快速滚动时排队的请求超过上限后丢弃最早的请求，这些行再次可见时会重新请求
+ */
+void FilmstripModel::request(int row) const
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_requested.insert(row).second)
+            return;
+        m_requests.push_back(Request{ row, m_files[row], m_nGeneration, m_nThumbnailSize });
+        if (int(m_requests.size()) > MaxPendingRequests)
+        {
+            m_requested.erase(m_requests.front().row);
+            m_requests.pop_front();
+        }
+    }
+    FilmstripModel* self = const_cast<FilmstripModel*>(this);
+    runAsync(&m_pool, [self] { self->drain(); });
+}
+
+/* 线程池任务：生成最近一次请求的缩略图 */
+void FilmstripModel::drain()
+{
+    Request request;
+    QString cacheDirectory;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_requests.empty())
+            return;
+        request = m_requests.back();
+        m_requests.pop_back();
+        cacheDirectory = m_cacheDirectory;
+    }
+
+    const QImage thumbnail = loadThumbnail(request.path, request.size, cacheDirectory);
+    QMetaObject::invokeMethod(this, [this, request, thumbnail] { finish(request, thumbnail); }, Qt::QueuedConnection);
+}
+
+void FilmstripModel::finish(const Request& request, const QImage& thumbnail)
+{
+    if (request.generation != m_nGeneration)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requested.erase(request.row);
+    }
+    // 加载失败的文件也记录下来，避免反复请求
+    const int cost = std::max(1, int(thumbnail.sizeInBytes() / 1024));
+    m_thumbnails.insert(request.row, new QImage(thumbnail), cost);
+    const QModelIndex changed = index(request.row);
+    emit dataChanged(changed, changed, { Qt::DecorationRole });
+}
+
+/**
+ * @brief 磁盘缓存文件路径，以 路径 + 修改时间 + 文件大小 + 缩略图尺寸 为键
+ */
+QString FilmstripModel::cachePath(const QString& path, int size, const QString& cacheDirectory)
+{
+    const QFileInfo info(path);
+    const QString key = info.absoluteFilePath() + '|' + QString::number(info.lastModified().toMSecsSinceEpoch())
+                      + '|' + QString::number(info.size()) + '|' + QString::number(size);
+    const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5).toHex();
+    return QDir(cacheDirectory).filePath(QString::fromLatin1(hash) + QStringLiteral(".jpg"));
+}
+
+QImage FilmstripModel::loadThumbnail(const QString& path, int size, const QString& cacheDirectory)
+{
+    const QString cached = cacheDirectory.isEmpty() ? QString() : cachePath(path, size, cacheDirectory);
+    if (!cached.isEmpty())
+    {
+        QImage image;
+        if (image.load(cached, "JPG"))
+            return image;
+    }
+
+    const QImage thumbnail = createThumbnail(path, size);
+    if (!thumbnail.isNull() && !cached.isEmpty() && QDir().mkpath(cacheDirectory))
+    {
+        // 先写临时文件再改名，其他进程不会读到写了一半的缓存
+        const QString temporary = cached + QStringLiteral(".tmp") + QString::number(quintptr(QThread::currentThreadId()));
+        if (thumbnail.save(temporary, "JPG", CACHE_QUALITY) && !QFile::rename(temporary, cached))
+            QFile::remove(temporary);
+    }
+    return thumbnail;
+}
+
+FilmstripWidget::FilmstripWidget(QWidget* parent)
+    : QListView(parent)
+    , m_pModel(new FilmstripModel(this))
+    , m_pPlayer(nullptr)
+{
+    setModel(m_pModel);
+    // 列表模式配合固定的网格尺寸，布局时不需要逐行查询尺寸
+    setViewMode(QListView::ListMode);
+    setFlow(QListView::LeftToRight);
+    setWrapping(false);
+    setMovement(QListView::Static);
+    setUniformItemSizes(true);
+    setLayoutMode(QListView::Batched);
+    setSelectionMode(QAbstractItemView::SingleSelection);
+    setHorizontalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setThumbnailSize(FilmstripModel::DefaultThumbnailSize);
+
+    connect(this, &QListView::clicked, this, &FilmstripWidget::activate);
+    connect(this, &QListView::activated, this, &FilmstripWidget::activate);
+}
+
+bool FilmstripWidget::setDirectory(const QString& directory, const QStringList& nameFilters)
+{
+    return m_pModel->setDirectory(directory, nameFilters);
+}
+
+void FilmstripWidget::setFiles(const QStringList& files)
+{
+    m_pModel->setFiles(files);
+}
+
+/**
+ * @brief 设置缩略图最长边，控件高度随之调整
+ */
+void FilmstripWidget::setThumbnailSize(int size)
+{
+    m_pModel->setThumbnailSize(size);
+    size = m_pModel->thumbnailSize();
+    setIconSize(QSize(size, size));
+    setGridSize(QSize(size + 8, size + 8));
+    setFixedHeight(size + 8 + horizontalScrollBar()->sizeHint().height() + 2 * frameWidth());
+}
+
+/**
+ * @brief 设置显示选中图像的播放器
+ * @remarks 播放器通过 ImagePlayer::setImageList 浏览同一组文件，可以利用其图像缓存预取相邻图像
+ *
+ * @param player 播放器，为空时只发出 imageActivated，所有权不转移
+ */
+void FilmstripWidget::setPlayer(ImagePlayer* player)
+{
+    m_pPlayer = player;
+}
+
+void FilmstripWidget::activate(const QModelIndex& index)
+{
+    if (!index.isValid())
+        return;
+    const QString path = index.data(FilmstripModel::PathRole).toString();
+    emit imageActivated(path, index.row());
+
+    if (m_pPlayer == nullptr)
+        return;
+    if (m_pPlayer->imageList() == m_pModel->files())
+        m_pPlayer->setCurrentIndex(index.row());
+    else
+        m_pPlayer->setImageList(m_pModel->files(), index.row());
+}
@@ -0,0 +1,409 @@
+/**
+ * @file filterpipeline.cpp
+ * @author ldk
+ * @brief 显示前的异步图像处理流水线
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+
+#include "filterpipeline.hpp"
+#include "parallel.hpp"
+
+/**
+ * @brief 处理阶段，调度状态与统计由 m_mutex 保护
+ */
+struct FilterPipeline::Stage
+{
+    QString             name;                   // 阶段名称
+    Filter              filter;                 // 处理函数
+    std::atomic_bool    enabled{ true };        // 是否启用，停用时直接传递输入
+    bool                busy = false;           // 是否有任务在处理
+    bool                hasPending = false;     // 是否有等待处理的帧
+    FilterFrame         pending;                // 等待处理的最新一帧
+    int                 pendingOwner = -1;      // 等待处理的帧由哪个阶段输出，-1 表示外部输入
+    std::vector<QImage> buffers;                // 回收的输出缓冲
+    quint64             processed = 0;
+    quint64             dropped = 0;
+    qint64              lastNs = 0;
+    qint64              totalNs = 0;
+    qint64              maxNs = 0;
+};
+
+namespace
+{
+
+inline double toMs(qint64 ns) noexcept
+{
+    return ns / 1e6;
+}
+
+/* 取出一个不再被引用的缓冲 */
+QImage takeBuffer(std::vector<QImage>& buffers)
+{
+    for (auto it = buffers.begin(); it != buffers.end(); ++it)
+    {
+        if (it->isDetached())
+        {
+            QImage buffer = std::move(*it);
+            buffers.erase(it);
+            return buffer;
+        }
+    }
+    return QImage();
+}
+
+} // namespace
+
+QString FilterPipelineStatistics::toString() const
+{
+    QString text = QString("filter in %1  out %2  latency %3  max %4 ms")
+        .arg(received).arg(delivered).arg(latencyMs, 0, 'f', 1).arg(latencyMaxMs, 0, 'f', 1);
+    for (const FilterStageStatistics& stage : stages)
+        text += QString("\n  %1: %2 frames  dropped %3  mean %4  max %5 ms")
+            .arg(stage.name).arg(stage.processed).arg(stage.dropped)
+            .arg(stage.meanMs, 0, 'f', 2).arg(stage.maxMs, 0, 'f', 2);
+    return text;
+}
+
+FilterPipeline::FilterPipeline(QObject* parent)
+    : QObject(parent)
+    , m_nGeneration(0)
+    , m_bReconfiguring(false)
+    , m_nReceived(0)
+    , m_nDelivered(0)
+    , m_nLatencyNs(0)
+    , m_nLatencyMaxNs(0)
+{
+    m_pool.setMaxThreadCount(1);
+}
+
+FilterPipeline::~FilterPipeline()
+{
+    reconfigure([this] { m_stages.clear(); });
+}
+
+/**
+ * @brief 在末尾添加处理阶段
+ * @remarks 等待正在处理的帧结束后修改，尚未处理的帧丢弃；应在同一线程中配置流水线
+ *
+ * @param name 阶段名称，用于统计
+ * @param filter 处理函数
+ * @return int 阶段序号
+ */
+int FilterPipeline::addStage(const QString& name, Filter filter)
+{
+    int index = 0;
+    reconfigure([&]
+    {
+        auto stage = std::make_unique<Stage>();
+        stage->name = name;
+        stage->filter = std::move(filter);
+        m_stages.push_back(std::move(stage));
+        index = int(m_stages.size()) - 1;
+    });
+    return index;
+}
+
+/**
+ * @brief 移除所有阶段，此后送入的帧直接输出
+ */
+void FilterPipeline::clearStages()
+{
+    reconfigure([this] { m_stages.clear(); });
+}
+
+/**
+ * @brief 启用或停用阶段，停用的阶段直接传递输入，不需要等待流水线空闲
+ */
+void FilterPipeline::setStageEnabled(int index, bool enabled)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (index >= 0 && index < int(m_stages.size()))
+        m_stages[size_t(index)]->enabled.store(enabled, std::memory_order_release);
+}
+
+bool FilterPipeline::isStageEnabled(int index) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return index >= 0 && index < int(m_stages.size()) && m_stages[size_t(index)]->enabled.load(std::memory_order_acquire);
+}
+
+int FilterPipeline::stageCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return int(m_stages.size());
+}
+
+/**
+ * @brief 送入一帧，立即返回
+ * @remarks 只增加图像的引用计数，处理函数不会修改输入图像
+ *
+ * @param image 图像
+ * @param info 生产者的帧信息，随帧传递到输出
+ * @param received 进入流水线的时间，0 表示当前时间
+ * @return bool 图像为空或正在修改阶段配置时返回 false
+ */
+bool FilterPipeline::push(const QImage& image, const FrameInfo& info, qint64 received)
+{
+    if (image.isNull())
+        return false;
+
+    FilterFrame frame{ image, info, received ? received : DisplayStatistics::now() };
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_bReconfiguring)
+            return false;
+        ++m_nReceived;
+        if (!m_stages.empty())
+        {
+            schedule(0, std::move(frame), -1);
+            return true;
+        }
+    }
+    finish(std::move(frame), -1);
+    return true;
+}
+
+/**
+ * @brief 设置输出回调，在线程池中调用
+ * @remarks 返回时正在执行的旧回调已经结束，之后不会再被调用
+ *
+ * @param callback 输出回调，为空时丢弃输出
+ */
+void FilterPipeline::setOutputCallback(OutputCallback callback)
+{
+    std::lock_guard<std::mutex> lock(m_outputMutex);
+    m_output = std::move(callback);
+}
+
+/**
+ * @brief 等待已送入的帧全部处理完毕
+ * @remarks 阶段之间的传递在任务结束前完成，线程池空闲即流水线空闲
+ */
+void FilterPipeline::waitForIdle()
+{
+    m_pool.waitForDone();
+}
+
+FilterPipelineStatistics FilterPipeline::statistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    FilterPipelineStatistics result;
+    result.received = m_nReceived;
+    result.delivered = m_nDelivered;
+    result.latencyMs = toMs(m_nLatencyNs);
+    result.latencyMaxMs = toMs(m_nLatencyMaxNs);
+    result.stages.reserve(m_stages.size());
+    for (const auto& stage : m_stages)
+    {
+        FilterStageStatistics stats;
+        stats.name = stage->name;
+        stats.processed = stage->processed;
+        stats.dropped = stage->dropped;
+        stats.lastMs = toMs(stage->lastNs);
+        stats.meanMs = stage->processed ? toMs(stage->totalNs) / double(stage->processed) : 0.;
+        stats.maxMs = toMs(stage->maxNs);
+        result.stages.push_back(stats);
+    }
+    return result;
+}
+
+void FilterPipeline::resetStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_nReceived = m_nDelivered = 0;
+    m_nLatencyNs = m_nLatencyMaxNs = 0;
+    for (const auto& stage : m_stages)
+    {
+        stage->processed = stage->dropped = 0;
+        stage->lastNs = stage->totalNs = stage->maxNs = 0;
+    }
+}
+
+/**
+ * @brief 准备输出缓冲，尺寸、格式相同且没有其他引用时沿用，否则重新分配
+ *
+ * @param buffer 处理函数收到的 output
+ * @param size 尺寸
+ * @param format 格式
+ * @return bool 分配失败时返回 false
+ */
+bool FilterPipeline::prepareBuffer(QImage& buffer, const QSize& size, QImage::Format format)
+{
+    if (buffer.size() != size || buffer.format() != format || !buffer.isDetached())
+        buffer = QImage(size, format);
+    return !buffer.isNull();
+}
+
+/**
+ * @brief 修改阶段配置：丢弃等待的帧，等待正在运行的任务结束后执行修改
+ */
+void FilterPipeline::reconfigure(const std::function<void()>& change)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bReconfiguring = true;
+        ++m_nGeneration;
+        for (const auto& stage : m_stages)
+        {
+            stage->hasPending = false;
+            stage->pending = FilterFrame();
+        }
+    }
+    // 版本改变后运行中的任务不再向下一阶段传递，线程池中不会再加入新任务
+    m_pool.waitForDone();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& stage : m_stages)
+        stage->busy = false;
+    change();
+    m_pool.setMaxThreadCount(std::max(1, int(m_stages.size())));
+    m_bReconfiguring = false;
+}
+
+/**
+ * @brief 把一帧交给阶段，阶段空闲时启动任务，否则替换等待的帧（调用时已持有 m_mutex）
+ *
+ * @param owner 输出该帧的阶段，其缓冲在帧处理完后回收
+ */
+void FilterPipeline::schedule(int index, FilterFrame frame, int owner)
+{
+    Stage& stage = *m_stages[size_t(index)];
+    if (!stage.busy)
+    {
+        stage.busy = true;
+        const quint64 generation = m_nGeneration;
+        runAsync(&m_pool, [this, index, frame = std::move(frame), owner, generation]() mutable
+        {
+            run(index, std::move(frame), owner, generation);
+        });
+        return;
+    }
+
+    if (stage.hasPending)
+    {
+        ++stage.dropped;
+        recycle(stage.pendingOwner, std::move(stage.pending.image));
+    }
+    stage.pending = std::move(frame);
+    stage.pendingOwner = owner;
+    stage.hasPending = true;
+}
+
+/**
+ * @brief 阶段的任务：处理一帧并传给下一阶段，之后继续处理等待的帧，直到没有等待的帧
+ */
+void FilterPipeline::run(int index, FilterFrame frame, int owner, quint64 generation)
+{
+    Stage& stage = *m_stages[size_t(index)];
+    const bool last = index + 1 == int(m_stages.size());
+    for (;;)
+    {
+        const bool enabled = stage.enabled.load(std::memory_order_acquire);
+        QImage output;
+        int outputOwner = owner;
+        bool accepted = true;
+        qint64 elapsed = 0;
+        if (enabled)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                output = takeBuffer(stage.buffers);
+            }
+            const qint64 start = DisplayStatistics::now();
+            accepted = stage.filter(frame.image, output) && !output.isNull();
+            elapsed = DisplayStatistics::now() - start;
+            outputOwner = index;
+        }
+        else
+        {
+            output = frame.image;
+        }
+
+        FilterFrame result{ std::move(output), frame.info, frame.received };
+        bool deliver = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (generation != m_nGeneration)
+                return;
+            if (enabled)
+            {
+                ++stage.processed;
+                stage.lastNs = elapsed;
+                stage.totalNs += elapsed;
+                stage.maxNs = std::max(stage.maxNs, elapsed);
+                // 输入已处理完，归还给输出它的阶段
+                recycle(owner, std::move(frame.image));
+            }
+            if (!accepted)
+            {
+                ++stage.dropped;
+                recycle(outputOwner, std::move(result.image));
+            }
+            else if (!last)
+            {
+                schedule(index + 1, std::move(result), outputOwner);
+            }
+            else
+            {
+                deliver = true;
+            }
+        }
+        // 最后一个阶段在取下一帧之前输出，保证输出按帧顺序
+        if (deliver)
+            finish(std::move(result), outputOwner);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (generation != m_nGeneration)
+            return;
+        if (!stage.hasPending)
+        {
+            stage.busy = false;
+            return;
+        }
+        frame = std::move(stage.pending);
+        owner = stage.pendingOwner;
+        stage.pending = FilterFrame();
+        stage.hasPending = false;
+    }
+}
+
+/**
+ * @brief 输出一帧，输出后缓冲归还给产生它的阶段，在使用者释放后复用
+ */
+void FilterPipeline::finish(FilterFrame frame, int owner)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        if (m_output)
+            m_output(frame);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const qint64 latency = DisplayStatistics::now() - frame.received;
+    ++m_nDelivered;
+    m_nLatencyNs = latency;
+    m_nLatencyMaxNs = std::max(m_nLatencyMaxNs, latency);
+    recycle(owner, std::move(frame.image));
+}
+
+/**
+ * @brief 把阶段输出的缓冲放回该阶段（调用时已持有 m_mutex）
+ *
+ * @param owner 阶段序号，-1 表示外部输入，不回收
+ */
+void FilterPipeline::recycle(int owner, QImage image)
+{
+    if (owner < 0 || owner >= int(m_stages.size()) || image.isNull())
+        return;
+    std::vector<QImage>& buffers = m_stages[size_t(owner)]->buffers;
+    if (int(buffers.size()) >= BufferCount)
+        buffers.erase(buffers.begin());
+    buffers.push_back(std::move(image));
+}
@@ -0,0 +1,64 @@
+/**
+ * @file floatimage.cpp
+ * @author ldk
+ * @brief 单通道 32 位浮点图像（深度图等）
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "floatimage.hpp"
+
+FloatImage::FloatImage(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return;
+    m_nWidth = width;
+    m_nHeight = height;
+    m_data.resize(width * height);
+}
+
+/**
+ * @brief 从外部缓冲区复制构造
+ *
+ * @param data 像素数据
+ * @param width 宽度
+ * @param height 高度
+ * @param stride 每行的浮点数个数，为 0 时等于宽度
+ */
+FloatImage::FloatImage(const float* data, int width, int height, int stride)
+    : FloatImage(width, height)
+{
+    if (isNull() || data == nullptr)
+        return;
+    if (stride <= 0)
+        stride = width;
+    for (int y = 0; y < height; ++y)
+        std::memcpy(scanLine(y), data + qint64(y) * stride, sizeof(float) * width);
+}
+
+/**
+ * @brief 计算最小值与最大值，忽略 NaN 与无穷大
+ *
+ * @return bool 是否存在有限值
+ */
+bool FloatImage::minMax(float& min, float& max) const
+{
+    min = std::numeric_limits<float>::max();
+    max = std::numeric_limits<float>::lowest();
+    for (float value : m_data)
+    {
+        if (!std::isfinite(value))
+            continue;
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+    return min <= max;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file framediff.cpp
+ * @author ldk
+ * @brief 相邻帧的分块差异检测
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "framediff.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+
+namespace
+{
+
+/* 逐字节差值是否超过阈值 */
+bool rowDiffers(const uchar* a, const uchar* b, int bytes, uchar threshold)
+{
+    if (threshold == 0)
+        return std::memcmp(a, b, bytes) != 0;
+
+    int i = 0;
+#if defined(QTTOOLS_SSE2)
+    const __m128i limit = _mm_set1_epi8(char(threshold));
+    for (; i + 16 <= bytes; i += 16)
+    {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const __m128i diff = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+        // 差值减去阈值后仍不为 0 即超过阈值
+        const __m128i over = _mm_subs_epu8(diff, limit);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(over, _mm_setzero_si128())) != 0xFFFF)
+            return true;
+    }
+#elif defined(QTTOOLS_NEON)
+    const uint8x16_t limit = vdupq_n_u8(threshold);
+    for (; i + 16 <= bytes; i += 16)
+    {
+        const uint8x16_t diff = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+        if (vmaxvq_u8(vcgtq_u8(diff, limit)) != 0)
+            return true;
+    }
+#endif
+    for (; i < bytes; ++i)
+        if (std::abs(a[i] - b[i]) > threshold)
+            return true;
+    return false;
+}
+
+} // namespace
+
+QRegion changedTiles(const QImage& previous, const QImage& current, int tileSize, int threshold)
+{
+    if (current.isNull())
+        return QRegion();
+    if (previous.size() != current.size() || previous.format() != current.format())
+        return QRegion(current.rect());
+    if (previous.cacheKey() == current.cacheKey())
+        return QRegion();
+
+    tileSize = qMax(tileSize, 8);
+    const uchar limit = uchar(qBound(0, threshold, 255));
+    const int bytesPerPixel = qMax(1, current.depth() / 8);
+    const int tilesX = (current.width() + tileSize - 1) / tileSize;
+    const int tilesY = (current.height() + tileSize - 1) / tileSize;
+    const uchar* bitsA = previous.constBits();
+    const uchar* bitsB = current.constBits();
+    const qsizetype bplA = previous.bytesPerLine();
+    const qsizetype bplB = current.bytesPerLine();
+
+    std::vector<char> changed(size_t(tilesX) * tilesY, 0);
+    parallelFor(0, tilesY, [&](int first, int last)
+    {
+        for (int ty = first; ty < last; ++ty)
+        {
+            const int y0 = ty * tileSize;
+            const int y1 = qMin(y0 + tileSize, current.height());
+            for (int tx = 0; tx < tilesX; ++tx)
+            {
+                const int x0 = tx * tileSize;
+                const int bytes = (qMin(x0 + tileSize, current.width()) - x0) * bytesPerPixel;
+                for (int y = y0; y < y1; ++y)
+                {
+                    if (rowDiffers(bitsA + y * bplA + x0 * bytesPerPixel, bitsB + y * bplB + x0 * bytesPerPixel, bytes, limit))
+                    {
+                        changed[size_t(ty) * tilesX + tx] = 1;
+                        break;
+                    }
+                }
+            }
+        }
+    }, 1);
+
+    QRegion region;
+    for (int ty = 0; ty < tilesY; ++ty)
+    {
+        for (int tx = 0; tx < tilesX;)
+        {
+            if (!changed[size_t(ty) * tilesX + tx])
+            {
+                ++tx;
+                continue;
+            }
+            const int begin = tx;
+            while (tx < tilesX && changed[size_t(ty) * tilesX + tx])
+                ++tx;
+            region += QRect(begin * tileSize, ty * tileSize, (tx - begin) * tileSize, tileSize) & current.rect();
+        }
+    }
+    return region;
+}
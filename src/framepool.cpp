@@ -0,0 +1,249 @@
+/**
+ * @file framepool.cpp
+ * @author ldk
+ * @brief 动态显示的帧缓冲池
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <new>
+
+#include "framepool.hpp"
+
+/**
+ * @brief 缓冲头，位于像素数据之前的一个对齐单元中，作为 QImage 释放函数的参数，
+ * 取出与归还都不需要额外分配内存
+ */
+struct alignas(FramePool::Alignment) FramePool::Buffer
+{
+    std::shared_ptr<State>  state;      // 使用期间持有池的状态，空闲时为空，避免循环引用
+    qsizetype               bytes = 0;  // 像素数据字节数
+
+    inline uchar* data() noexcept { return reinterpret_cast<uchar*>(this) + sizeof(Buffer); }
+};
+
+/**
+ * @brief 池的共享状态
+ */
+struct FramePool::State
+{
+    static_assert(sizeof(Buffer) == Alignment, "buffer header must occupy one alignment unit");
+
+    std::mutex          mutex;
+    std::deque<Buffer*> idle;           // 空闲缓冲，尾部为最近归还
+    int                 maxIdle = DefaultMaxIdle;
+    bool                closed = false; // 池已析构，归还的缓冲直接释放
+    FramePoolStatistics statistics;
+
+    ~State()
+    {
+        for (Buffer* buffer : idle)
+            destroy(buffer);
+    }
+
+    /* 分配并逐页写零 */
+    static Buffer* create(qsizetype bytes)
+    {
+        void* memory = ::operator new(sizeof(Buffer) + size_t(bytes), std::align_val_t(Alignment), std::nothrow);
+        if (memory == nullptr)
+            return nullptr;
+        Buffer* buffer = new (memory) Buffer();
+        buffer->bytes = bytes;
+        std::memset(buffer->data(), 0, size_t(bytes));
+        return buffer;
+    }
+
+    static void destroy(Buffer* buffer)
+    {
+        buffer->~Buffer();
+        ::operator delete(static_cast<void*>(buffer), std::align_val_t(Alignment));
+    }
+
+    /* 释放超出上限的最早归还的空闲缓冲，调用前需持有 mutex */
+    void shrink(int limit)
+    {
+        while (int(idle.size()) > limit)
+        {
+            statistics.bytes -= idle.front()->bytes;
+            ++statistics.freed;
+            destroy(idle.front());
+            idle.pop_front();
+        }
+    }
+};
+
+FramePool::FramePool(int maxIdle)
+    : m_pState(std::make_shared<State>())
+{
+    m_pState->maxIdle = std::max(0, maxIdle);
+}
+
+FramePool::~FramePool()
+{
+    std::lock_guard<std::mutex> lock(m_pState->mutex);
+    m_pState->closed = true;
+    m_pState->shrink(0);
+}
+
+/**
+ * @brief 取出一幅图像，优先复用字节数相同的空闲缓冲
+ * @remarks 复用的缓冲保留上一帧的内容，调用方应写满整幅图像
+ *
+ * @param size 尺寸
+ * @param format 像素格式，Indexed8 等索引格式需调用方设置颜色表
+ * @return QImage 参数无效或内存不足时返回空图像
+ */
+QImage FramePool::acquire(const QSize& size, QImage::Format format)
+{
+    const qsizetype bytesPerLine = alignedBytesPerLine(size.width(), format);
+    if (bytesPerLine <= 0 || size.height() <= 0 || bytesPerLine > qsizetype(INT_MAX))
+        return QImage();
+    const qsizetype bytes = bytesPerLine * size.height();
+
+    Buffer* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_pState->mutex);
+        auto it = std::find_if(m_pState->idle.rbegin(), m_pState->idle.rend(),
+                               [bytes](const Buffer* idle) { return idle->bytes == bytes; });
+        if (it != m_pState->idle.rend())
+        {
+            buffer = *it;
+            m_pState->idle.erase(std::next(it).base());
+        }
+    }
+    const bool created = buffer == nullptr;
+    if (created)
+    {
+        // 在锁外分配与写零
+        buffer = State::create(bytes);
+        if (buffer == nullptr)
+            return QImage();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_pState->mutex);
+        FramePoolStatistics& statistics = m_pState->statistics;
+        ++statistics.acquired;
+        if (created)
+        {
+            ++statistics.allocated;
+            statistics.bytes += bytes;
+            statistics.peakBytes = std::max(statistics.peakBytes, statistics.bytes);
+        }
+        ++statistics.inUse;
+        statistics.peakInUse = std::max(statistics.peakInUse, statistics.inUse);
+        statistics.idle = int(m_pState->idle.size());
+    }
+    buffer->state = m_pState;
+    QImage image(buffer->data(), size.width(), size.height(), int(bytesPerLine), format, release, buffer);
+    // 构造失败时不会调用释放函数
+    if (image.isNull())
+        release(buffer);
+    return image;
+}
+
+/**
+ * @brief 预先分配并写零 count 个缓冲，使最初几帧也不需要分配
+ */
+void FramePool::reserve(const QSize& size, QImage::Format format, int count)
+{
+    const qsizetype bytesPerLine = alignedBytesPerLine(size.width(), format);
+    if (bytesPerLine <= 0 || size.height() <= 0)
+        return;
+    const qsizetype bytes = bytesPerLine * size.height();
+
+    std::lock_guard<std::mutex> lock(m_pState->mutex);
+    const int existing = int(std::count_if(m_pState->idle.begin(), m_pState->idle.end(),
+                                           [bytes](const Buffer* idle) { return idle->bytes == bytes; }));
+    m_pState->maxIdle = std::max(m_pState->maxIdle, count);
+    for (int i = existing; i < count; ++i)
+    {
+        Buffer* buffer = State::create(bytes);
+        if (buffer == nullptr)
+            break;
+        m_pState->idle.push_back(buffer);
+        ++m_pState->statistics.allocated;
+        m_pState->statistics.bytes += bytes;
+    }
+    m_pState->statistics.idle = int(m_pState->idle.size());
+    m_pState->statistics.peakBytes = std::max(m_pState->statistics.peakBytes, m_pState->statistics.bytes);
+}
+
+/**
+ * @brief 设置保留的空闲缓冲数，超出的缓冲立即释放
+ */
+void FramePool::setMaxIdle(int count)
+{
+    std::lock_guard<std::mutex> lock(m_pState->mutex);
+    m_pState->maxIdle = std::max(0, count);
+    m_pState->shrink(m_pState->maxIdle);
+    m_pState->statistics.idle = int(m_pState->idle.size());
+}
+
+/**
+ * @brief 释放全部空闲缓冲，使用中的缓冲归还后仍按上限保留
+ */
+void FramePool::trim()
+{
+    std::lock_guard<std::mutex> lock(m_pState->mutex);
+    m_pState->shrink(0);
+    m_pState->statistics.idle = 0;
+}
+
+/* 重置计数与峰值，当前占用保留 */
+void FramePool::resetStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_pState->mutex);
+    FramePoolStatistics& statistics = m_pState->statistics;
+    const FramePoolStatistics current = statistics;
+    statistics = FramePoolStatistics();
+    statistics.inUse = statistics.peakInUse = current.inUse;
+    statistics.idle = current.idle;
+    statistics.bytes = statistics.peakBytes = current.bytes;
+}
+
+FramePoolStatistics FramePool::statistics() const
+{
+    std::lock_guard<std::mutex> lock(m_pState->mutex);
+    return m_pState->statistics;
+}
+
+/**
+ * @brief 按 64 字节对齐的每行字节数
+ *
+ * @return qsizetype 格式无效时返回 0
+ */
+qsizetype FramePool::alignedBytesPerLine(int width, QImage::Format format)
+{
+    if (width <= 0 || format <= QImage::Format_Invalid || format >= QImage::NImageFormats)
+        return 0;
+    const qsizetype bits = qsizetype(width) * QImage::toPixelFormat(format).bitsPerPixel();
+    const qsizetype bytes = (bits + 7) / 8;
+    return (bytes + Alignment - 1) / Alignment * Alignment;
+}
+
+/* QImage 的释放函数：归还缓冲，池已析构或空闲缓冲过多时释放 */
+void FramePool::release(void* info)
+{
+    Buffer* buffer = static_cast<Buffer*>(info);
+    const std::shared_ptr<State> state = std::move(buffer->state);
+    std::lock_guard<std::mutex> lock(state->mutex);
+    --state->statistics.inUse;
+    if (state->closed)
+    {
+        state->statistics.bytes -= buffer->bytes;
+        State::destroy(buffer);
+        return;
+    }
+    state->idle.push_back(buffer);
+    state->shrink(state->maxIdle);
+    state->statistics.idle = int(state->idle.size());
+}
@@ -0,0 +1,481 @@
+/**
+ * @file framerecorder.cpp
+ * @author ldk
+ * @brief 动态显示帧的后台录制
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include <QBuffer>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QtEndian>
+
+#include "framerecorder.hpp"
+#include "displaystatistics.hpp"
+#include "parallel.hpp"
+
+namespace
+{
+
+constexpr char  INDEX_MAGIC[8] = { 'Q', 'T', 'R', 'E', 'C', '0', '0', '1' };
+constexpr int   INDEX_HEADER_SIZE{ 16 };    // 魔数 + 格式 + 保留
+constexpr int   INDEX_ENTRY_SIZE{ 32 };     // 帧序号 + 时间戳 + 偏移 + 长度
+constexpr int   FRAME_HEADER_SIZE{ 16 };    // 宽 + 高 + 像素格式 + 每行字节数
+
+/* 以小端序追加 */
+template <typename T>
+void appendLittleEndian(QByteArray& buffer, T value)
+{
+    const int offset = buffer.size();
+    buffer.resize(offset + int(sizeof(T)));
+    qToLittleEndian(value, reinterpret_cast<uchar*>(buffer.data() + offset));
+}
+
+template <typename T>
+T readLittleEndian(const QByteArray& buffer, int offset)
+{
+    return qFromLittleEndian<T>(reinterpret_cast<const uchar*>(buffer.constData() + offset));
+}
+
+} // namespace
+
+FrameRecorder::FrameRecorder(QObject* parent)
+    : QObject(parent)
+    , m_bStopping(true)
+    , m_nPeakQueued(0)
+    , m_nSequence(0)
+    , m_nNextWrite(0)
+    , m_bRecording(false)
+    , m_bFailed(false)
+    , m_nReceived(0)
+    , m_nWritten(0)
+    , m_nDropped(0)
+    , m_nBytes(0)
+    , m_nBlockedNs(0)
+    , m_ImageFormat("png")
+    , m_Format(Format::Raw)
+    , m_Policy(Policy::Drop)
+    , m_nCapacity(DefaultCapacity)
+    , m_nWorkerCount(DefaultWorkerCount)
+    , m_nQuality(DefaultQuality)
+{
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    stop();
+}
+
+/**
+ * @brief 开始录制，正在录制时先停止上一次录制
+ *
+ * @param path Raw / Mjpeg 为数据文件路径（索引为 path + ".idx"），ImageSequence 为输出目录
+ * @param format 输出格式
+ * @return bool 输出文件是否创建成功，失败原因见 errorString()
+ */
+bool FrameRecorder::start(const QString& path, Format format)
+{
+    stop();
+    m_Path = path;
+    m_Format = format;
+    m_bFailed.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        m_Error.clear();
+    }
+
+    if (format == Format::ImageSequence)
+    {
+        if (!QDir().mkpath(path))
+        {
+            std::lock_guard<std::mutex> lock(m_errorMutex);
+            m_Error = tr("Cannot create directory %1").arg(path);
+            return false;
+        }
+    }
+    else
+    {
+        m_dataFile.setFileName(path);
+        m_indexFile.setFileName(path + QStringLiteral(".idx"));
+        if (!m_dataFile.open(QIODevice::WriteOnly | QIODevice::Truncate)
+         || !m_indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            std::lock_guard<std::mutex> lock(m_errorMutex);
+            m_Error = m_dataFile.isOpen() ? m_indexFile.errorString() : m_dataFile.errorString();
+            m_dataFile.close();
+            m_indexFile.close();
+            return false;
+        }
+
+        QByteArray header(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        appendLittleEndian<quint32>(header, quint32(format));
+        appendLittleEndian<quint32>(header, 0);
+        m_indexFile.write(header);
+    }
+
+    resetStatistics();
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_queue.clear();
+        m_nSequence = 0;
+        m_bStopping = false;
+    }
+    m_nNextWrite = 0;
+    m_pool.setMaxThreadCount(m_nWorkerCount);
+    m_bRecording.store(true, std::memory_order_release);
+    for (int i = 0; i < m_nWorkerCount; ++i)
+        runAsync(&m_pool, [this] { work(); });
+    return true;
+}
+
+/**
+ * @brief 停止录制，等待已排队的帧全部写入后关闭文件
+ */
+void FrameRecorder::stop()
+{
+    m_bRecording.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_bStopping = true;
+    }
+    m_notEmpty.notify_all();
+    m_notFull.notify_all();
+    m_pool.waitForDone();
+
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    m_pending.clear();
+    if (m_dataFile.isOpen())
+        m_dataFile.close();
+    if (m_indexFile.isOpen())
+        m_indexFile.close();
+}
+
+/**
+ * @brief 送入一帧，只增加图像的引用计数
+ * @remarks Drop 策略下不会等待；Block 策略下队列已满时阻塞调用线程直到有空位，
+ * 因此 Block 只应在生产者线程（动态模式）中使用
+ *
+ * @param frame 图像
+ * @param frameNumber 帧序号
+ * @param timestamp 到达时间（DisplayStatistics::now() 时钟）
+ * @return bool 是否已放入队列
+ */
+bool FrameRecorder::push(const QImage& frame, quint64 frameNumber, qint64 timestamp)
+{
+    if (frame.isNull() || !m_bRecording.load(std::memory_order_acquire))
+        return false;
+    m_nReceived.fetch_add(1, std::memory_order_relaxed);
+
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    if (int(m_queue.size()) >= m_nCapacity)
+    {
+        if (m_Policy == Policy::Drop)
+        {
+            m_nDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        const qint64 begin = DisplayStatistics::now();
+        m_notFull.wait(lock, [this] { return int(m_queue.size()) < m_nCapacity || m_bStopping; });
+        m_nBlockedNs.fetch_add(DisplayStatistics::now() - begin, std::memory_order_relaxed);
+    }
+    if (m_bStopping)
+        return false;
+
+    Entry entry;
+    entry.image = frame;
+    entry.sequence = m_nSequence++;
+    entry.frameNumber = frameNumber;
+    entry.timestamp = timestamp;
+    m_queue.push_back(std::move(entry));
+    m_nPeakQueued = std::max(m_nPeakQueued, int(m_queue.size()));
+    lock.unlock();
+    m_notEmpty.notify_one();
+    return true;
+}
+
+void FrameRecorder::setPolicy(Policy policy)
+{
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    m_Policy = policy;
+}
+
+void FrameRecorder::setCapacity(int capacity)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_nCapacity = std::max(1, capacity);
+    }
+    m_notFull.notify_all();
+}
+
+/**
+ * @brief 设置编码线程数，下一次 start() 时生效
+ */
+void FrameRecorder::setWorkerCount(int count)
+{
+    m_nWorkerCount = std::max(1, count);
+}
+
+/**
+ * @brief 设置 Mjpeg 与 ImageSequence 的编码质量（0 - 100）
+ */
+void FrameRecorder::setQuality(int quality)
+{
+    m_nQuality = std::clamp(quality, 0, 100);
+}
+
+/**
+ * @brief 设置 ImageSequence 的图像格式，如 "png"、"bmp"、"jpg"
+ */
+void FrameRecorder::setImageFormat(const QByteArray& format)
+{
+    m_ImageFormat = format;
+}
+
+void FrameRecorder::resetStatistics()
+{
+    m_nReceived.store(0, std::memory_order_relaxed);
+    m_nWritten.store(0, std::memory_order_relaxed);
+    m_nDropped.store(0, std::memory_order_relaxed);
+    m_nBytes.store(0, std::memory_order_relaxed);
+    m_nBlockedNs.store(0, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    m_nPeakQueued = int(m_queue.size());
+}
+
+RecorderStatistics FrameRecorder::statistics() const
+{
+    RecorderStatistics statistics;
+    statistics.received = m_nReceived.load(std::memory_order_relaxed);
+    statistics.written = m_nWritten.load(std::memory_order_relaxed);
+    statistics.dropped = m_nDropped.load(std::memory_order_relaxed);
+    statistics.bytes = m_nBytes.load(std::memory_order_relaxed);
+    statistics.blockedNs = m_nBlockedNs.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    statistics.queued = int(m_queue.size());
+    statistics.peakQueued = m_nPeakQueued;
+    return statistics;
+}
+
+QString FrameRecorder::errorString() const
+{
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    return m_Error;
+}
+
+/* 编码线程：取出队首的帧直到停止且队列为空 */
+void FrameRecorder::work()
+{
+    for (;;)
+    {
+        Entry entry;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_notEmpty.wait(lock, [this] { return !m_queue.empty() || m_bStopping; });
+            if (m_queue.empty())
+                return;
+            entry = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        m_notFull.notify_one();
+        if (!m_bFailed.load(std::memory_order_acquire))
+            process(std::move(entry));
+    }
+}
+
+/* 编码一帧，ImageSequence 直接写出文件，其余格式交给 commit() 按顺序写入 */
+void FrameRecorder::process(Entry entry)
+{
+    if (m_Format == Format::ImageSequence)
+    {
+        const QString name = QStringLiteral("frame_%1.%2").arg(entry.sequence, 6, 10, QChar('0'))
+                                                          .arg(QString::fromLatin1(m_ImageFormat));
+        const QString path = QDir(m_Path).filePath(name);
+        QImageWriter writer(path, m_ImageFormat);
+        writer.setQuality(m_nQuality);
+        if (!writer.write(entry.image))
+        {
+            fail(writer.errorString());
+            return;
+        }
+        m_nWritten.fetch_add(1, std::memory_order_relaxed);
+        m_nBytes.fetch_add(quint64(QFileInfo(path).size()), std::memory_order_relaxed);
+        return;
+    }
+
+    Encoded encoded;
+    if (m_Format == Format::Raw)
+    {
+        const QImage& image = entry.image;
+        appendLittleEndian<quint32>(encoded.header, quint32(image.width()));
+        appendLittleEndian<quint32>(encoded.header, quint32(image.height()));
+        appendLittleEndian<quint32>(encoded.header, quint32(image.format()));
+        appendLittleEndian<quint32>(encoded.header, quint32(image.bytesPerLine()));
+        // 引用图像自身的像素，写入前图像一直保存在 encoded.entry 中
+        encoded.data = QByteArray::fromRawData(reinterpret_cast<const char*>(image.constBits()),
+                                               int(image.sizeInBytes()));
+    }
+    else
+    {
+        QBuffer buffer(&encoded.data);
+        buffer.open(QIODevice::WriteOnly);
+        QImageWriter writer(&buffer, "jpeg");
+        writer.setQuality(m_nQuality);
+        if (!writer.write(entry.image))
+        {
+            fail(writer.errorString());
+            return;
+        }
+    }
+    encoded.entry = std::move(entry);
+    commit(std::move(encoded));
+}
+
+/* 编码线程完成的顺序不定，按录制序号依次写入 */
+void FrameRecorder::commit(Encoded encoded)
+{
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    const quint64 sequence = encoded.entry.sequence;
+    m_pending.emplace(sequence, std::move(encoded));
+    while (!m_pending.empty() && m_pending.begin()->first == m_nNextWrite)
+    {
+        if (!m_bFailed.load(std::memory_order_acquire) && !writeFrame(m_pending.begin()->second))
+            fail(m_dataFile.errorString());
+        m_pending.erase(m_pending.begin());
+        ++m_nNextWrite;
+    }
+}
+
+/* 写入一帧及其索引，调用方持有 m_writeMutex */
+bool FrameRecorder::writeFrame(const Encoded& encoded)
+{
+    const quint64 offset = quint64(m_dataFile.pos());
+    const quint64 size = quint64(encoded.header.size() + encoded.data.size());
+    if (m_dataFile.write(encoded.header) != encoded.header.size()
+     || m_dataFile.write(encoded.data) != encoded.data.size())
+        return false;
+
+    QByteArray index;
+    index.reserve(INDEX_ENTRY_SIZE);
+    appendLittleEndian<quint64>(index, encoded.entry.frameNumber);
+    appendLittleEndian<qint64>(index, encoded.entry.timestamp);
+    appendLittleEndian<quint64>(index, offset);
+    appendLittleEndian<quint64>(index, size);
+    if (m_indexFile.write(index) != index.size())
+        return false;
+
+    m_nWritten.fetch_add(1, std::memory_order_relaxed);
+    m_nBytes.fetch_add(size, std::memory_order_relaxed);
+    return true;
+}
+
+/* 写入失败：停止接收新帧，丢弃剩余的帧，在对象所在线程中发出 errorOccurred */
+void FrameRecorder::fail(const QString& message)
+{
+    if (m_bFailed.exchange(true, std::memory_order_acq_rel))
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        m_Error = message;
+    }
+    m_bRecording.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_bStopping = true;
+    }
+    m_notEmpty.notify_all();
+    m_notFull.notify_all();
+    QMetaObject::invokeMethod(this, [this, message] { emit errorOccurred(message); }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief 打开录制文件
+ *
+ * @param path 数据文件路径，索引文件为 path + ".idx"
+ * @return bool 索引有效且数据文件可读
+ */
+bool RecordingReader::open(const QString& path)
+{
+    close();
+    QFile indexFile(path + QStringLiteral(".idx"));
+    if (!indexFile.open(QIODevice::ReadOnly))
+        return false;
+    const QByteArray index = indexFile.readAll();
+    if (index.size() < INDEX_HEADER_SIZE || !index.startsWith(QByteArray(INDEX_MAGIC, sizeof(INDEX_MAGIC))))
+        return false;
+
+    const quint32 format = readLittleEndian<quint32>(index, sizeof(INDEX_MAGIC));
+    if (format != quint32(FrameRecorder::Format::Raw) && format != quint32(FrameRecorder::Format::Mjpeg))
+        return false;
+    m_Format = FrameRecorder::Format(format);
+
+    // 录制中断时最后一条索引可能不完整，忽略之
+    const int count = (index.size() - INDEX_HEADER_SIZE) / INDEX_ENTRY_SIZE;
+    m_index.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const int offset = INDEX_HEADER_SIZE + i * INDEX_ENTRY_SIZE;
+        IndexEntry& entry = m_index[i];
+        entry.frameNumber = readLittleEndian<quint64>(index, offset);
+        entry.timestamp = readLittleEndian<qint64>(index, offset + 8);
+        entry.offset = readLittleEndian<quint64>(index, offset + 16);
+        entry.size = readLittleEndian<quint64>(index, offset + 24);
+    }
+
+    m_dataFile.setFileName(path);
+    if (!m_dataFile.open(QIODevice::ReadOnly))
+    {
+        m_index.clear();
+        return false;
+    }
+    return true;
+}
+
+void RecordingReader::close()
+{
+    m_dataFile.close();
+    m_index.clear();
+}
+
+/**
+ * @brief 读取第 index 帧
+ *
+ * @return QImage 序号越界或数据损坏时为空
+ */
+QImage RecordingReader::frame(int index)
+{
+    if (index < 0 || index >= frameCount() || !m_dataFile.seek(qint64(m_index[index].offset)))
+        return QImage();
+    const QByteArray data = m_dataFile.read(qint64(m_index[index].size));
+    if (quint64(data.size()) != m_index[index].size)
+        return QImage();
+
+    if (m_Format == FrameRecorder::Format::Mjpeg)
+        return QImage::fromData(data, "JPEG");
+
+    if (data.size() < FRAME_HEADER_SIZE)
+        return QImage();
+    const int width = int(readLittleEndian<quint32>(data, 0));
+    const int height = int(readLittleEndian<quint32>(data, 4));
+    const auto format = QImage::Format(readLittleEndian<quint32>(data, 8));
+    const int bytesPerLine = int(readLittleEndian<quint32>(data, 12));
+    if (qint64(bytesPerLine) * height > data.size() - FRAME_HEADER_SIZE)
+        return QImage();
+
+    QImage image(width, height, format);
+    if (image.isNull())
+        return QImage();
+    const int rowBytes = std::min(bytesPerLine, int(image.bytesPerLine()));
+    const char* src = data.constData() + FRAME_HEADER_SIZE;
+    for (int y = 0; y < height; ++y)
+        std::memcpy(image.scanLine(y), src + qint64(y) * bytesPerLine, rowBytes);
+    return image;
+}
@@ -0,0 +1,31 @@
+/**
+ * @file framesource.cpp
+ * @author ldk
+ * @brief 帧源接口
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "framesource.hpp"
+
+/**
+ * @brief 设置帧回调
+ * @remarks 返回时正在执行的旧回调已经结束，之后不会再被调用
+ *
+ * @param callback 帧回调，为空时丢弃帧
+ */
+void FrameSource::setFrameCallback(FrameCallback callback)
+{
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    m_callback = std::move(callback);
+}
+
+void FrameSource::deliver(const QImage& frame, const FrameInfo& info)
+{
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    if (m_callback)
+        m_callback(frame, info);
+}
@@ -9,12 +9,60 @@
  * 
  */
 
+#include <algorithm>
+#include <unordered_set>
+
 #include <QBoxLayout>
 #include <QImageReader>
+#include <QThread>
 #include <QtCore/qglobal.h>
+#include <QtCore/qnumeric.h>
 
 #include "graphicsviewinterface.hpp"
+#include "framediff.hpp"
+#include "framerecorder.hpp"
 #include "graphicsview.hpp"
+#include "imagecache.hpp"
+#include "imageitem.hpp"
+#include "mappedimage.hpp"
+
+namespace
+{
+
+/**
+ * @brief 读取一行中从 first 开始的 count 个原始值
+ * @remarks 浮点与高位深图像为原始值，其他图像为灰度值，图像外的点为 NaN
+ */
+void sampleRow(const QImage& image, const FloatImage& floatImage, int y, int first, int count, double* out)
+{
+	const int width = floatImage.isNull() ? image.width() : floatImage.width();
+	const int height = floatImage.isNull() ? image.height() : floatImage.height();
+	if (y < 0 || y >= height || (floatImage.isNull() && image.isNull()))
+	{
+		std::fill(out, out + count, qQNaN());
+		return;
+	}
+
+	const uchar* row = floatImage.isNull() ? image.constScanLine(y) : nullptr;
+	for (int i = 0; i < count; ++i)
+	{
+		const int x = first + i;
+		if (x < 0 || x >= width)
+			out[i] = qQNaN();
+		else if (!floatImage.isNull())
+			out[i] = floatImage.value(x, y);
+		else if (::isHighBitDepth(image))
+			out[i] = reinterpret_cast<const quint16*>(row)[x];
+		else if (image.format() == QImage::Format_Grayscale8)
+			out[i] = row[x];
+		else if (image.format() == QImage::Format_RGB32 || image.format() == QImage::Format_ARGB32)
+			out[i] = qGray(reinterpret_cast<const QRgb*>(row)[x]);
+		else
+			out[i] = qGray(image.pixel(x, y));
+	}
+}
+
+} // namespace
 
 GraphicsViewInterface::GraphicsViewInterface
 (
@@ -24,9 +72,33 @@ GraphicsViewInterface::GraphicsViewInterface
 	double      maxZoom
 )
 	: m_bDynamically(false)
-	, m_qtImage(QImage())
 	, m_pWidget(new GraphicsView(this, parent, minZoom, maxZoom))
+	, m_qtImage(QImage())
+	, m_floatImage()
+	, m_displayBuffers()
+	, m_displayWindow()
+	, m_bAutoWindow(true)
+	, m_bColorFull(true)
+	, m_bRetainSource(true)
+	, m_bSourceReleased(false)
+	, m_pRegionDecoder(nullptr)
+	, m_bRegionDecoding(false)
+	, m_nRegionThreshold(RegionDecoder::DefaultThreshold)
+	, m_bDisplayDirty(true)
+	, m_nFrameNumber(0)
+	, m_bMapFull(true)
+	, m_bViewFull(true)
+	, m_bAutoDirty(false)
+	, m_nDirtyTileSize(64)
+	, m_nDirtyThreshold(0)
+	, m_pImageCache(nullptr)
+	, m_pRecorder(nullptr)
+	, m_pPipeline(nullptr)
+	, m_bFilteredPending(false)
+	, m_bOverlayDirty(false)
 	, m_Position(QPoint())
+	, m_bMemoryDirty(true)
+	, m_nMemoryImageKey(0)
 {
 	Init(panel);
 }
@@ -40,15 +112,57 @@ GraphicsViewInterface::GraphicsViewInterface
 	double        maxZoom
 )
 	: m_bDynamically(false)
-	, m_qtImage(QImage(image.copy()))
 	, m_pWidget(new GraphicsView(this, parent, minZoom, maxZoom))
+	, m_qtImage(image)
+	, m_floatImage()
+	, m_displayBuffers()
+	, m_displayWindow()
+	, m_bAutoWindow(true)
+	, m_bColorFull(true)
+	, m_bRetainSource(true)
+	, m_bSourceReleased(false)
+	, m_pRegionDecoder(nullptr)
+	, m_bRegionDecoding(false)
+	, m_nRegionThreshold(RegionDecoder::DefaultThreshold)
+	, m_bDisplayDirty(true)
+	, m_nFrameNumber(0)
+	, m_bMapFull(true)
+	, m_bViewFull(true)
+	, m_bAutoDirty(false)
+	, m_nDirtyTileSize(64)
+	, m_nDirtyThreshold(0)
+	, m_pImageCache(nullptr)
+	, m_pRecorder(nullptr)
+	, m_pPipeline(nullptr)
+	, m_bFilteredPending(false)
+	, m_bOverlayDirty(false)
 	, m_Position(QPoint())
+	, m_bMemoryDirty(true)
+	, m_nMemoryImageKey(0)
 {
 	Init(panel);
 }
 
+/**
+ * @brief 以接管的图像构造，不深拷贝
+ * @remarks 调用方不得再通过其他副本或原始指针修改其像素
+ */
+GraphicsViewInterface::GraphicsViewInterface
+(
+	QBoxLayout* panel,
+	QImage&&    image,
+	QWidget*    parent,
+	double      minZoom,
+	double      maxZoom
+)
+	: GraphicsViewInterface(panel, parent, minZoom, maxZoom)
+{
+	m_qtImage = std::move(image);
+}
+
 GraphicsViewInterface::~GraphicsViewInterface()
 {
+	setFilterPipeline(nullptr);
 	StaticMode();
 	if (m_pWidget)
 		m_pWidget->deleteLater();
@@ -62,6 +176,10 @@ void GraphicsViewInterface::Init(QBoxLayout* panel)
 {
 	if (panel)
 		panel->addWidget(m_pWidget);
+	connect(this, &GraphicsViewInterface::viewChanged, this, &GraphicsViewInterface::refreshCompare);
+	m_pRegionDecoder = new RegionDecoder(this);
+	// 概览图与分块在线程池中解码，tileReady() 在解码器所在的 GUI 线程发出
+	connect(m_pRegionDecoder, &RegionDecoder::tileReady, this, [this] { m_pWidget->viewport()->update(); });
 }
 
 int GraphicsViewInterface::width() const noexcept
@@ -106,7 +224,9 @@ void GraphicsViewInterface::DynamicMode(int _RefreshTime)
 	// 开启动态刷新模式
 	m_pWidget->dynamicMode(_RefreshTime);
 	// 转换状态需要刷新图像，否则会报错
+	m_pRegionDecoder->close();
 	m_qtImage = QImage();
+	m_floatImage = FloatImage();
 	m_bDynamically.store(true, std::memory_order_release);
 }
 
@@ -123,6 +243,7 @@ void GraphicsViewInterface::StaticMode()
 	m_pWidget->staticMode();
 	// 转换状态需要刷新图像，否则会报错
 	m_qtImage = QImage();
+	m_floatImage = FloatImage();
 	m_bDynamically.store(false, std::memory_order_release);
 }
 
@@ -133,7 +254,27 @@ void GraphicsViewInterface::StaticMode()
  */
 void GraphicsViewInterface::setImageStatically(const QImage& _image)
 {
+	if (filterPipeline() && filterFrame(_image.copy()))
+		return;
     m_qtImage = _image.copy();
+	m_floatImage = FloatImage();
+	markNewFrame();
+	m_pWidget->setImage();
+}
+
+/**
+ * @brief 静态设置图像，接管图像数据而不深拷贝
+ * @remarks 调用方不得再通过其他副本或原始指针修改其像素
+ *
+ * @param image 待展示的图像
+ */
+void GraphicsViewInterface::setImageStatically(QImage&& _image)
+{
+	if (filterFrame(_image))
+		return;
+	m_qtImage = std::move(_image);
+	m_floatImage = FloatImage();
+	markNewFrame();
 	m_pWidget->setImage();
 }
 
@@ -144,13 +285,951 @@ void GraphicsViewInterface::setImageStatically(const QImage& _image)
  */
 void GraphicsViewInterface::setImageStatically(const QString& _path)
 {
+	if (m_bRegionDecoding)
+	{
+		QSize size;
+		if (RegionDecoder::canDecode(_path, &size) && qint64(size.width()) * size.height() >= m_nRegionThreshold
+			&& m_pRegionDecoder->open(_path))
+		{
+			m_qtImage = QImage();
+			m_floatImage = FloatImage();
+			markNewFrame();
+			m_pWidget->setImage();
+			return;
+		}
+	}
+	m_pRegionDecoder->close();
+	const QImage image = m_pImageCache ? m_pImageCache->image(_path) : loadImage(_path);
+	if (filterFrame(image))
+		return;
+	m_qtImage = image;
+	m_floatImage = FloatImage();
+	markNewFrame();
+	m_pWidget->setImage();
+}
+
+/**
+ * @brief 静态设置浮点图像
+ *
+ * @param image 待展示的浮点图像
+ */
+void GraphicsViewInterface::setImageStatically(const FloatImage& _image)
+{
+	m_floatImage = _image;
+	m_qtImage = QImage();
+	markNewFrame();
+	m_pWidget->setImage();
+}
+
+/**
+ * @brief 动态设置图像
+ * @remarks 开启自动检测时与上一帧逐块比较，只重新映射、重绘变化的分块
+ *
+ * @param image 待展示的图像
+ */
+void GraphicsViewInterface::setImageDynamically(const QImage& _image)
+{
+	if (filterFrame(_image))
+		return;
+	// 与调用线程自己保存的上一帧比较，比较期间不读取显示线程正在使用的 m_qtImage；
+	// 上一帧之后经其他接口设置过图像时保存的帧已失效，按整帧处理
+	const QImage previous = std::move(m_dirtyReference);
+	m_dirtyReference = m_bAutoDirty ? _image : QImage();
+	if (m_bAutoDirty && m_floatImage.isNull() && !previous.isNull() && previous.cacheKey() == m_qtImage.cacheKey())
+	{
+		const QRegion dirty = changedTiles(previous, _image, m_nDirtyTileSize, m_nDirtyThreshold);
+		m_qtImage = _image;
+		markNewFrame(0, &dirty);
+		return;
+	}
+	m_qtImage = _image;
+	m_floatImage = FloatImage();
+	markNewFrame();
+}
+
+/**
+ * @brief 设置只有部分区域改变的图像
+ * @remarks 尺寸与格式和上一帧相同时只重新映射、重绘 dirty 内的区域，否则按整帧处理；
+ * 静态模式下仍深拷贝整幅图像
+ *
+ * @param image 待展示的图像
+ * @param dirty 相对上一帧变化的区域（图像坐标）
+ */
+void GraphicsViewInterface::setImage(const QImage& _image, const QRegion& _dirty)
+{
+	const qint64 received = DisplayStatistics::now();
+	// 处理后的变化区域无法由输入推知，送入流水线时按整帧处理
+	if (filterPipeline() && filterFrame(isDynamicMode() ? _image : _image.copy(), received))
+		return;
+	const bool partial = m_floatImage.isNull() && !m_qtImage.isNull()
+					  && _image.size() == m_qtImage.size() && _image.format() == m_qtImage.format();
+	const bool dynamic = isDynamicMode();
+	m_qtImage = dynamic ? _image : _image.copy();
+	m_floatImage = FloatImage();
+	markNewFrame(received, partial ? &_dirty : nullptr);
+	if (!dynamic)
+		m_pWidget->setImage();
+}
+
+/**
+ * @brief 设置是否在动态模式下自动检测相邻帧的变化区域
+ * @remarks 比较在调用 setImage 的线程中并行进行，与该线程保存的上一帧比较（多持有一帧），
+ * 适合大部分区域静止的画面
+ *
+ * @param enabled 是否开启
+ * @param tileSize 分块边长
+ * @param threshold 逐通道差值不超过该值的像素视为未改变
+ */
+void GraphicsViewInterface::setAutoDirtyDetection(bool enabled, int tileSize, int threshold)
+{
+	m_nDirtyTileSize = std::max(8, tileSize);
+	m_nDirtyThreshold = std::max(0, threshold);
+	m_bAutoDirty = enabled;
+}
+
+/**
+ * @brief 动态设置浮点图像
+ *
+ * @param image 待展示的浮点图像
+ */
+void GraphicsViewInterface::setImageDynamically(const FloatImage& _image)
+{
+	m_floatImage = _image;
+	m_qtImage = QImage();
+	markNewFrame();
+}
+
+/**
+ * @brief 设置与其他控件共享的图像
+ * @remarks 与 setImageStatically 不同，静态模式下也不深拷贝，
+ * 多个控件显示同一幅图像时只占用一份像素内存，调用方不得再通过原始指针修改其像素
+ *
+ * @param image 待展示的图像
+ */
+void GraphicsViewInterface::setSharedImage(const QImage& _image)
+{
+	if (isDynamicMode())
+	{
+		setImageDynamically(_image);
+		return;
+	}
+	if (filterFrame(_image))
+		return;
+	m_qtImage = _image;
+	m_floatImage = FloatImage();
+	markNewFrame();
+	m_pWidget->setImage();
+}
+
+/**
+ * @brief 设置由外部持有的像素缓冲，不拷贝像素
+ * @remarks owner 的一个副本随图像保存，最后一个引用该缓冲的图像（包括显示数据与录制队列）释放时才释放；
+ * 调用方在此之前不得修改缓冲内容
+ *
+ * @param data 像素数据
+ * @param width 宽度
+ * @param height 高度
+ * @param bytesPerLine 每行字节数
+ * @param format 像素格式
+ * @param owner 缓冲的持有者
+ * @return bool 参数无效时返回 false
+ */
+bool GraphicsViewInterface::setSharedImage(const uchar* data, int width, int height, qsizetype bytesPerLine,
+										   QImage::Format format, std::shared_ptr<const void> owner)
+{
+	if (data == nullptr || owner == nullptr)
+		return false;
+
+	auto* keeper = new std::shared_ptr<const void>(std::move(owner));
+	const QImage image(data, width, height, int(bytesPerLine), format,
+					   [](void* info) { delete static_cast<std::shared_ptr<const void>*>(info); }, keeper);
+	if (image.isNull())
+	{
+		// 构造失败时不会调用释放函数
+		delete keeper;
+		return false;
+	}
+	setSharedImage(image);
+	return true;
+}
+
+/**
+ * @brief 从控件的帧缓冲池取得一幅可写图像
+ * @remarks 填充后以 setImage() 显示；显示、录制与处理流水线都释放该帧后缓冲自动归还，
+ * 尺寸与格式不变时稳定运行不再分配像素内存。复用的缓冲保留旧内容，调用方应写满整幅图像
+ *
+ * @param size 尺寸
+ * @param format 像素格式
+ * @return QImage 参数无效或内存不足时返回空图像
+ */
+QImage GraphicsViewInterface::acquireFrame(const QSize& size, QImage::Format format)
+{
+	return m_framePool.acquire(size, format);
+}
+
+/**
+ * @brief 加载图像
+ * @remarks 未压缩格式（带 .hdr 的 raw、PGM/PPM、BMP）优先以内存映射方式无拷贝加载，
+ * 其余格式通过 QImageReader 解码
+ *
+ * @param path 图像路径
+ * @return QImage 加载失败时返回空图像
+ */
+QImage GraphicsViewInterface::loadImage(const QString& _path)
+{
+	QImage image = loadMappedImage(_path);
+	if (!image.isNull())
+		return image;
+
 	QImageReader reader(_path);
 	reader.setDecideFormatFromContent(true);
-	m_qtImage = reader.read();
-	m_pWidget->setImage();
+	return reader.read();
+}
+
+/**
+ * @brief 设置相机原始帧（Bayer / YUV / Mono8）
+ * @remarks 原始帧在调用线程中以 SIMD 并行转换为 RGB32，转换结果写入帧缓冲池中的缓冲，
+ * 显示、录制与处理流水线释放最后一个副本后归还，稳定运行时不再分配；调用返回后原始帧的数据即可释放
+ *
+ * @param frame 相机原始帧
+ * @return bool 帧参数是否有效
+ */
+bool GraphicsViewInterface::setImage(const RawFrame& _frame)
+{
+	const qint64 received = DisplayStatistics::now();
+	if (_frame.isNull())
+		return false;
+	QImage buffer = m_framePool.acquire(QSize(_frame.width, _frame.height), QImage::Format_RGB32);
+	if (!convertToRgb32(_frame, buffer))
+		return false;
+	if (filterFrame(buffer, received))
+		return true;
+
+	// 转换结果为内部缓冲，无需像 setImageStatically 那样深拷贝
+	m_qtImage = buffer;
+	m_floatImage = FloatImage();
+	markNewFrame(received);
+	if (!isDynamicMode())
+		m_pWidget->setImage();
+	return true;
 }
 
 QPoint GraphicsViewInterface::getIamgePosition(const QPoint& _pos)
 {
     return m_pWidget->mapToScene(_pos).toPoint();
 }
+
+/**
+ * @brief 获取视口中可见的图像区域
+ *
+ * @return QRect 图像坐标系下的可见区域，没有图像时为空
+ */
+QRect GraphicsViewInterface::visibleImageRect() const
+{
+	const QRect bounds = isRegionActive()          ? QRect(QPoint(0, 0), m_pRegionDecoder->imageSize())
+					   : m_floatImage.isNull() ? m_qtImage.rect() : QRect(QPoint(0, 0), m_floatImage.size());
+	const QRect visible = m_pWidget->mapToScene(m_pWidget->viewport()->rect()).boundingRect().toAlignedRect();
+	return visible & bounds;
+}
+
+/**
+ * @brief 将屏幕坐标转换为图像坐标
+ *
+ * @param _global 屏幕坐标
+ * @return QPoint 图像坐标，可能在图像之外
+ */
+QPoint GraphicsViewInterface::mapGlobalToImage(const QPoint& _global) const
+{
+	return m_pWidget->mapToScene(m_pWidget->viewport()->mapFromGlobal(_global)).toPoint();
+}
+
+/* 获取视图的缩放变换 */
+QTransform GraphicsViewInterface::viewTransform() const
+{
+	return m_pWidget->transform();
+}
+
+/* 获取视口中心对应的图像坐标 */
+QPointF GraphicsViewInterface::viewCenter() const
+{
+	return m_pWidget->mapToScene(m_pWidget->viewport()->rect().center());
+}
+
+/**
+ * @brief 设置视图的缩放变换与中心，不发出 viewChanged
+ *
+ * @param transform 缩放变换
+ * @param center 视口中心对应的图像坐标
+ */
+void GraphicsViewInterface::setViewTransform(const QTransform& transform, const QPointF& center)
+{
+	m_pWidget->setTransform(transform);
+	m_pWidget->centerOn(center);
+	refreshCompare();
+}
+
+/**
+ * @brief 设置一帧的叠加图形（检测框、轮廓、标签），可在任意线程调用
+ * @remarks 动态模式下与图像一起在下一次刷新时显示；静态模式下在 GUI 线程中调用时立即显示，
+ * 在其他线程中调用时投递到 GUI 线程显示，连续投递时只显示最新的一帧
+ *
+ * @param _overlay 叠加图形，坐标为图像坐标
+ */
+void GraphicsViewInterface::setOverlay(OverlayFrame _overlay)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_overlayMutex);
+		m_pendingOverlay = std::move(_overlay);
+		m_bOverlayDirty = true;
+	}
+	if (isDynamicMode())
+		return;
+	if (QThread::currentThread() == m_pWidget->thread())
+		m_pWidget->refreshOverlay();
+	else
+		QMetaObject::invokeMethod(m_pWidget, [widget = m_pWidget] { widget->refreshOverlay(); }, Qt::QueuedConnection);
+}
+
+void GraphicsViewInterface::clearOverlay()
+{
+	setOverlay(OverlayFrame());
+}
+
+/**
+ * @brief 叠加层命中测试
+ *
+ * @param _pos 图像坐标
+ * @param tolerance 允许的距离（屏幕像素）
+ * @return OverlayHit 命中的形状
+ */
+OverlayHit GraphicsViewInterface::overlayHitTest(const QPointF& _pos, double tolerance) const
+{
+	const double zoom = m_pWidget->transform().m11();
+	return m_pWidget->overlayItem()->hitTest(_pos, tolerance / (zoom > 0. ? zoom : 1.));
+}
+
+/**
+ * @brief 设置是否在视图左上角显示帧率与延迟统计
+ */
+void GraphicsViewInterface::setHudVisible(bool visible)
+{
+	m_pWidget->setHudVisible(visible);
+}
+
+bool GraphicsViewInterface::isHudVisible() const noexcept
+{
+	return m_pWidget->isHudVisible();
+}
+
+/**
+ * @brief 进入 A/B 比较模式，显示按比较方式合成的图像，只合成视口中可见的分块
+ * @remarks 像素读数以 A 为准；再次调用可更新两幅图像（如 B 为实时帧），clearCompare() 后显示 A
+ *
+ * @param a 图像 A（如基准图像）
+ * @param b 图像 B，尺寸需与 A 相同
+ * @return bool 图像为空或尺寸不同时返回 false
+ */
+bool GraphicsViewInterface::setCompareImages(const QImage& a, const QImage& b)
+{
+	if (!m_comparator.setImages(a, b))
+		return false;
+
+	m_qtImage = a;
+	m_floatImage = FloatImage();
+	markNewFrame();
+	if (!isDynamicMode())
+		m_pWidget->setImage();
+	return true;
+}
+
+void GraphicsViewInterface::setCompareMode(CompareMode mode)
+{
+	m_comparator.setMode(mode);
+	refreshCompare();
+	m_pWidget->viewport()->update();
+}
+
+/**
+ * @brief 设置差值阈值，用于掩膜显示与差异像素统计
+ *
+ * @param threshold 阈值 [0, 255]
+ */
+void GraphicsViewInterface::setCompareThreshold(int threshold)
+{
+	m_comparator.setThreshold(threshold);
+	refreshCompare();
+	m_pWidget->viewport()->update();
+}
+
+/**
+ * @brief 设置分割对比的分割位置
+ *
+ * @param position 相对图像宽度 [0, 1]
+ */
+void GraphicsViewInterface::setSplitPosition(double position)
+{
+	m_comparator.setSplitPosition(position);
+	refreshCompare();
+	m_pWidget->viewport()->update();
+}
+
+/* 退出 A/B 比较模式，显示图像 A */
+void GraphicsViewInterface::clearCompare()
+{
+	if (!isCompareActive())
+		return;
+	m_comparator.clear();
+	markNewFrame();
+	if (!isDynamicMode())
+		m_pWidget->setImage();
+}
+
+/**
+ * @brief 设置显示前的处理流水线，此后 QImage 与相机原始帧先送入流水线，控件只显示流水线的输出
+ * @remarks 处理在流水线的线程池中进行，setImage 只增加引用计数后返回；输出合并为最新一帧，
+ * 在 GUI 线程中显示。浮点图像不经过流水线
+ *
+ * @param pipeline 处理流水线，为空时直接显示，所有权不转移
+ */
+void GraphicsViewInterface::setFilterPipeline(FilterPipeline* pipeline)
+{
+	FilterPipeline* previous = m_pPipeline.exchange(pipeline, std::memory_order_acq_rel);
+	if (previous == pipeline)
+		return;
+	if (previous)
+		previous->setOutputCallback(nullptr);
+	{
+		std::lock_guard<std::mutex> lock(m_filterMutex);
+		m_filteredFrame = FilterFrame();
+		m_bFilteredPending = false;
+	}
+	if (pipeline == nullptr)
+		return;
+
+	pipeline->setOutputCallback([this](const FilterFrame& frame)
+	{
+		bool post = false;
+		{
+			std::lock_guard<std::mutex> lock(m_filterMutex);
+			m_filteredFrame = frame;
+			post = !m_bFilteredPending;
+			m_bFilteredPending = true;
+		}
+		// 尚未显示的输出被新输出覆盖，GUI 线程的事件队列中至多一个待显示事件
+		if (post)
+			QMetaObject::invokeMethod(this, [this] { presentFiltered(); }, Qt::QueuedConnection);
+	});
+}
+
+/**
+ * @brief 设置了处理流水线时把图像连同待用的生产者信息送入流水线
+ *
+ * @return bool 是否已交给流水线
+ */
+bool GraphicsViewInterface::filterFrame(const QImage& _image, qint64 received)
+{
+	FilterPipeline* pipeline = m_pPipeline.load(std::memory_order_acquire);
+	if (pipeline == nullptr || _image.isNull())
+		return false;
+	pipeline->push(_image, m_statistics.takeFrameInfo(), received ? received : DisplayStatistics::now());
+	return true;
+}
+
+/* 在 GUI 线程中显示流水线的最新输出，延迟统计从图像进入 setImage 时算起 */
+void GraphicsViewInterface::presentFiltered()
+{
+	FilterFrame frame;
+	{
+		std::lock_guard<std::mutex> lock(m_filterMutex);
+		frame = std::move(m_filteredFrame);
+		m_filteredFrame = FilterFrame();
+		m_bFilteredPending = false;
+	}
+	if (frame.image.isNull())
+		return;
+
+	m_qtImage = frame.image;
+	m_floatImage = FloatImage();
+	m_statistics.setFrameInfo(frame.info);
+	markNewFrame(frame.received);
+	if (!isDynamicMode())
+		m_pWidget->setImage();
+}
+
+/**
+ * @brief 设置静态模式下生成显示数据后是否保留源图像
+ * @remarks 不保留时，高位深、浮点或伪彩色图像映射为显示数据后释放源图像，以显示数据代替，
+ * 只占用一份像素内存；此后原始值读数不可用（hasRawValues() 为 false，读数为 NaN），
+ * 颜色读数为显示颜色，修改显示窗口或颜色表不再影响该图像
+ *
+ * @param retain 是否保留，默认保留
+ */
+void GraphicsViewInterface::setRetainSource(bool retain)
+{
+	if (retain == m_bRetainSource)
+		return;
+	m_bRetainSource = retain;
+	if (!retain && isStaticMode() && hasImage())
+		m_pWidget->setImage();
+}
+
+/**
+ * @brief 设置是否以区域解码方式打开超大图像
+ * @remarks 开启后 setImageStatically(path) 遇到像素数不少于 threshold、且图像插件支持按区域与缩放解码
+ * 的文件（如 JPEG）时不解码整幅图像，只显示概览图与视口内按当前缩放倍数在后台解码的分块；
+ * 此时 getImage() 为空，像素读数、显示映射与 A/B 比较不可用。关闭时立即退出区域解码
+ *
+ * @param enabled 是否开启
+ * @param threshold 启用区域解码的最小像素数
+ */
+void GraphicsViewInterface::setRegionDecoding(bool enabled, qint64 threshold)
+{
+	m_bRegionDecoding = enabled;
+	m_nRegionThreshold = std::max<qint64>(0, threshold);
+	if (!enabled && m_pRegionDecoder->isOpen())
+	{
+		m_pRegionDecoder->close();
+		m_pWidget->refreshImage();
+	}
+}
+
+/**
+ * @brief 统计本控件持有的像素内存，应在 GUI 线程中调用
+ * @remarks 与其他控件共享的像素数据与多级纹理同样计入。
+ * 源图像与显示数据只在新的一帧、显示数据重新生成或控件更换图像后重新统计，
+ * 多级纹理与缓存是计数值，每次直接读取
+ */
+ViewMemoryReport GraphicsViewInterface::memoryReport() const
+{
+	const ImageItem* item = m_pWidget->imageItem();
+	const qint64 imageKey = item ? item->image().cacheKey() : 0;
+	if (m_bMemoryDirty.exchange(false, std::memory_order_relaxed) || imageKey != m_nMemoryImageKey)
+	{
+		ViewMemoryReport report;
+		std::unordered_set<const uchar*> counted;
+		const auto add = [&counted](const QImage& image, qint64& bytes)
+		{
+			if (!image.isNull() && counted.insert(image.constBits()).second)
+				bytes += image.sizeInBytes();
+		};
+
+		add(m_qtImage, report.sourceBytes);
+		report.sourceBytes += m_floatImage.sizeInBytes();
+		add(m_comparator.imageA(), report.sourceBytes);
+		add(m_comparator.imageB(), report.sourceBytes);
+
+		for (int i = 0; i < m_displayBuffers.count(); ++i)
+			add(m_displayBuffers.at(i), report.displayBytes);
+		for (int i = 0; i < m_colorBuffers.count(); ++i)
+			add(m_colorBuffers.at(i), report.displayBytes);
+		add(m_comparator.image(), report.displayBytes);
+		if (item)
+			add(item->image(), report.displayBytes);
+		m_memoryReport = report;
+		m_nMemoryImageKey = imageKey;
+	}
+
+	ViewMemoryReport report = m_memoryReport;
+	if (item)
+		report.displayBytes += item->cacheBytes();
+	if (m_pImageCache)
+		report.cacheBytes = m_pImageCache->statistics().bytes;
+	report.cacheBytes += m_pRegionDecoder->statistics().bytes;
+	return report;
+}
+
+QString ViewMemoryReport::toString() const
+{
+	constexpr double MB = 1024. * 1024.;
+	return QString("memory source %1  display %2  cache %3  total %4 MB")
+		.arg(sourceBytes / MB, 0, 'f', 1).arg(displayBytes / MB, 0, 'f', 1)
+		.arg(cacheBytes / MB, 0, 'f', 1).arg(total() / MB, 0, 'f', 1);
+}
+
+/* 合成可见区域内失效的分块，并登记为待重绘区域 */
+const QImage& GraphicsViewInterface::compareImage()
+{
+	const QRegion region = m_comparator.update(visibleImageRect());
+	if (!region.isEmpty())
+	{
+		std::lock_guard<std::mutex> lock(m_dirtyMutex);
+		if (!m_bViewFull)
+			m_viewRegion += region;
+	}
+	return m_comparator.image();
+}
+
+/* 静态模式下视图或比较参数改变后立即合成新露出或失效的分块，动态模式由刷新计时器完成 */
+void GraphicsViewInterface::refreshCompare()
+{
+	if (isCompareActive() && !isDynamicMode())
+		m_pWidget->refreshImage();
+}
+
+/* 取出待显示的叠加层，没有新的叠加层时返回 false */
+bool GraphicsViewInterface::takeOverlay(OverlayFrame& _overlay)
+{
+	std::lock_guard<std::mutex> lock(m_overlayMutex);
+	if (!m_bOverlayDirty)
+		return false;
+	_overlay = std::move(m_pendingOverlay);
+	m_pendingOverlay = OverlayFrame();
+	m_bOverlayDirty = false;
+	return true;
+}
+
+/**
+ * @brief 设置高位深图像的显示窗口，并关闭自动窗口
+ * @remarks 只重新计算显示映射，原始图像保持不变
+ *
+ * @param window 显示窗口
+ */
+void GraphicsViewInterface::setDisplayWindow(const DisplayWindow& window)
+{
+	m_displayWindow = window;
+	m_bAutoWindow = false;
+	invalidateDisplay();
+	if (isHighBitDepth())
+		m_pWidget->refreshImage();
+}
+
+/**
+ * @brief 设置高位深图像的显示窗口
+ *
+ * @param low 映射为黑色的原始值
+ * @param high 映射为白色的原始值
+ */
+void GraphicsViewInterface::setDisplayWindow(double low, double high)
+{
+	setDisplayWindow(DisplayWindow{ low, high, m_displayWindow.gamma });
+}
+
+/**
+ * @brief 以窗宽窗位设置高位深图像的显示窗口
+ *
+ * @param window 窗宽
+ * @param level 窗位
+ */
+void GraphicsViewInterface::setWindowLevel(double window, double level)
+{
+	setDisplayWindow(DisplayWindow::fromWindowLevel(window, level, m_displayWindow.gamma));
+}
+
+void GraphicsViewInterface::setGamma(double gamma)
+{
+	if (gamma <= 0.)
+		return;
+	m_displayWindow.gamma = gamma;
+	invalidateDisplay();
+	if (isHighBitDepth())
+		m_pWidget->refreshImage();
+}
+
+/**
+ * @brief 设置是否根据每帧图像的取值范围自动设置显示窗口
+ */
+void GraphicsViewInterface::setAutoWindow(bool enabled)
+{
+	m_bAutoWindow = enabled;
+	invalidateDisplay();
+	if (enabled && isHighBitDepth())
+		m_pWidget->refreshImage();
+}
+
+/**
+ * @brief 设置单通道图像（Grayscale8、Grayscale16、浮点）的伪彩色颜色表
+ * @remarks 查表结果缓存到图像或颜色表改变为止；像素读数仍为原始值。
+ * 65536 项颜色表对 Grayscale16 图像按原始值直接查表，不经过显示窗口
+ *
+ * @param colormap 颜色表，为空时恢复灰度显示
+ */
+void GraphicsViewInterface::setColormap(const Colormap& colormap)
+{
+	if (colormap.cacheKey() == m_colormap.cacheKey())
+		return;
+	// 切换 65536 项颜色表时显示映射被跳过或重新需要，整幅重新映射
+	const bool remap = colormap.isWide() != m_colormap.isWide();
+	m_colormap = colormap;
+	if (m_colormap.isNull())
+		m_colorBuffers.clear();
+	{
+		std::lock_guard<std::mutex> lock(m_dirtyMutex);
+		m_bMapFull = m_bMapFull || remap;
+		m_bColorFull = true;
+		m_bViewFull = true;
+	}
+	m_bDisplayDirty.store(true, std::memory_order_release);
+	if (!isDynamicMode() && hasImage())
+		m_pWidget->refreshImage();
+}
+
+/**
+ * @brief 获取当前像素点的原始值
+ * @remarks 高位深图像返回映射前的原始值，其他图像返回灰度值
+ *
+ * @return double 当前像素点不在图像内或源图像已释放时返回 NaN
+ */
+double GraphicsViewInterface::getPositionValue() const noexcept
+{
+	if (!hasRawValues())
+		return qQNaN();
+	double value;
+	sampleRow(m_qtImage, m_floatImage, m_Position.y(), m_Position.x(), 1, &value);
+	return value;
+}
+
+/**
+ * @brief 获取当前像素点的颜色
+ * @remarks 常用格式直接读取扫描行，不经过 QImage::pixelColor 的逐像素格式转换
+ *
+ * @param rgb 输出颜色
+ * @return bool 当前像素点是否在图像内
+ */
+bool GraphicsViewInterface::getPositionRgb(QRgb& rgb) const noexcept
+{
+	// 浮点图像没有对应的 QImage，使用其显示映射
+	const QImage& image = m_floatImage.isNull() ? m_qtImage : m_displayBuffers.current();
+	const int x = m_Position.x();
+	const int y = m_Position.y();
+	if (image.isNull() || !image.valid(x, y))
+		return false;
+
+	const uchar* row = image.constScanLine(y);
+	switch (image.format())
+	{
+	case QImage::Format_RGB32:
+	case QImage::Format_ARGB32:
+		rgb = reinterpret_cast<const QRgb*>(row)[x];
+		break;
+	case QImage::Format_ARGB32_Premultiplied:
+		rgb = qUnpremultiply(reinterpret_cast<const QRgb*>(row)[x]);
+		break;
+	case QImage::Format_Grayscale8:
+		rgb = qRgb(row[x], row[x], row[x]);
+		break;
+	default:
+		rgb = image.pixel(x, y);
+		break;
+	}
+	return true;
+}
+
+/**
+ * @brief 一次读取当前像素点 size x size 邻域的原始值
+ * @remarks 取值规则与 getPositionValue 相同
+ *
+ * @param size 邻域边长，偶数时按 size + 1 处理
+ * @param values 按行输出的原始值，图像外的点为 NaN
+ * @return int 实际的邻域边长
+ */
+int GraphicsViewInterface::getNeighborhoodValues(int size, QVector<double>& values) const
+{
+	const int half = qMax(size, 1) / 2;
+	size = 2 * half + 1;
+	getRegionValues(QRect(m_Position.x() - half, m_Position.y() - half, size, size), values);
+	return size;
+}
+
+/**
+ * @brief 读取矩形区域内的原始值，每行只取一次扫描行指针
+ *
+ * @param rect 图像坐标系下的区域
+ * @param values 按行输出的原始值，图像外的点或源图像已释放时为 NaN
+ */
+void GraphicsViewInterface::getRegionValues(const QRect& rect, QVector<double>& values) const
+{
+	values.resize(rect.width() * rect.height());
+	if (!hasRawValues())
+	{
+		values.fill(qQNaN());
+		return;
+	}
+	for (int i = 0; i < rect.height(); ++i)
+		sampleRow(m_qtImage, m_floatImage, rect.top() + i, rect.left(), rect.width(), values.data() + i * rect.width());
+}
+
+/**
+ * @brief 设置放大到 ImageItem::GridZoom 倍以上时是否显示像素网格
+ */
+void GraphicsViewInterface::setPixelGridVisible(bool visible)
+{
+	m_pWidget->imageItem()->setPixelGridVisible(visible);
+}
+
+/**
+ * @brief 设置放大到 ImageItem::TextZoom 倍以上时是否显示像素原始值
+ */
+void GraphicsViewInterface::setPixelValuesVisible(bool visible)
+{
+	m_pWidget->imageItem()->setPixelValuesVisible(visible, this);
+}
+
+/**
+ * @brief 新的一帧：显示映射需要重新计算，帧序号加一
+ *
+ * @param received 到达时间，为 0 时以当前时间为到达时间
+ * @param dirty 相对上一帧变化的区域，为空指针时整帧改变
+ */
+void GraphicsViewInterface::markNewFrame(qint64 received, const QRegion* dirty)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_dirtyMutex);
+		if (dirty == nullptr)
+		{
+			m_bMapFull = m_bViewFull = true;
+			m_mapRegion = m_viewRegion = QRegion();
+		}
+		else
+		{
+			if (!m_bMapFull)
+				m_mapRegion += *dirty;
+			if (!m_bViewFull)
+				m_viewRegion += *dirty;
+		}
+	}
+	m_bDisplayDirty.store(true, std::memory_order_release);
+	m_bSourceReleased.store(false, std::memory_order_relaxed);
+	m_bMemoryDirty.store(true, std::memory_order_relaxed);
+	const quint64 frameNumber = m_nFrameNumber.fetch_add(1, std::memory_order_acq_rel) + 1;
+	const qint64 now = DisplayStatistics::now();
+	m_statistics.frameReceived(frameNumber, received ? received : now, now);
+	if (FrameRecorder* recorder = m_pRecorder.load(std::memory_order_acquire))
+		recorder->push(m_qtImage, frameNumber, received ? received : now);
+}
+
+/* 显示窗口改变：整幅图像重新映射并重绘 */
+void GraphicsViewInterface::invalidateDisplay()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_dirtyMutex);
+		m_bMapFull = m_bViewFull = true;
+		m_mapRegion = m_viewRegion = QRegion();
+	}
+	m_bDisplayDirty.store(true, std::memory_order_release);
+}
+
+/**
+ * @brief 取出待重绘的区域
+ *
+ * @param region 待重绘的区域
+ * @return bool 是否需要重绘整幅图像
+ */
+bool GraphicsViewInterface::takeViewRegion(QRegion& _region)
+{
+	std::lock_guard<std::mutex> lock(m_dirtyMutex);
+	const bool full = m_bViewFull;
+	_region = QRegion();
+	_region.swap(m_viewRegion);
+	m_bViewFull = false;
+	return full;
+}
+
+/**
+ * @brief 获取用于绘制的图像
+ * @remarks 高位深图像按显示窗口并行映射为 8 位图像并缓存，
+ * 只有图像或显示窗口改变后才重新计算，固定窗口时只映射变化区域，其他图像直接返回原图；
+ * 设置了颜色表的单通道图像再经查表得到伪彩色图像，更换颜色表时只重新查表；
+ * A/B 比较模式下返回比较合成的图像
+ *
+ * @return const QImage& 用于绘制的图像
+ */
+const QImage& GraphicsViewInterface::displayImage()
+{
+	if (isCompareActive())
+		return compareImage();
+	const bool colored = isColormapActive();
+	if (!isHighBitDepth() && !colored)
+		return m_qtImage;
+
+	if (m_bDisplayDirty.exchange(false, std::memory_order_acq_rel))
+	{
+		// 65536 项颜色表按 Grayscale16 原始值直接查表，不经过显示窗口映射
+		const bool direct = colored && m_colormap.isWide() && m_floatImage.isNull() && ::isHighBitDepth(m_qtImage);
+		const bool mapped = isHighBitDepth() && !direct;
+		if (mapped && m_bAutoWindow)
+		{
+			float fmin = 0.f, fmax = 0.f;
+			double min = 0., max = 0.;
+			if (!m_floatImage.isNull() && m_floatImage.minMax(fmin, fmax))
+			{
+				m_displayWindow.low = fmin;
+				m_displayWindow.high = fmax;
+			}
+			else if (m_floatImage.isNull() && imageRange(m_qtImage, min, max))
+			{
+				m_displayWindow.low = min;
+				m_displayWindow.high = max;
+			}
+		}
+
+		// 自动窗口每帧都可能改变映射，只有固定窗口时才能只映射变化区域；
+		// 只更换颜色表时不重新映射，只重新查表
+		QRegion region;
+		bool full = mapped && m_bAutoWindow;
+		bool colorFull = false;
+		{
+			std::lock_guard<std::mutex> lock(m_dirtyMutex);
+			full = full || m_bMapFull;
+			colorFull = full || m_bColorFull;
+			region.swap(m_mapRegion);
+			m_bMapFull = false;
+			m_bColorFull = false;
+		}
+
+		// 控件持有上一次的显示数据，写入轮换缓冲中未被共享的一个，避免原地写入时深拷贝整幅图像
+		if (mapped && (full || !region.isEmpty()))
+		{
+			const QSize size = m_floatImage.isNull() ? m_qtImage.size() : m_floatImage.size();
+			QRegion area = full ? QRegion() : region;
+			QImage& display = m_displayBuffers.acquire(size, QImage::Format_Grayscale8, area);
+			const bool whole = area == QRegion(QRect(QPoint(0, 0), size));
+			if (whole && !m_floatImage.isNull())
+				mapToDisplay(m_floatImage, m_displayWindow, display);
+			else if (whole)
+				mapToDisplay(m_qtImage, m_displayWindow, display);
+			else if (!m_floatImage.isNull())
+				mapToDisplay(m_floatImage, m_displayWindow, display, area);
+			else
+				mapToDisplay(m_qtImage, m_displayWindow, display, area);
+		}
+		if (colored && (colorFull || !region.isEmpty()))
+		{
+			const QImage& input = mapped ? m_displayBuffers.current() : m_qtImage;
+			QRegion area = colorFull ? QRegion() : region;
+			QImage& color = m_colorBuffers.acquire(input.size(), QImage::Format_RGB32, area);
+			applyColormap(input, m_colormap, color, area);
+		}
+
+		// 映射期间到达的帧可能已被控件取走其区域，重新登记已映射的区域
+		{
+			std::lock_guard<std::mutex> lock(m_dirtyMutex);
+			if (colored ? colorFull : full)
+				m_bViewFull = true;
+			else
+				m_viewRegion += region;
+		}
+		m_statistics.frameConverted(frameNumber(), DisplayStatistics::now());
+		m_bMemoryDirty.store(true, std::memory_order_relaxed);
+	}
+	BufferRing& result = colored ? m_colorBuffers : m_displayBuffers;
+	// 不保留源图像时以显示数据代替源图像，此后按 8 位或 RGB32 图像直接显示
+	if (!m_bRetainSource && isStaticMode() && !isCompareActive() && !result.current().isNull())
+	{
+		m_qtImage = result.take();
+		m_floatImage = FloatImage();
+		m_displayBuffers.clear();
+		m_colorBuffers.clear();
+		m_bSourceReleased.store(true, std::memory_order_relaxed);
+		m_bMemoryDirty.store(true, std::memory_order_relaxed);
+		return m_qtImage;
+	}
+	// 静态显示不连续写入，只保留控件正在显示的一份
+	if (isStaticMode())
+	{
+		if (m_displayBuffers.count() > 1 || m_colorBuffers.count() > 1)
+			m_bMemoryDirty.store(true, std::memory_order_relaxed);
+		m_displayBuffers.releaseSpare();
+		m_colorBuffers.releaseSpare();
+	}
+	return result.current();
+}
@@ -9,12 +9,15 @@
  * 
  */
 
+#include <QPainter>
 #include <QWidget>
-#include <QGraphicsPixmapItem>
 #include <qevent.h>
 
 #include "graphicsview.hpp"
 #include "graphicsviewinterface.hpp"
+#include "imageitem.hpp"
+#include "overlayitem.hpp"
+#include "regionitem.hpp"
 
 GraphicsView::GraphicsView
 (
@@ -25,20 +28,26 @@ GraphicsView::GraphicsView
 )
     : QGraphicsView(parent)
     , m_bIsTranslate(false)
+    , m_bDraggingSplit(false)
+    , m_bHudVisible(false)
     , m_pScene(new QGraphicsScene())
-    , m_pImageItem(new QGraphicsPixmapItem())
+    , m_pImageItem(new ImageItem())
+    , m_pOverlayItem(new OverlayItem())
+    , m_pRegionItem(new RegionItem())
     , m_pTimer(new QTimer(this))
     , m_pController(controller)
     , m_dMinZoom(minZoom)
     , m_dMaxZoom(maxZoom)
 {
     m_pScene->addItem(m_pImageItem);
+    m_pScene->addItem(m_pRegionItem);
+    m_pScene->addItem(m_pOverlayItem);
+    m_pRegionItem->hide();
     setScene(m_pScene);
     // 隐藏滚动条
     setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    // 抗锯齿
-    setRenderHint(QPainter::Antialiasing);
+    // 不设置全局抗锯齿，图像的插值方式由 ImageItem 按缩放倍数决定，其他控件按需设置
     // 设置 scene 的位置和大小
     setSceneRect(INT_MIN / 2, INT_MIN / 2, INT_MAX, INT_MAX);
     // 设置 scene 在 view 的中心点作为锚点
@@ -54,23 +63,31 @@ GraphicsView::~GraphicsView()
 {
     m_pTimer->deleteLater();
     m_pScene->deleteLater();
+    delete m_pOverlayItem;
+    delete m_pRegionItem;
     delete m_pImageItem;
 }
 
 /* @brief 显示图像 */
 void GraphicsView::setImage()
 {
+    refreshOverlay();
     // 若没有图像则返回
-    if (m_pController->m_qtImage.isNull())
+    if (!m_pController->hasImage())
         return;
         
     try
     {
+        // 先取帧序号，取图像期间到达的新帧计入下一次刷新
+        const quint64 frameNumber = m_pController->frameNumber();
         // 设置显示图像
-        m_pImageItem->setPixmap(QPixmap::fromImage(m_pController->m_qtImage));
+        refreshImage();
+        m_pController->m_statistics.frameScheduled(frameNumber);
         // 设置中心坐标
-        QPoint newCenter(m_pController->m_qtImage.width() / 2,
-                        m_pController->m_qtImage.height() / 2);
+        const QSize size = m_pController->isRegionActive() ? m_pController->regionDecoder()->imageSize()
+                                                            : m_pController->displayImage().size();
+        QPoint newCenter(size.width() / 2,
+                        size.height() / 2);
         centerOn(newCenter);
         show();
         update();
@@ -81,24 +98,172 @@ void GraphicsView::setImage()
     }
 }
 
+/* @brief 刷新显示内容，不改变视图位置，只有部分区域改变时只重绘这些区域 */
+void GraphicsView::refreshImage()
+{
+    // 区域解码的图像由 RegionItem 按视口绘制，ImageItem 释放之前的图像
+    if (m_pController->isRegionActive())
+    {
+        QRegion region;
+        m_pController->takeViewRegion(region);
+        m_pImageItem->setImage(QImage());
+        m_pRegionItem->setDecoder(m_pController->regionDecoder());
+        m_pRegionItem->show();
+        return;
+    }
+    if (m_pRegionItem->isVisible())
+    {
+        m_pRegionItem->hide();
+        m_pRegionItem->setDecoder(nullptr);
+        m_pController->regionDecoder()->close();
+    }
+
+    const QImage& image = m_pController->displayImage();
+    if (image.isNull())
+        return;
+    QRegion region;
+    if (m_pController->takeViewRegion(region))
+        m_pImageItem->setImage(image);
+    else
+        m_pImageItem->setImage(image, region);
+}
+
+/* @brief 显示新的叠加层 */
+void GraphicsView::refreshOverlay()
+{
+    OverlayFrame overlay;
+    if (m_pController->takeOverlay(overlay))
+        m_pOverlayItem->setFrame(std::move(overlay));
+}
+
+void GraphicsView::paintEvent(QPaintEvent* event)
+{
+    QGraphicsView::paintEvent(event);
+    m_pController->m_statistics.framePresented(DisplayStatistics::now());
+}
+
+/* 在视口坐标系下绘制统计信息 */
+void GraphicsView::drawForeground(QPainter* painter, const QRectF& rect)
+{
+    Q_UNUSED(rect);
+    if (isSplitVisible())
+        drawSplitLine(painter);
+    if (!m_bHudVisible)
+        return;
+
+    QString text = m_pController->displayStatistics().toString();
+    if (m_pController->isCompareActive())
+    {
+        const CompareStatistics stats = m_pController->compareStatistics();
+        text += QString("\nDiff: max %1  mean %2  rmse %3  differing %4%")
+                    .arg(stats.maxDiff)
+                    .arg(stats.meanDiff, 0, 'f', 2)
+                    .arg(stats.rmse, 0, 'f', 2)
+                    .arg(stats.differingRatio() * 100., 0, 'f', 3);
+    }
+    if (FilterPipeline* pipeline = m_pController->filterPipeline())
+        text += "\n" + pipeline->statistics().toString();
+    if (m_pController->isRegionActive())
+    {
+        const RegionDecoderStatistics stats = m_pController->regionDecoder()->statistics();
+        text += QString("\nRegion: tiles %1  decoded %2  skipped %3  mean %4 ms")
+                    .arg(stats.tiles)
+                    .arg(stats.decoded)
+                    .arg(stats.skipped)
+                    .arg(stats.decoded ? stats.decodeNs / 1e6 / double(stats.decoded) : 0., 0, 'f', 1);
+    }
+    const FramePoolStatistics pool = m_pController->framePool().statistics();
+    if (pool.acquired != 0)
+    {
+        text += QString("\nPool: in use %1 (peak %2)  idle %3  allocated %4  reuse %5%  %6 MB")
+                    .arg(pool.inUse)
+                    .arg(pool.peakInUse)
+                    .arg(pool.idle)
+                    .arg(pool.allocated)
+                    .arg(pool.reuseRatio() * 100., 0, 'f', 1)
+                    .arg(pool.bytes / (1024. * 1024.), 0, 'f', 1);
+    }
+    text += "\n" + m_pController->memoryReport().toString();
+    painter->save();
+    painter->resetTransform();
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    const QRect bounds = painter->fontMetrics().boundingRect(QRect(8, 8, viewport()->width(), viewport()->height()),
+                                                             Qt::AlignLeft | Qt::AlignTop, text);
+    painter->fillRect(bounds.adjusted(-4, -4, 4, 4), QColor(0, 0, 0, 160));
+    painter->setPen(Qt::white);
+    painter->drawText(bounds, Qt::AlignLeft | Qt::AlignTop, text);
+    painter->restore();
+}
+
+/* 是否显示 A/B 分割线 */
+bool GraphicsView::isSplitVisible() const
+{
+    return m_pController->isCompareActive() && m_pController->compareMode() == CompareMode::Split;
+}
+
+/* 分割线在视口中的横坐标 */
+int GraphicsView::splitViewX() const
+{
+    const double x = m_pController->splitPosition() * m_pController->getImage().width();
+    return mapFromScene(QPointF(x, 0.)).x();
+}
+
+/* 在视口坐标系下绘制分割线与两侧的标签 */
+void GraphicsView::drawSplitLine(QPainter* painter)
+{
+    const int x = splitViewX();
+    const int h = viewport()->height();
+    painter->save();
+    painter->resetTransform();
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    painter->setPen(QPen(QColor(255, 255, 255, 220), 1));
+    painter->drawLine(x, 0, x, h);
+    painter->setPen(QPen(QColor(0, 0, 0, 160), 1));
+    painter->drawLine(x + 1, 0, x + 1, h);
+
+    const QFontMetrics metrics = painter->fontMetrics();
+    const QRect labelA = metrics.boundingRect("A").adjusted(-4, -2, 4, 2);
+    const QRect labelB = metrics.boundingRect("B").adjusted(-4, -2, 4, 2);
+    const QRect rectA(QPoint(x - labelA.width() - 6, h - labelA.height() - 8), labelA.size());
+    const QRect rectB(QPoint(x + 6, h - labelB.height() - 8), labelB.size());
+    painter->fillRect(rectA, QColor(0, 0, 0, 160));
+    painter->fillRect(rectB, QColor(0, 0, 0, 160));
+    painter->setPen(Qt::white);
+    painter->drawText(rectA, Qt::AlignCenter, "A");
+    painter->drawText(rectB, Qt::AlignCenter, "B");
+    painter->restore();
+}
+
 void GraphicsView::mousePressEvent(QMouseEvent* event)
 {
     // 若没有图像则不执行鼠标事件
-    if (m_pController->m_qtImage.isNull())
+    if (!m_pController->hasImage())
         return;
 
+    if (event->button() == Qt::LeftButton && isSplitVisible() && qAbs(event->pos().x() - splitViewX()) <= SplitGrip)
+    {
+        m_bDraggingSplit = true;
+        return;
+    }
+
     if (event->button() == Qt::RightButton)
     {
         // 触发图像仿射变换信号
         m_bIsTranslate = true;
         m_qtLastMousePos = event->pos();
     }
+    else if (event->button() == Qt::LeftButton && m_pOverlayItem->frame().shapeCount() > 0)
+    {
+        const OverlayHit hit = m_pController->overlayHitTest(mapToScene(event->pos()));
+        if (hit.isValid())
+            emit m_pController->overlayClicked(hit);
+    }
 }
 
 void GraphicsView::mouseMoveEvent(QMouseEvent* event)
 {
     // 若没有图像则不执行鼠标事件
-    if (m_pController->m_qtImage.isNull())
+    if (!m_pController->hasImage())
         return;
 
     if (m_bIsTranslate)
@@ -106,6 +271,13 @@ void GraphicsView::mouseMoveEvent(QMouseEvent* event)
         QPointF mouseDelta = event->pos() - m_qtLastMousePos;
         Translate(mouseDelta);
     }
+    if (m_bDraggingSplit && m_pController->getImage().width() > 0)
+        m_pController->setSplitPosition(mapToScene(event->pos()).x() / m_pController->getImage().width());
+    if (isSplitVisible())
+    {
+        const bool grip = m_bDraggingSplit || qAbs(event->pos().x() - splitViewX()) <= SplitGrip;
+        viewport()->setCursor(grip ? Qt::SplitHCursor : Qt::ArrowCursor);
+    }
     m_qtLastMousePos = event->pos();
     m_pController->setPosition(mapToScene(m_qtLastMousePos).toPoint());
     emit m_pController->mouseMoveEvent();
@@ -114,17 +286,19 @@ void GraphicsView::mouseMoveEvent(QMouseEvent* event)
 void GraphicsView::mouseReleaseEvent(QMouseEvent* event)
 {
     // 若没有图像则不执行鼠标事件
-    if (m_pController->m_qtImage.isNull())
+    if (!m_pController->hasImage())
         return;
 
     if (event->button() == Qt::RightButton)
         m_bIsTranslate = false;
+    else if (event->button() == Qt::LeftButton)
+        m_bDraggingSplit = false;
 }
 
 void GraphicsView::wheelEvent(QWheelEvent* event)
 {
     // 若没有图像则不执行鼠标事件
-    if (m_pController->m_qtImage.isNull())
+    if (!m_pController->hasImage())
         return;
     // 滚轮的滚动量
     QPoint scrollAmount = event->angleDelta();
@@ -139,6 +313,7 @@ void GraphicsView::Zoom(double scaleFactor)
     if (factor < m_dMinZoom || factor > m_dMaxZoom)
         return;
     scale(scaleFactor, scaleFactor);
+    emit m_pController->viewChanged();
 }
 
 void GraphicsView::Translate(QPointF delta)
@@ -147,4 +322,5 @@ void GraphicsView::Translate(QPointF delta)
     int h = viewport()->height();
     QPoint newCenter(w / 2. - delta.x() + 0.5, h / 2. - delta.y() + 0.5);
     centerOn(mapToScene(newCenter));
+    emit m_pController->viewChanged();
 }
\ No newline at end of file
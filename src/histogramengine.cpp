@@ -0,0 +1,276 @@
+/**
+ * @file histogramengine.cpp
+ * @author ldk
+ * @brief 图像直方图的并行计算与限频更新
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <mutex>
+
+#include <QTimer>
+
+#include "histogramengine.hpp"
+#include "displaymapping.hpp"
+#include "graphicsviewinterface.hpp"
+#include "parallel.hpp"
+
+namespace
+{
+
+constexpr int ROW_GRAIN{ 32 };  // 并行时每段的最小行数
+
+enum class HistogramFormat
+{
+    Gray8,
+    Gray16,
+    Rgb32
+};
+
+/* 局部直方图：灰度图像使用四份副本，彩色图像每通道一份 */
+using LocalHistogram = std::array<Histogram::Channel, 4>;
+
+/**
+ * @brief Grayscale16 的分级：(value - offset) * scale >> 16
+ * @remarks 10/12 位相机数据只占 16 位的低端，按高 8 位分级只剩十几级，因此在实际取值范围内分级
+ */
+struct Gray16Bins
+{
+    quint32 offset = 0;
+    quint32 scale = 1u << 8;    // 等价于右移 8 位
+
+    Gray16Bins() = default;
+    Gray16Bins(quint32 low, quint32 high)
+        : offset(low)
+        , scale((quint32(Histogram::Bins) << 16) / (high - low + 1))
+    {}
+
+    /* value 需在 [low, high] 内，乘积小于 2^24 */
+    inline int operator()(quint16 value) const noexcept { return int(((value - offset) * scale) >> 16); }
+};
+
+/**
+ * @brief 统计一行
+ * @remarks 直方图的散列自增无法向量化，灰度图像将相邻像素分散到四份副本中计数，
+ * 避免连续相同的值在同一计数器上形成写后读依赖
+ */
+void countRow(const uchar* row, int first, int last, HistogramFormat format, const Gray16Bins& bins,
+              LocalHistogram& local)
+{
+    int x = first;
+    switch (format)
+    {
+    case HistogramFormat::Gray8:
+        for (; x + 4 <= last; x += 4)
+        {
+            ++local[0][row[x]];
+            ++local[1][row[x + 1]];
+            ++local[2][row[x + 2]];
+            ++local[3][row[x + 3]];
+        }
+        for (; x < last; ++x)
+            ++local[0][row[x]];
+        break;
+    case HistogramFormat::Gray16:
+    {
+        const quint16* pixels = reinterpret_cast<const quint16*>(row);
+        for (; x + 4 <= last; x += 4)
+        {
+            ++local[0][bins(pixels[x])];
+            ++local[1][bins(pixels[x + 1])];
+            ++local[2][bins(pixels[x + 2])];
+            ++local[3][bins(pixels[x + 3])];
+        }
+        for (; x < last; ++x)
+            ++local[0][bins(pixels[x])];
+        break;
+    }
+    case HistogramFormat::Rgb32:
+    {
+        const QRgb* pixels = reinterpret_cast<const QRgb*>(row);
+        for (; x < last; ++x)
+        {
+            ++local[0][qRed(pixels[x])];
+            ++local[1][qGreen(pixels[x])];
+            ++local[2][qBlue(pixels[x])];
+        }
+        break;
+    }
+    }
+}
+
+} // namespace
+
+Histogram computeHistogram(const QImage& image, const QRect& region)
+{
+    Histogram histogram;
+    QRect area = region.isNull() ? image.rect() : (region & image.rect());
+    if (image.isNull() || area.isEmpty())
+        return histogram;
+    histogram.region = area;
+
+    QImage source = image;
+    HistogramFormat format = HistogramFormat::Rgb32;
+    switch (image.format())
+    {
+    case QImage::Format_Grayscale8:
+        format = HistogramFormat::Gray8;
+        break;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+    case QImage::Format_Grayscale16:
+        format = HistogramFormat::Gray16;
+        break;
+#endif
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        break;
+    default:
+        // 其他格式只转换统计区域
+        source = image.copy(area).convertToFormat(QImage::Format_RGB32);
+        area = source.rect();
+        break;
+    }
+    histogram.channelCount = format == HistogramFormat::Rgb32 ? 3 : 1;
+
+    // 统计区域之外的取值也计入范围，使视口移动时分级保持不变
+    Gray16Bins bins;
+    if (format == HistogramFormat::Gray16)
+    {
+        double low = 0., high = 65535.;
+        imageRange(image, low, high);
+        bins = Gray16Bins(quint32(low), quint32(high));
+        histogram.minimum = low;
+        histogram.maximum = high;
+    }
+
+    std::mutex mutex;
+    const uchar* bits = source.constBits();
+    const qsizetype bytesPerLine = source.bytesPerLine();
+    const int left = area.left();
+    const int right = area.right() + 1;
+
+    parallelFor(area.top(), area.bottom() + 1, [&](int first, int last)
+    {
+        LocalHistogram local{};
+        for (int y = first; y < last; ++y)
+            countRow(bits + y * bytesPerLine, left, right, format, bins, local);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int bin = 0; bin < Histogram::Bins; ++bin)
+        {
+            if (format == HistogramFormat::Rgb32)
+            {
+                histogram.counts[0][bin] += local[0][bin];
+                histogram.counts[1][bin] += local[1][bin];
+                histogram.counts[2][bin] += local[2][bin];
+            }
+            else
+            {
+                histogram.counts[0][bin] += local[0][bin] + local[1][bin] + local[2][bin] + local[3][bin];
+            }
+        }
+    }, ROW_GRAIN);
+
+    return histogram;
+}
+
+HistogramEngine::HistogramEngine(GraphicsViewInterface* source, QObject* parent, int interval)
+    : QObject(parent)
+    , m_pSource(source)
+    , m_pTimer(new QTimer(this))
+    , m_Region(Region::Frame)
+    , m_nFrameNumber(0)
+    , m_bEnabled(false)
+    , m_bBusy(false)
+    , m_bPending(false)
+{
+    m_pool.setMaxThreadCount(1);
+    m_pTimer->setInterval(interval);
+    connect(m_pTimer, &QTimer::timeout, this, &HistogramEngine::poll);
+}
+
+HistogramEngine::~HistogramEngine()
+{
+    m_pTimer->stop();
+    m_pool.waitForDone();
+}
+
+void HistogramEngine::setEnabled(bool enabled)
+{
+    m_bEnabled = enabled;
+    if (enabled)
+    {
+        m_pTimer->start();
+        poll();
+    }
+    else
+    {
+        m_pTimer->stop();
+    }
+}
+
+void HistogramEngine::setRegion(Region region)
+{
+    m_Region = region;
+    poll();
+}
+
+/**
+ * @brief 设置更新间隔，一般与显示刷新间隔一致
+ *
+ * @param interval 间隔（毫秒）
+ */
+void HistogramEngine::setUpdateInterval(int interval)
+{
+    m_pTimer->setInterval(interval);
+}
+
+/* 帧序号或统计区域改变时才重新计算 */
+void HistogramEngine::poll()
+{
+    if (!m_bEnabled || m_pSource == nullptr || !m_pSource->hasImage())
+        return;
+
+    const quint64 frameNumber = m_pSource->frameNumber();
+    const QRect region = m_Region == Region::Viewport ? m_pSource->visibleImageRect() : QRect();
+    if (!m_Histogram.isNull() && frameNumber == m_nFrameNumber && region == m_LastRegion)
+        return;
+    if (m_bBusy)
+    {
+        m_bPending = true;
+        return;
+    }
+
+    m_nFrameNumber = frameNumber;
+    m_LastRegion = region;
+    // 浮点图像没有对应的 QImage，统计其显示映射
+    const QImage image = m_pSource->getFloatImage().isNull() ? m_pSource->getImage() : m_pSource->displayImage();
+    start(image, region, frameNumber);
+}
+
+void HistogramEngine::start(const QImage& image, const QRect& region, quint64 frameNumber)
+{
+    m_bBusy = true;
+    runAsync(&m_pool, [this, image, region, frameNumber]
+    {
+        Histogram histogram = computeHistogram(image, region);
+        histogram.frameNumber = frameNumber;
+        QMetaObject::invokeMethod(this, [this, histogram] { finish(histogram); }, Qt::QueuedConnection);
+    });
+}
+
+void HistogramEngine::finish(const Histogram& histogram)
+{
+    m_bBusy = false;
+    m_Histogram = histogram;
+    emit histogramReady(m_Histogram);
+    if (m_bPending)
+    {
+        m_bPending = false;
+        poll();
+    }
+}
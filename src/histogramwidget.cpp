@@ -0,0 +1,78 @@
+/**
+ * @file histogramwidget.cpp
+ * @author ldk
+ * @brief 直方图显示控件
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <QPainter>
+#include <QPolygonF>
+
+#include "histogramwidget.hpp"
+
+HistogramWidget::HistogramWidget(QWidget* parent)
+    : QWidget(parent)
+    , m_bLogScale(false)
+{
+    setMinimumHeight(64);
+}
+
+void HistogramWidget::setLogScale(bool enabled)
+{
+    m_bLogScale = enabled;
+    update();
+}
+
+void HistogramWidget::setHistogram(const Histogram& histogram)
+{
+    m_Histogram = histogram;
+    update();
+}
+
+void HistogramWidget::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(32, 32, 32));
+    if (m_Histogram.isNull())
+        return;
+
+    auto scaled = [this](quint32 count) { return m_bLogScale ? std::log1p(double(count)) : double(count); };
+
+    // 所有通道使用同一纵轴，便于比较
+    double peak = 0.;
+    for (int c = 0; c < m_Histogram.channelCount; ++c)
+        for (quint32 count : m_Histogram.counts[c])
+            peak = std::max(peak, scaled(count));
+    if (peak <= 0.)
+        return;
+
+    static const QColor colors[3] = { QColor(255, 64, 64), QColor(64, 255, 64), QColor(64, 128, 255) };
+    const double w = width() - 1;
+    const double h = height() - 1;
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setCompositionMode(QPainter::CompositionMode_Plus);
+
+    for (int c = 0; c < m_Histogram.channelCount; ++c)
+    {
+        QPolygonF polygon;
+        polygon.reserve(Histogram::Bins + 2);
+        polygon << QPointF(0., h);
+        for (int bin = 0; bin < Histogram::Bins; ++bin)
+            polygon << QPointF(w * bin / (Histogram::Bins - 1), h - h * scaled(m_Histogram.counts[c][bin]) / peak);
+        polygon << QPointF(w, h);
+
+        QColor color = m_Histogram.channelCount == 1 ? QColor(200, 200, 200) : colors[c];
+        painter.setPen(color);
+        color.setAlpha(96);
+        painter.setBrush(color);
+        painter.drawPolygon(polygon);
+    }
+}
@@ -0,0 +1,224 @@
+/**
+ * @file imagecache.cpp
+ * @author ldk
+ * @brief 已解码图像的 LRU 缓存，支持内存预算与按浏览方向预取
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QThread>
+
+#include "imagecache.hpp"
+#include "graphicsviewinterface.hpp"
+#include "parallel.hpp"
+
+ImageCache::ImageCache(qint64 budget, QObject* parent)
+    : QObject(parent)
+    , m_nBudget(budget)
+    , m_nBytes(0)
+    , m_nPrefetchCount(DefaultPrefetchCount)
+{
+    m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
+}
+
+ImageCache::~ImageCache()
+{
+    cancelPrefetch();
+    m_pool.waitForDone();
+}
+
+/**
+ * @brief 获取图像，未命中时在调用线程中解码并加入缓存
+ * @remarks 若该图像正在后台预取，则等待预取完成而不是重复解码
+ *
+ * @param path 图像路径
+ * @return QImage 加载失败时返回空图像
+ */
+QImage ImageCache::image(const QString& path)
+{
+    const QString key = cacheKey(path);
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_loaded.wait(lock, [this, &key] { return m_pending.count(key) == 0; });
+
+        auto it = m_index.find(key);
+        if (it != m_index.end())
+        {
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            ++m_statistics.hits;
+            return it->second->image;
+        }
+        ++m_statistics.misses;
+        m_pending.insert(key);
+    }
+
+    QImage image = GraphicsViewInterface::loadImage(path);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.erase(key);
+        if (!image.isNull())
+            insert(key, image);
+    }
+    m_loaded.notify_all();
+    return image;
+}
+
+bool ImageCache::contains(const QString& path) const
+{
+    const QString key = cacheKey(path);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_index.find(key) != m_index.end();
+}
+
+/**
+ * @brief 按浏览方向预取相邻图像
+ * @remarks 沿浏览方向预取 prefetchCount() 张，反方向预取约四分之一（至少一张），
+ * 之前尚未开始的预取任务会被取消
+ *
+ * @param files 浏览的文件列表
+ * @param current 当前显示的文件序号
+ * @param direction 浏览方向，正数向后，负数向前
+ */
+void ImageCache::prefetch(const QStringList& files, int current, int direction)
+{
+    cancelPrefetch();
+    if (files.isEmpty() || m_nPrefetchCount <= 0)
+        return;
+
+    const int step = direction < 0 ? -1 : 1;
+    const int behind = std::max(1, m_nPrefetchCount / 4);
+    for (int i = 1; i <= m_nPrefetchCount; ++i)
+    {
+        const int index = current + step * i;
+        if (index < 0 || index >= files.size())
+            break;
+        const QString path = files[index];
+        runAsync(&m_pool, [this, path] { prefetchOne(path); }, 2 * m_nPrefetchCount - i);
+    }
+    for (int i = 1; i <= behind; ++i)
+    {
+        const int index = current - step * i;
+        if (index < 0 || index >= files.size())
+            break;
+        const QString path = files[index];
+        runAsync(&m_pool, [this, path] { prefetchOne(path); }, m_nPrefetchCount - i);
+    }
+}
+
+/* 取消尚未开始的预取任务 */
+void ImageCache::cancelPrefetch()
+{
+    m_pool.clear();
+}
+
+void ImageCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+    m_nBytes = 0;
+}
+
+void ImageCache::setBudget(qint64 bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_nBudget = bytes;
+    evict();
+}
+
+void ImageCache::setPrefetchCount(int count)
+{
+    m_nPrefetchCount = std::max(0, count);
+}
+
+void ImageCache::setPrefetchThreadCount(int count)
+{
+    m_pool.setMaxThreadCount(std::max(1, count));
+}
+
+void ImageCache::resetStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_statistics = ImageCacheStatistics();
+}
+
+ImageCacheStatistics ImageCache::statistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ImageCacheStatistics statistics = m_statistics;
+    statistics.bytes = m_nBytes;
+    statistics.budget = m_nBudget;
+    statistics.entries = int(m_entries.size());
+    return statistics;
+}
+
+/* 文件被覆盖后修改时间改变，旧的缓存项不会再被命中并随 LRU 淘汰 */
+QString ImageCache::cacheKey(const QString& path)
+{
+    const QFileInfo info(path);
+    return info.absoluteFilePath() + '|' + QString::number(info.lastModified().toMSecsSinceEpoch());
+}
+
+/**
+ * @brief 插入缓存项，调用前需持有 m_mutex
+ * @remarks 预取的图像插在最近使用项之后，避免挤掉当前正在显示的图像
+ */
+void ImageCache::insert(const QString& key, const QImage& image, bool mostRecent)
+{
+    auto it = m_index.find(key);
+    if (it != m_index.end())
+    {
+        m_nBytes -= it->second->bytes;
+        m_entries.erase(it->second);
+        m_index.erase(it);
+    }
+
+    const qint64 bytes = image.sizeInBytes();
+    auto position = mostRecent || m_entries.empty() ? m_entries.begin() : std::next(m_entries.begin());
+    m_index[key] = m_entries.insert(position, Entry{ key, image, bytes });
+    m_nBytes += bytes;
+    evict();
+}
+
+/* 淘汰最久未使用的图像直到满足预算，至少保留最新的一张，调用前需持有 m_mutex */
+void ImageCache::evict()
+{
+    while (m_nBytes > m_nBudget && m_entries.size() > 1)
+    {
+        m_nBytes -= m_entries.back().bytes;
+        m_index.erase(m_entries.back().key);
+        m_entries.pop_back();
+        ++m_statistics.evictions;
+    }
+}
+
+void ImageCache::prefetchOne(const QString& path)
+{
+    const QString key = cacheKey(path);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_index.find(key) != m_index.end() || m_pending.count(key) != 0)
+            return;
+        m_pending.insert(key);
+    }
+
+    QImage image = GraphicsViewInterface::loadImage(path);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.erase(key);
+        if (!image.isNull())
+        {
+            insert(key, image, false);
+            ++m_statistics.prefetched;
+        }
+    }
+    m_loaded.notify_all();
+}
@@ -0,0 +1,436 @@
+/**
+ * @file imagecompare.cpp
+ * @author ldk
+ * @brief 两幅图像的 A/B 比较：差值热力图、阈值掩膜与分割对比
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#include "imagecompare.hpp"
+#include "colormap.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+
+namespace
+{
+
+/* 一行逐字节绝对差 */
+void absDiffBytes(const uchar* a, const uchar* b, uchar* out, int bytes)
+{
+    int i = 0;
+#if defined(QTTOOLS_AVX2)
+    for (; i + 32 <= bytes; i += 32)
+    {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                            _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va)));
+    }
+#endif
+#if defined(QTTOOLS_SSE2)
+    for (; i + 16 <= bytes; i += 16)
+    {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va)));
+    }
+#elif defined(QTTOOLS_NEON)
+    for (; i + 16 <= bytes; i += 16)
+        vst1q_u8(out + i, vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+#endif
+    for (; i < bytes; ++i)
+        out[i] = uchar(std::abs(a[i] - b[i]));
+}
+
+#if defined(QTTOOLS_SSE2)
+/* 4 个 RGB32 像素三个颜色通道绝对差的最大值，结果在每个 32 位元素的低字节 */
+inline __m128i maxChannelDiff(const uchar* a, const uchar* b)
+{
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+    const __m128i diff = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+    const __m128i m = _mm_max_epu8(diff, _mm_max_epu8(_mm_srli_epi32(diff, 8), _mm_srli_epi32(diff, 16)));
+    return _mm_and_si128(m, _mm_set1_epi32(0xff));
+}
+#endif
+
+#if defined(QTTOOLS_AVX2)
+inline __m256i maxChannelDiff8(const uchar* a, const uchar* b)
+{
+    const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+    const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+    const __m256i diff = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+    const __m256i m = _mm256_max_epu8(diff, _mm256_max_epu8(_mm256_srli_epi32(diff, 8), _mm256_srli_epi32(diff, 16)));
+    return _mm256_and_si256(m, _mm256_set1_epi32(0xff));
+}
+#endif
+
+/* 一行 RGB32 像素的绝对差，取三个颜色通道的最大值 */
+void absDiffRgb(const uchar* a, const uchar* b, uchar* out, int pixels)
+{
+    int i = 0;
+#if defined(QTTOOLS_AVX2)
+    // 按 128 位通道打包后顺序为 0 2 4 6 1 3 5 7（每组 4 像素），再按 32 位元素重排
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    for (; i + 32 <= pixels; i += 32)
+    {
+        const uchar* pa = a + i * 4;
+        const uchar* pb = b + i * 4;
+        const __m256i low = _mm256_packs_epi32(maxChannelDiff8(pa, pb), maxChannelDiff8(pa + 32, pb + 32));
+        const __m256i high = _mm256_packs_epi32(maxChannelDiff8(pa + 64, pb + 64), maxChannelDiff8(pa + 96, pb + 96));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                            _mm256_permutevar8x32_epi32(_mm256_packus_epi16(low, high), order));
+    }
+#endif
+#if defined(QTTOOLS_SSE2)
+    for (; i + 16 <= pixels; i += 16)
+    {
+        const uchar* pa = a + i * 4;
+        const uchar* pb = b + i * 4;
+        const __m128i low = _mm_packs_epi32(maxChannelDiff(pa, pb), maxChannelDiff(pa + 16, pb + 16));
+        const __m128i high = _mm_packs_epi32(maxChannelDiff(pa + 32, pb + 32), maxChannelDiff(pa + 48, pb + 48));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(low, high));
+    }
+#elif defined(QTTOOLS_NEON)
+    for (; i + 16 <= pixels; i += 16)
+    {
+        const uint8x16x4_t va = vld4q_u8(a + i * 4);
+        const uint8x16x4_t vb = vld4q_u8(b + i * 4);
+        const uint8x16_t m = vmaxq_u8(vabdq_u8(va.val[0], vb.val[0]),
+                                      vmaxq_u8(vabdq_u8(va.val[1], vb.val[1]), vabdq_u8(va.val[2], vb.val[2])));
+        vst1q_u8(out + i, m);
+    }
+#endif
+    for (; i < pixels; ++i)
+    {
+        const uchar* pa = a + i * 4;
+        const uchar* pb = b + i * 4;
+        out[i] = uchar(std::max({ std::abs(pa[0] - pb[0]), std::abs(pa[1] - pb[1]), std::abs(pa[2] - pb[2]) }));
+    }
+}
+
+/* 一行像素的差值 */
+inline void diffRow(const uchar* a, const uchar* b, uchar* out, int pixels, bool gray)
+{
+    if (gray)
+        absDiffBytes(a, b, out, pixels);
+    else
+        absDiffRgb(a, b, out, pixels);
+}
+
+/* 热力图颜色表：Inferno，按差值的平方根分布以突出小差值 */
+const std::array<QRgb, 256>& heatmapTable()
+{
+    static const std::array<QRgb, 256> table = []
+    {
+        const Colormap inferno(ColormapPreset::Inferno);
+        std::array<QRgb, 256> result{ };
+        for (int i = 0; i < 256; ++i)
+            result[size_t(i)] = inferno.narrowTable()[int(std::lround(std::sqrt(i / 255.) * 255.))];
+        return result;
+    }();
+    return table;
+}
+
+inline QRgb grayToRgb(uchar value) noexcept
+{
+    return 0xff000000u | quint32(value) * 0x010101u;
+}
+
+} // namespace
+
+QImage absoluteDifference(const QImage& a, const QImage& b)
+{
+    if (a.isNull() || a.size() != b.size())
+        return QImage();
+
+    const bool gray = a.format() == QImage::Format_Grayscale8 && b.format() == QImage::Format_Grayscale8;
+    const QImage ia = gray ? a : a.convertToFormat(QImage::Format_RGB32);
+    const QImage ib = gray ? b : b.convertToFormat(QImage::Format_RGB32);
+    QImage result(a.size(), QImage::Format_Grayscale8);
+    if (result.isNull())
+        return QImage();
+
+    const uchar* bitsA = ia.constBits();
+    const uchar* bitsB = ib.constBits();
+    uchar* bits = result.bits();
+    const qsizetype bplA = ia.bytesPerLine();
+    const qsizetype bplB = ib.bytesPerLine();
+    const qsizetype bpl = result.bytesPerLine();
+    const int width = a.width();
+    parallelFor(0, a.height(), [&](int first, int last)
+    {
+        for (int y = first; y < last; ++y)
+            diffRow(bitsA + y * bplA, bitsB + y * bplB, bits + y * bpl, width, gray);
+    }, 32);
+    return result;
+}
+
+/**
+ * @brief 设置比较的两幅图像
+ *
+ * @return bool 图像为空或尺寸不同时返回 false 并清空
+ */
+bool ImageComparator::setImages(const QImage& a, const QImage& b)
+{
+    clear();
+    if (a.isNull() || a.size() != b.size())
+        return false;
+
+    const bool gray = a.format() == QImage::Format_Grayscale8 && b.format() == QImage::Format_Grayscale8;
+    m_a = gray ? a : a.convertToFormat(QImage::Format_RGB32);
+    m_b = gray ? b : b.convertToFormat(QImage::Format_RGB32);
+    QRegion whole;
+    QImage& composite = m_composite.acquire(a.size(), QImage::Format_RGB32, whole);
+    if (m_a.isNull() || m_b.isNull() || composite.isNull())
+    {
+        clear();
+        return false;
+    }
+    composite.fill(Qt::black);
+
+    m_nTilesX = (a.width() + TileSize - 1) / TileSize;
+    m_nTilesY = (a.height() + TileSize - 1) / TileSize;
+    m_tiles.assign(size_t(m_nTilesX) * m_nTilesY, 0);
+    return true;
+}
+
+void ImageComparator::clear()
+{
+    m_a = QImage();
+    m_b = QImage();
+    m_composite.clear();
+    m_tiles.clear();
+    m_nTilesX = m_nTilesY = 0;
+    m_bHistogram = false;
+}
+
+void ImageComparator::setMode(CompareMode mode)
+{
+    if (mode == m_eMode)
+        return;
+    m_eMode = mode;
+    invalidate();
+}
+
+/**
+ * @brief 设置差值阈值，用于掩膜与统计中的差异像素数
+ *
+ * @param threshold 阈值 [0, 255]，差值大于阈值的像素视为不同
+ */
+void ImageComparator::setThreshold(int threshold)
+{
+    threshold = qBound(0, threshold, 255);
+    if (threshold == m_nThreshold)
+        return;
+    m_nThreshold = threshold;
+    if (m_eMode == CompareMode::Mask)
+        invalidate();
+}
+
+/**
+ * @brief 设置分割位置，只有新旧分割线之间的分块需要重新合成
+ *
+ * @param position 相对宽度 [0, 1]
+ */
+void ImageComparator::setSplitPosition(double position)
+{
+    const int previous = splitX();
+    m_dSplit = qBound(0., position, 1.);
+    const int current = splitX();
+    if (m_eMode == CompareMode::Split && previous != current)
+        invalidate(std::min(previous, current), std::max(previous, current) + 1);
+}
+
+/**
+ * @brief 合成可见区域内尚未合成的分块
+ *
+ * @param visible 可见区域（图像坐标）
+ * @return QRegion 本次合成的区域
+ */
+QRegion ImageComparator::update(const QRect& visible)
+{
+    const QRect area = visible & m_a.rect();
+    if (isNull() || area.isEmpty())
+        return QRegion();
+
+    std::vector<int> pending;
+    for (int ty = area.top() / TileSize; ty <= area.bottom() / TileSize; ++ty)
+        for (int tx = area.left() / TileSize; tx <= area.right() / TileSize; ++tx)
+            if (!m_tiles[size_t(ty) * m_nTilesX + tx])
+                pending.push_back(ty * m_nTilesX + tx);
+    if (pending.empty())
+        return QRegion();
+
+    QRegion region;
+    for (int tile : pending)
+        region += tileRect(tile);
+    // 控件仍持有上一次的结果，写入未被共享的缓冲；缓冲无法从上一次结果补齐时重新合成所有已合成的分块
+    QRegion written = region;
+    QImage& composite = m_composite.acquire(m_a.size(), QImage::Format_RGB32, written);
+    if (composite.isNull())
+        return QRegion();
+    if (written != region)
+    {
+        composite.fill(Qt::black);
+        for (int tile = 0; tile < int(m_tiles.size()); ++tile)
+            if (m_tiles[size_t(tile)] && std::find(pending.begin(), pending.end(), tile) == pending.end())
+                pending.push_back(tile);
+        region = written;
+    }
+
+    uchar* bits = composite.bits();
+    const qsizetype bytesPerLine = composite.bytesPerLine();
+    parallelFor(0, int(pending.size()), [&](int first, int last)
+    {
+        for (int i = first; i < last; ++i)
+            renderTile(pending[size_t(i)], bits, bytesPerLine);
+    }, 1);
+
+    for (int tile : pending)
+        m_tiles[size_t(tile)] = 1;
+    return region;
+}
+
+/* 分块在图像中的矩形 */
+QRect ImageComparator::tileRect(int tile) const
+{
+    return QRect((tile % m_nTilesX) * TileSize, (tile / m_nTilesX) * TileSize, TileSize, TileSize) & m_a.rect();
+}
+
+/**
+ * @brief 整幅图像的差值统计
+ * @remarks 首次调用时并行计算差值直方图，之后修改阈值无需重新计算
+ */
+CompareStatistics ImageComparator::statistics() const
+{
+    CompareStatistics result;
+    if (isNull())
+        return result;
+
+    if (!m_bHistogram)
+    {
+        m_histogram.fill(0);
+        std::mutex mutex;
+        const bool gray = m_a.format() == QImage::Format_Grayscale8;
+        const uchar* bitsA = m_a.constBits();
+        const uchar* bitsB = m_b.constBits();
+        const qsizetype bplA = m_a.bytesPerLine();
+        const qsizetype bplB = m_b.bytesPerLine();
+        const int width = m_a.width();
+        parallelFor(0, m_a.height(), [&](int first, int last)
+        {
+            std::array<quint64, 256> local{ };
+            std::vector<uchar> row(size_t(width));
+            for (int y = first; y < last; ++y)
+            {
+                diffRow(bitsA + y * bplA, bitsB + y * bplB, row.data(), width, gray);
+                for (uchar value : row)
+                    ++local[value];
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < local.size(); ++i)
+                m_histogram[i] += local[i];
+        }, 32);
+        m_bHistogram = true;
+    }
+
+    double sum = 0., squares = 0.;
+    for (int value = 0; value < 256; ++value)
+    {
+        const quint64 count = m_histogram[size_t(value)];
+        if (count == 0)
+            continue;
+        result.pixels += count;
+        result.maxDiff = value;
+        sum += double(value) * count;
+        squares += double(value) * value * count;
+        if (value > m_nThreshold)
+            result.differing += count;
+    }
+    result.meanDiff = sum / double(result.pixels);
+    result.rmse = std::sqrt(squares / double(result.pixels));
+    return result;
+}
+
+/* 使横坐标与 [x0, x1) 相交的分块失效 */
+void ImageComparator::invalidate(int x0, int x1)
+{
+    if (isNull())
+        return;
+    const int first = std::max(0, x0 / TileSize);
+    const int last = std::min(m_nTilesX - 1, (std::min(x1, m_a.width()) - 1) / TileSize);
+    for (int ty = 0; ty < m_nTilesY; ++ty)
+        for (int tx = first; tx <= last; ++tx)
+            m_tiles[size_t(ty) * m_nTilesX + tx] = 0;
+}
+
+/* 按显示方式合成一个分块 */
+void ImageComparator::renderTile(int tile, uchar* bits, qsizetype bytesPerLine) const
+{
+    const int x0 = (tile % m_nTilesX) * TileSize;
+    const int y0 = (tile / m_nTilesX) * TileSize;
+    const int x1 = std::min(x0 + TileSize, m_a.width());
+    const int y1 = std::min(y0 + TileSize, m_a.height());
+    const int width = x1 - x0;
+    const bool gray = m_a.format() == QImage::Format_Grayscale8;
+    const int pixelBytes = gray ? 1 : 4;
+    const std::array<QRgb, 256>& table = heatmapTable();
+    const int split = splitX();
+    uchar diff[TileSize];
+
+    for (int y = y0; y < y1; ++y)
+    {
+        const uchar* a = m_a.constScanLine(y) + x0 * pixelBytes;
+        const uchar* b = m_b.constScanLine(y) + x0 * pixelBytes;
+        auto* out = reinterpret_cast<QRgb*>(bits + y * bytesPerLine) + x0;
+
+        switch (m_eMode)
+        {
+        case CompareMode::Split:
+        {
+            const int left = std::clamp(split - x0, 0, width);
+            if (gray)
+            {
+                for (int x = 0; x < left; ++x)
+                    out[x] = grayToRgb(a[x]);
+                for (int x = left; x < width; ++x)
+                    out[x] = grayToRgb(b[x]);
+            }
+            else
+            {
+                std::memcpy(out, a, size_t(left) * 4);
+                std::memcpy(out + left, b + left * 4, size_t(width - left) * 4);
+            }
+            break;
+        }
+        case CompareMode::Mask:
+        {
+            diffRow(a, b, diff, width, gray);
+            const auto* rgb = reinterpret_cast<const QRgb*>(a);
+            for (int x = 0; x < width; ++x)
+            {
+                if (diff[x] > m_nThreshold)
+                    out[x] = qRgb(255, 0, 0);
+                else
+                    out[x] = gray ? grayToRgb(a[x] >> 1) : 0xff000000u | ((rgb[x] >> 1) & 0x7f7f7fu);
+            }
+            break;
+        }
+        default:
+            diffRow(a, b, diff, width, gray);
+            for (int x = 0; x < width; ++x)
+                out[x] = table[diff[x]];
+            break;
+        }
+    }
+}
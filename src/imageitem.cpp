@@ -0,0 +1,582 @@
+/**
+ * @file imageitem.cpp
+ * @author ldk
+ * @brief 按缩放倍数选择绘制方式的图像控件
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+#include "imageitem.hpp"
+#include "bufferring.hpp"
+#include "graphicsviewinterface.hpp"
+#include "parallel.hpp"
+#include "resample.hpp"
+
+namespace
+{
+
+constexpr int ROW_GRAIN{ 16 };          // 并行时每段的最小行数
+constexpr int MAX_SPARE_CHAINS{ 2 };    // 保留待复用的多级纹理数
+
+/* 转换为可以逐字节平均的格式，带透明度的图像需预乘 */
+QImage mipSource(const QImage& image)
+{
+    switch (image.format())
+    {
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+    case QImage::Format_Grayscale8:
+        return image;
+    default:
+        return image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                             : QImage::Format_RGB32);
+    }
+}
+
+/* 是否可以直接逐字节平均 */
+bool isMipFormat(QImage::Format format)
+{
+    return format == QImage::Format_RGB32 || format == QImage::Format_ARGB32_Premultiplied
+        || format == QImage::Format_Grayscale8;
+}
+
+/**
+ * @brief 2x2 盒式滤波计算 result 中 area 范围内的像素，奇数尺寸的最后一行（列）与自身平均
+ *
+ * @param source 上一级图像
+ * @param result 缩小一半的图像
+ * @param area result 中需要计算的范围
+ */
+void halfSize(const QImage& source, QImage& result, const QRect& area)
+{
+    const int channels = source.format() == QImage::Format_Grayscale8 ? 1 : 4;
+    const int lastX = source.width() - 1;
+    const int lastY = source.height() - 1;
+    const int left = area.left();
+    const int right = area.right() + 1;
+    const uchar* src = source.constBits();
+    const qsizetype srcBytesPerLine = source.bytesPerLine();
+    uchar* dst = result.bits();
+    const qsizetype dstBytesPerLine = result.bytesPerLine();
+
+    parallelFor(area.top(), area.bottom() + 1, [&](int first, int last)
+    {
+        for (int y = first; y < last; ++y)
+        {
+            const uchar* row0 = src + 2 * y * srcBytesPerLine;
+            const uchar* row1 = src + std::min(2 * y + 1, lastY) * srcBytesPerLine;
+            uchar* out = dst + y * dstBytesPerLine;
+            for (int x = left; x < right; ++x)
+            {
+                const int x0 = 2 * x * channels;
+                const int x1 = std::min(2 * x + 1, lastX) * channels;
+                for (int c = 0; c < channels; ++c)
+                    out[x * channels + c] = uchar((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+            }
+        }
+    }, ROW_GRAIN);
+}
+
+/* 缩小一半后的尺寸 */
+QSize halfSize(const QSize& size)
+{
+    return QSize(std::max(1, (size.width() + 1) / 2), std::max(1, (size.height() + 1) / 2));
+}
+
+} // namespace
+
+/**
+ * @brief 一幅图像的多级纹理，第 i 项为第 i + 1 级
+ * @remarks 各级在线程池中生成，生成期间绘制使用已生成的一级；
+ * 原图只在 GUI 线程替换，生成线程在互斥锁内取走原图与变化区域
+ */
+struct MipChain
+{
+    std::mutex              mutex;              // 保护以下成员
+    QImage                  base;               // 原图
+    std::vector<QImage>     levels;             // 已生成的各级，可能落后于原图
+    qint64                  levelsKey = 0;      // levels 对应原图的 cacheKey
+    QRegion                 dirty;              // 上次生成以来原图变化的区域
+    bool                    dirtyFull = true;   // 是否需要整幅重新生成
+    bool                    building = false;   // 是否有生成任务在运行
+    qint64                  bytes = 0;          // 各级缓冲占用的字节数
+    std::vector<BufferRing> rings;              // 各级的轮换缓冲，只在生成线程访问
+    std::vector<ImageItem*> items;              // 使用该多级纹理的控件，只在 GUI 线程访问
+
+    /**
+     * @brief 替换为只有 region 内像素改变的图像，下一次生成时只重新计算各级中受影响的像素
+     * @remarks 尺寸或格式改变时整幅重新生成
+     */
+    void update(const QImage& image, const QRegion& region)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const bool reuse = image.size() == base.size() && image.format() == base.format()
+                        && isMipFormat(image.format());
+        base = image;
+        if (reuse && !dirtyFull)
+            dirty += region & base.rect();
+        else
+            dirtyFull = true;
+    }
+
+    /* 替换为新的图像，下一次生成时整幅重新生成；尺寸相同时生成完成前仍使用已生成的各级 */
+    void replace(const QImage& image)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        base = image;
+        dirty = QRegion();
+        dirtyFull = true;
+    }
+
+    /* 不再被控件使用时释放原图与已发布的各级，保留轮换缓冲供复用 */
+    void retire()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        base = QImage();
+        levels.clear();
+        levelsKey = 0;
+        dirty = QRegion();
+        dirtyFull = true;
+    }
+
+    /**
+     * @brief 获取不超过指定级别、已经生成的最高一级
+     * @remarks 已生成的各级落后于原图（连续更新时生成尚未完成）但尺寸相同时仍然使用，
+     * 生成完成后控件重绘；没有可用的级别时返回原图
+     *
+     * @param level 需要的级别
+     * @param ready 输出实际返回的级别
+     * @param current 输出返回的图像是否与原图一致
+     */
+    QImage level(int level, int& ready, bool& current)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready = levels.empty() || levels.front().size() != halfSize(base.size()) ? 0 : std::min(level, int(levels.size()));
+        current = ready == 0 || levelsKey == base.cacheKey();
+        return ready == 0 ? base : levels[size_t(ready) - 1];
+    }
+
+    /**
+     * @brief 在生成线程中按变化区域更新各级，full 时整幅重新生成
+     * @remarks 各级写入轮换缓冲中未被绘制或已发布的各级共享的一个，
+     * 尺寸与格式不变时不再分配内存，只从上一次的结果补齐落后的区域
+     */
+    void build(const QImage& image, const QRegion& region, bool full)
+    {
+        if (!full && region.isEmpty())
+            return;
+        const QImage source = full ? mipSource(image) : image;
+        int count = 0;
+        for (QSize size = source.size(); size.width() > 1 || size.height() > 1; size = halfSize(size))
+            ++count;
+        rings.resize(size_t(count));
+
+        QRegion changed = full ? QRegion(source.rect()) : region;
+        const QImage* previous = &source;
+        for (BufferRing& ring : rings)
+        {
+            // 源像素 (x, y) 只影响下一级的 (x / 2, y / 2)
+            const QSize size = halfSize(previous->size());
+            QRegion area;
+            if (!full)
+            {
+                for (const QRect& rect : changed)
+                    area += QRect(QPoint(rect.left() / 2, rect.top() / 2), QPoint(rect.right() / 2, rect.bottom() / 2));
+                area &= QRect(QPoint(0, 0), size);
+            }
+            // 缓冲无法从上一次的结果补齐时 area 被设为整幅，之后各级随之整幅计算
+            QImage& level = ring.acquire(size, source.format(), area);
+            for (const QRect& rect : area)
+                halfSize(*previous, level, rect);
+            changed = area;
+            previous = &level;
+        }
+    }
+};
+
+namespace
+{
+
+/* 以 cacheKey 索引的多级纹理，只在 GUI 线程访问 */
+QHash<qint64, std::weak_ptr<MipChain>>& mipRegistry()
+{
+    static QHash<qint64, std::weak_ptr<MipChain>> registry;
+    return registry;
+}
+
+/* 不再被控件使用、保留缓冲待复用的多级纹理，只在 GUI 线程访问 */
+std::vector<std::shared_ptr<MipChain>>& spareMipChains()
+{
+    static std::vector<std::shared_ptr<MipChain>> spares;
+    return spares;
+}
+
+/* 按 cacheKey 查找其他控件正在使用的多级纹理 */
+std::shared_ptr<MipChain> findMipChain(qint64 key)
+{
+    auto& registry = mipRegistry();
+    for (auto it = registry.begin(); it != registry.end();)
+        it = it->expired() ? registry.erase(it) : std::next(it);
+    return registry.value(key).lock();
+}
+
+/**
+ * @brief 按 cacheKey 查找其他控件正在使用的多级纹理，没有时优先复用保留的多级纹理
+ * @remarks 多个控件显示同一组连续帧时，各控件交替换用同一组缓冲，稳定运行时不再分配
+ */
+std::shared_ptr<MipChain> sharedMipChain(const QImage& image)
+{
+    std::shared_ptr<MipChain> chain = findMipChain(image.cacheKey());
+    if (!chain)
+    {
+        auto& spares = spareMipChains();
+        if (spares.empty())
+        {
+            chain = std::make_shared<MipChain>();
+        }
+        else
+        {
+            chain = std::move(spares.back());
+            spares.pop_back();
+        }
+        chain->replace(image);
+        mipRegistry().insert(image.cacheKey(), chain);
+    }
+    return chain;
+}
+
+/* 多级纹理不再被控件使用时移出索引，保留至多 MAX_SPARE_CHAINS 个供复用 */
+void retireMipChain(const std::shared_ptr<MipChain>& chain)
+{
+    auto& registry = mipRegistry();
+    const qint64 key = chain->base.cacheKey();
+    if (registry.value(key).lock() == chain)
+        registry.remove(key);
+    chain->retire();
+    auto& spares = spareMipChains();
+    if (int(spares.size()) < MAX_SPARE_CHAINS)
+        spares.push_back(chain);
+}
+
+/* 多级纹理的原图被替换后更新其索引 */
+void rekeyMipChain(qint64 previousKey, const std::shared_ptr<MipChain>& chain)
+{
+    auto& registry = mipRegistry();
+    if (registry.value(previousKey).lock() == chain)
+        registry.remove(previousKey);
+    registry.insert(chain->base.cacheKey(), chain);
+}
+
+/**
+ * @brief 在线程池中生成多级纹理，直到各级与原图一致
+ * @remarks 每个多级纹理同时至多一个生成任务；每次生成完成后在 GUI 线程重绘使用它的控件
+ */
+void buildMipChain(const std::shared_ptr<MipChain>& chain)
+{
+    {
+        std::lock_guard<std::mutex> lock(chain->mutex);
+        if (chain->building || (!chain->dirtyFull && chain->levelsKey == chain->base.cacheKey()))
+            return;
+        chain->building = true;
+    }
+    runAsync(nullptr, [chain]
+    {
+        for (;;)
+        {
+            QImage image;
+            QRegion region;
+            bool full = false;
+            {
+                std::lock_guard<std::mutex> lock(chain->mutex);
+                if (chain->base.isNull() || (!chain->dirtyFull && chain->levelsKey == chain->base.cacheKey()))
+                {
+                    chain->building = false;
+                    return;
+                }
+                image = chain->base;
+                region.swap(chain->dirty);
+                full = chain->dirtyFull || chain->rings.empty();
+                chain->dirtyFull = false;
+            }
+            chain->build(image, region, full);
+            qint64 bytes = 0;
+            for (const BufferRing& ring : chain->rings)
+                for (int i = 0; i < ring.count(); ++i)
+                    bytes += ring.at(i).sizeInBytes();
+            {
+                std::lock_guard<std::mutex> lock(chain->mutex);
+                chain->levels.resize(chain->rings.size());
+                for (size_t i = 0; i < chain->rings.size(); ++i)
+                    chain->levels[i] = chain->rings[i].current();
+                chain->levelsKey = image.cacheKey();
+                chain->bytes = bytes;
+            }
+            std::weak_ptr<MipChain> weak = chain;
+            QMetaObject::invokeMethod(qApp, [weak]
+            {
+                if (const std::shared_ptr<MipChain> chain = weak.lock())
+                    for (ImageItem* item : chain->items)
+                        item->update();
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
+} // namespace
+
+ImageItem::ImageItem(QGraphicsItem* parent)
+    : QGraphicsItem(parent)
+    , m_nScaledKey(0)
+    , m_dScaledZoom(0.)
+    , m_dZoom(0.)
+    , m_bGridVisible(false)
+    , m_pValueSource(nullptr)
+{
+    // 绘制时需要准确的暴露区域以只绘制可见像素
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+ImageItem::~ImageItem()
+{
+    setMipChain(nullptr);
+}
+
+/**
+ * @brief 设置图像，图像未改变时不做任何操作
+ * @remarks 最近一次绘制为缩小时立即在线程池中生成多级纹理
+ */
+void ImageItem::setImage(const QImage& image)
+{
+    if (image.cacheKey() == m_image.cacheKey())
+        return;
+    if (image.size() != m_image.size())
+        prepareGeometryChange();
+    m_image = image;
+    if (image.isNull())
+    {
+        setMipChain(nullptr);
+    }
+    else if (m_pMipChain && m_pMipChain->items.size() == 1 && !findMipChain(image.cacheKey()))
+    {
+        // 只有本控件使用时原处替换，复用各级的缓冲
+        const qint64 previousKey = m_pMipChain->base.cacheKey();
+        m_pMipChain->replace(image);
+        rekeyMipChain(previousKey, m_pMipChain);
+    }
+    else
+    {
+        setMipChain(sharedMipChain(image));
+    }
+    if (m_pMipChain && m_dZoom < 1.)
+        buildMipChain(m_pMipChain);
+    update();
+}
+
+/**
+ * @brief 设置只有部分区域改变的图像，只更新并重绘变化的区域
+ * @remarks 尺寸改变时按整幅图像处理；多级纹理与其他控件共享时不在原处修改
+ *
+ * @param image 新图像
+ * @param region 变化区域（图像坐标）
+ */
+void ImageItem::setImage(const QImage& image, const QRegion& region)
+{
+    if (image.isNull() || image.size() != m_image.size())
+    {
+        setImage(image);
+        return;
+    }
+    if (image.cacheKey() == m_image.cacheKey() && region.isEmpty())
+        return;
+
+    if (m_pMipChain && m_pMipChain->items.size() == 1)
+    {
+        const qint64 previousKey = m_pMipChain->base.cacheKey();
+        m_pMipChain->update(image, region);
+        rekeyMipChain(previousKey, m_pMipChain);
+    }
+    else
+    {
+        setMipChain(sharedMipChain(image));
+    }
+    m_image = image;
+    if (m_dZoom < 1.)
+        buildMipChain(m_pMipChain);
+    for (const QRect& rect : region)
+        update(QRectF(rect));
+}
+
+/* 更换使用的多级纹理，登记到多级纹理的控件列表中 */
+void ImageItem::setMipChain(std::shared_ptr<MipChain> chain)
+{
+    if (chain == m_pMipChain)
+        return;
+    if (m_pMipChain)
+    {
+        auto& items = m_pMipChain->items;
+        items.erase(std::remove(items.begin(), items.end(), this), items.end());
+        if (items.empty())
+            retireMipChain(m_pMipChain);
+    }
+    m_pMipChain = std::move(chain);
+    if (m_pMipChain)
+        m_pMipChain->items.push_back(this);
+}
+
+/* 多级纹理的轮换缓冲（不含原图）与重采样图像占用的字节数 */
+qint64 ImageItem::cacheBytes() const
+{
+    qint64 bytes = m_scaled.sizeInBytes();
+    if (m_pMipChain)
+    {
+        std::lock_guard<std::mutex> lock(m_pMipChain->mutex);
+        bytes += m_pMipChain->bytes;
+    }
+    return bytes;
+}
+
+void ImageItem::setPixelGridVisible(bool visible)
+{
+    m_bGridVisible = visible;
+    update();
+}
+
+/**
+ * @brief 设置是否在放大时显示像素值
+ *
+ * @param visible 是否显示
+ * @param source 像素值来源，显示高位深图像或浮点图像的原始值
+ */
+void ImageItem::setPixelValuesVisible(bool visible, const GraphicsViewInterface* source)
+{
+    m_pValueSource = visible ? source : nullptr;
+    update();
+}
+
+QRectF ImageItem::boundingRect() const
+{
+    return QRectF(QPointF(0, 0), m_image.size());
+}
+
+void ImageItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(widget);
+    if (m_image.isNull())
+        return;
+
+    const double zoom = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    m_dZoom = zoom;
+    const QRectF exposed = option->exposedRect & boundingRect();
+    if (exposed.isEmpty())
+        return;
+
+    if (zoom < 1.)
+    {
+        // 选择分辨率不低于屏幕的最小一级，平滑插值的缩小比例不超过 2
+        const int level = int(std::floor(std::log2(1. / zoom)));
+        // 多级纹理在线程池中生成，尚未生成时使用已生成的一级或原图，生成完成后重绘
+        int ready = 0;
+        bool current = true;
+        const QImage mip = m_pMipChain->level(level, ready, current);
+        if (ready < level || !current)
+            buildMipChain(m_pMipChain);
+        // 暴露区域在该级中的范围，外扩一个像素作为插值的支撑
+        const double mx = double(mip.width()) / m_image.width();
+        const double my = double(mip.height()) / m_image.height();
+        const QRect area = QRectF(exposed.x() * mx, exposed.y() * my, exposed.width() * mx, exposed.height() * my)
+                               .toAlignedRect().adjusted(-1, -1, 1, 1) & mip.rect();
+        // 再以三角滤波只把暴露区域重采样到屏幕分辨率，绘制时近似 1:1，避免绘制时的插值在 0.5 - 1 倍之间欠采样；
+        // 计算量与暴露区域而非整幅图像成正比，缩放、新帧与部分更新时都只重采样需要重绘的部分
+        const double ratio = zoom / mx;
+        const QSize target(qRound(area.width() * ratio), qRound(area.height() * ratio));
+        const bool refine = !target.isEmpty() && qint64(target.width()) * target.height() <= MaxRefinedPixels;
+        const bool cached = m_nScaledKey == mip.cacheKey() && m_dScaledZoom == zoom && m_ScaledArea.contains(area);
+        if (refine && !cached)
+        {
+            // 直接从该级的子区域重采样到复用的缓冲，原图格式不能直接处理时才复制并转换
+            if (!resample(mip, area, target, m_scaled, ResampleFilter::Bilinear))
+                m_scaled = resample(mip.copy(area), target, ResampleFilter::Bilinear);
+            m_nScaledKey = mip.cacheKey();
+            m_dScaledZoom = zoom;
+            m_ScaledArea = area;
+            m_ScaledSize = target;
+        }
+        // 重采样结果位于 m_scaled 左上角 m_ScaledSize 范围，覆盖该级中的 m_ScaledArea；未重采样时直接绘制该级
+        const QImage& image = refine ? m_scaled : mip;
+        const QRect covered = refine ? m_ScaledArea : mip.rect();
+        const QSize used = refine ? m_ScaledSize : mip.size();
+        const double sx = mx * used.width() / covered.width();
+        const double sy = my * used.height() / covered.height();
+        const double ox = covered.x() * double(used.width()) / covered.width();
+        const double oy = covered.y() * double(used.height()) / covered.height();
+        const QRectF source(exposed.x() * sx - ox, exposed.y() * sy - oy, exposed.width() * sx, exposed.height() * sy);
+        painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+        painter->drawImage(exposed, image, source);
+        return;
+    }
+
+    // 放大时只绘制可见的源像素
+    const QRect pixels = exposed.toAlignedRect() & m_image.rect();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+    painter->drawImage(QRectF(pixels), m_image, QRectF(pixels));
+    if (m_bGridVisible && zoom >= GridZoom)
+        drawPixelGrid(painter, pixels);
+    if (m_pValueSource && zoom >= TextZoom)
+        drawPixelValues(painter, pixels);
+}
+
+void ImageItem::drawPixelGrid(QPainter* painter, const QRect& pixels)
+{
+    QVector<QLineF> lines;
+    lines.reserve(pixels.width() + pixels.height() + 2);
+    for (int x = pixels.left(); x <= pixels.right() + 1; ++x)
+        lines.append(QLineF(x, pixels.top(), x, pixels.bottom() + 1));
+    for (int y = pixels.top(); y <= pixels.bottom() + 1; ++y)
+        lines.append(QLineF(pixels.left(), y, pixels.right() + 1, y));
+
+    // 线宽为 0 的画笔不随缩放变粗
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    painter->setPen(QPen(QColor(128, 128, 128, 160), 0));
+    painter->drawLines(lines);
+}
+
+/* 在设备坐标系下绘制文字，避免字体随缩放放大 */
+void ImageItem::drawPixelValues(QPainter* painter, const QRect& pixels)
+{
+    QVector<double> values;
+    m_pValueSource->getRegionValues(pixels, values);
+    const QTransform transform = painter->worldTransform();
+
+    painter->save();
+    painter->resetTransform();
+    QFont font = painter->font();
+    font.setPixelSize(qBound(8, int(QStyleOptionGraphicsItem::levelOfDetailFromTransform(transform) / 4), 14));
+    painter->setFont(font);
+    for (int y = 0; y < pixels.height(); ++y)
+    {
+        for (int x = 0; x < pixels.width(); ++x)
+        {
+            const double value = values[y * pixels.width() + x];
+            if (qIsNaN(value))
+                continue;
+            const QPoint pixel(pixels.left() + x, pixels.top() + y);
+            // 根据底色选择文字颜色
+            painter->setPen(qGray(m_image.pixel(pixel)) < 128 ? Qt::white : Qt::black);
+            painter->drawText(transform.mapRect(QRectF(pixel, QSizeF(1, 1))), Qt::AlignCenter, QString::number(value, 'g', 5));
+        }
+    }
+    painter->restore();
+}
@@ -9,10 +9,29 @@
  * 
  */
 
+#include <mutex>
+
 #include <QBoxLayout>
+#include <QFontDatabase>
+#include <QTimer>
 
 #include "imageplayer.hpp"
+#include "framesource.hpp"
 #include "graphicsviewinterface.hpp"
+#include "histogramwidget.hpp"
+#include "imagecache.hpp"
+#include "sequenceplayer.hpp"
+
+/**
+ * @brief 帧源推送、尚未被界面线程取走的最新一帧
+ */
+struct SourceFrameSlot
+{
+    std::mutex  mutex;
+    QImage      image;
+    FrameInfo   info;
+    bool        pending = false;    // 是否已投递到界面线程
+};
 
 void setColorInfo(QColor color, QLabel* label, QColorType type)
 {
@@ -37,14 +56,42 @@ void setColorInfo(QColor color, QLabel* label, QColorType type)
 	label->setText(info);
 }
 
+void setNeighborhoodInfo(const QVector<double>& values, int size, QLabel* label)
+{
+	// 'g' 格式 6 位有效数字最长为 "-1.23457e+100"（13 个字符），再留一个空格分隔各列
+	constexpr int FIELD_WIDTH = 14;
+	QString info;
+	info.reserve(values.size() * FIELD_WIDTH + size);
+	for (int y = 0; y < size; ++y)
+	{
+		if (y > 0)
+			info += '\n';
+		for (int x = 0; x < size; ++x)
+		{
+			const double value = values[y * size + x];
+			info += (qIsNaN(value) ? QString("-") : QString::number(value, 'g', 6)).rightJustified(FIELD_WIDTH);
+		}
+	}
+	label->setText(info);
+}
+
 ImagePlayer::ImagePlayer(QWidget* parent)
 	: QWidget(parent)
 	, m_pInterface(nullptr)
+	, m_pImageCache(nullptr)
+	, m_pSequencePlayer(nullptr)
+	, m_pSource(nullptr)
+	, m_pHistogramEngine(nullptr)
+	, m_pHistogramWidget(nullptr)
+	, m_nCurrentIndex(-1)
 	, m_pImageLayout(new QVBoxLayout(parent))
 	, m_pBottomLayout(new QHBoxLayout(parent))
 	, m_pPosLabel(new QLabel(parent))
 	, m_pRGBLabel(new QLabel(parent))
 	, m_pHSVLabel(new QLabel(parent))
+	, m_pNeighborhoodLabel(nullptr)
+	, m_nNeighborhoodSize(0)
+	, m_pPosTimer(new QTimer(this))
 {
 	m_pInterface = new GraphicsViewInterface(m_pImageLayout, parent);
 	Init();
@@ -53,12 +100,19 @@ ImagePlayer::ImagePlayer(QWidget* parent)
 
 ImagePlayer::~ImagePlayer()
 {
+	bindSource(nullptr);
+	if (m_pSequencePlayer)
+		m_pSequencePlayer->stop();
+	// 直方图引擎引用 m_pInterface，需先于其析构
+	delete m_pHistogramEngine;
 	delete m_pInterface;
 	m_pImageLayout->deleteLater();
 	m_pBottomLayout->deleteLater();
 	m_pHSVLabel->deleteLater();
 	m_pRGBLabel->deleteLater();
 	m_pPosLabel->deleteLater();
+	if (m_pNeighborhoodLabel)
+		m_pNeighborhoodLabel->deleteLater();
 }
 
 void ImagePlayer::Init()
@@ -82,7 +136,12 @@ void ImagePlayer::Init()
 	m_pImageLayout->setStretch(0, 12);
 	m_pImageLayout->setStretch(1, 1);
 
-	connect(m_pInterface, &GraphicsViewInterface::mouseMoveEvent, this, &ImagePlayer::setPosInfo);
+	// 鼠标移动事件合并为每个显示周期至多一次更新
+	m_pPosTimer->setObjectName("posInfoTimer");
+	m_pPosTimer->setSingleShot(true);
+	m_pPosTimer->setInterval(16);
+	connect(m_pPosTimer, &QTimer::timeout, this, &ImagePlayer::setPosInfo);
+	connect(m_pInterface, &GraphicsViewInterface::mouseMoveEvent, this, &ImagePlayer::requestPosInfo);
 }
 
 int ImagePlayer::width() const noexcept
@@ -118,6 +177,9 @@ void ImagePlayer::setMaxZoom(double maxZoom)
 void ImagePlayer::DynamicMode(int _RefreshTime)
 {
     m_pInterface->DynamicMode(_RefreshTime);
+    m_pPosTimer->setInterval(_RefreshTime);
+    if (m_pHistogramEngine)
+        m_pHistogramEngine->setUpdateInterval(_RefreshTime);
 }
 
 void ImagePlayer::StaticMode()
@@ -145,14 +207,301 @@ void ImagePlayer::setImage(const QImage& image)
     m_pInterface->setImage(image);
 }
 
+/**
+ * @brief 设置图像，接管图像数据，静态模式下也不深拷贝
+ */
+void ImagePlayer::setImage(QImage&& image)
+{
+    m_pInterface->setImage(std::move(image));
+}
+
+void ImagePlayer::setImage(const QString& path)
+{
+    m_pInterface->setImage(path);
+}
+
+void ImagePlayer::setImage(const FloatImage& image)
+{
+    m_pInterface->setImage(image);
+}
+
+bool ImagePlayer::setImage(const RawFrame& frame)
+{
+    return m_pInterface->setImage(frame);
+}
+
+void ImagePlayer::setDisplayWindow(double low, double high)
+{
+    m_pInterface->setDisplayWindow(low, high);
+}
+
+void ImagePlayer::setAutoWindow(bool enabled)
+{
+    m_pInterface->setAutoWindow(enabled);
+}
+
+/**
+ * @brief 设置单通道图像的伪彩色颜色表，为空时恢复灰度显示
+ */
+void ImagePlayer::setColormap(const Colormap& colormap)
+{
+    m_pInterface->setColormap(colormap);
+}
+
+/**
+ * @brief 设置浏览的文件列表并显示其中一张
+ *
+ * @param files 文件列表
+ * @param index 显示的文件序号
+ */
+void ImagePlayer::setImageList(const QStringList& files, int index)
+{
+    m_imageList = files;
+    m_nCurrentIndex = -1;
+    if (m_pImageCache)
+        m_pImageCache->cancelPrefetch();
+    setCurrentIndex(index);
+}
+
+/**
+ * @brief 显示文件列表中的指定图像，并沿浏览方向预取相邻图像
+ *
+ * @param index 文件序号
+ */
+void ImagePlayer::setCurrentIndex(int index)
+{
+    if (index < 0 || index >= m_imageList.size() || index == m_nCurrentIndex)
+        return;
+    const int direction = index >= m_nCurrentIndex ? 1 : -1;
+    m_nCurrentIndex = index;
+    setImage(m_imageList[index]);
+    if (m_pImageCache)
+        m_pImageCache->prefetch(m_imageList, index, direction);
+}
+
+/**
+ * @brief 设置浏览文件夹时使用的图像缓存，默认不使用缓存
+ * @remarks 缓存不归播放器所有，调用者负责其生命周期；
+ * 多个播放器（例如同一视图组中的播放器）可共享同一个缓存，使图像只解码、只占用一份内存。
+ * 共享时任一播放器切换文件列表会取消缓存中尚未开始的预取
+ *
+ * @param cache 图像缓存，为空时直接从文件加载
+ */
+void ImagePlayer::setImageCache(ImageCache* cache)
+{
+    if (cache == m_pImageCache)
+        return;
+    m_pImageCache = cache;
+    m_pInterface->setImageCache(cache);
+}
+
+/**
+ * @brief 以文件夹中的图像作为播放序列
+ * @remarks 播放控制（播放/暂停/跳转/单步/速度）通过 sequencePlayer() 完成，
+ * 建议配合 DynamicMode 使用，由刷新计时器统一绘制
+ *
+ * @param directory 文件夹路径
+ * @return bool 文件夹中是否有图像
+ */
+bool ImagePlayer::setSequence(const QString& directory)
+{
+    return sequencePlayer()->setDirectory(directory);
+}
+
+void ImagePlayer::setSequence(const QStringList& frames)
+{
+    sequencePlayer()->setFrames(frames);
+}
+
+SequencePlayer* ImagePlayer::sequencePlayer()
+{
+    if (m_pSequencePlayer == nullptr)
+    {
+        m_pSequencePlayer = new SequencePlayer(this);
+        connect(m_pSequencePlayer, &SequencePlayer::frameReady, this,
+                [this](const QImage& image) { m_pInterface->setImage(image); });
+    }
+    return m_pSequencePlayer;
+}
+
+/**
+ * @brief 绑定帧源，帧源线程推送的帧合并后在界面线程送入显示
+ * @remarks 未处于 DynamicMode 时切换为 DynamicMode；应在协商格式后绑定，
+ * Bayer 帧在帧源线程转换为 RGB32，转换结果使用显示控件的帧缓冲池。
+ * 不接管帧源的启停与生命周期，帧源析构前应解除绑定
+ *
+ * @param source 帧源，为空时解除绑定
+ */
+void ImagePlayer::bindSource(FrameSource* source)
+{
+    if (m_pSource)
+        m_pSource->setFrameCallback(nullptr);
+    m_pSource = source;
+    if (m_pSource == nullptr)
+        return;
+
+    if (!isDynamicMode())
+        DynamicMode();
+    if (m_pSourceSlot == nullptr)
+        m_pSourceSlot = std::make_shared<SourceFrameSlot>();
+
+    const FrameFormat format = m_pSource->format();
+    auto slot = m_pSourceSlot;
+    m_pSource->setFrameCallback([this, slot, format](const QImage& frame, const FrameInfo& info)
+    {
+        QImage image = frame;
+        if (format.isBayer() && frame.format() == QImage::Format_Grayscale8)
+        {
+            RawFrame raw;
+            raw.data = frame.constBits();
+            raw.width = frame.width();
+            raw.height = frame.height();
+            raw.stride = frame.bytesPerLine();
+            raw.format = format.pixel;
+            // 转换结果写入帧缓冲池中的缓冲，显示释放后归还，稳定运行时不再分配
+            image = m_pInterface->acquireFrame(QSize(raw.width, raw.height), QImage::Format_RGB32);
+            if (!convertToRgb32(raw, image))
+                return;
+        }
+
+        // 界面线程尚未取走上一帧时只替换内容，不重复投递
+        bool post = false;
+        {
+            std::lock_guard<std::mutex> lock(slot->mutex);
+            post = !slot->pending;
+            slot->image = std::move(image);
+            slot->info = info;
+            slot->pending = true;
+        }
+        if (!post)
+            return;
+
+        QMetaObject::invokeMethod(this, [this, slot]
+        {
+            QImage image;
+            FrameInfo info;
+            {
+                std::lock_guard<std::mutex> lock(slot->mutex);
+                image = std::move(slot->image);
+                info = slot->info;
+                slot->image = QImage();
+                slot->pending = false;
+            }
+            if (image.isNull())
+                return;
+            m_pInterface->setFrameInfo(info);
+            m_pInterface->setImage(image);
+        }, Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief 比较两幅图像，显示差值热力图、阈值掩膜或可拖动的分割对比
+ * @remarks 阈值、分割位置与差值统计通过 viewInterface() 设置和获取
+ *
+ * @param a 图像 A（如基准图像）
+ * @param b 图像 B，尺寸需与 A 相同
+ * @return bool 图像为空或尺寸不同时返回 false
+ */
+bool ImagePlayer::setCompareImages(const QImage& a, const QImage& b)
+{
+    return m_pInterface->setCompareImages(a, b);
+}
+
+void ImagePlayer::setCompareMode(CompareMode mode)
+{
+    m_pInterface->setCompareMode(mode);
+}
+
+void ImagePlayer::clearCompare()
+{
+    m_pInterface->clearCompare();
+}
+
+/**
+ * @brief 显示或隐藏直方图面板
+ * @remarks 隐藏时停止统计；统计区域通过 histogramEngine() 设置
+ *
+ * @param visible 是否显示
+ */
+void ImagePlayer::setHistogramVisible(bool visible)
+{
+    HistogramEngine* engine = histogramEngine();
+    m_pHistogramWidget->setVisible(visible);
+    engine->setEnabled(visible);
+}
+
+HistogramEngine* ImagePlayer::histogramEngine()
+{
+    if (m_pHistogramEngine == nullptr)
+    {
+        m_pHistogramEngine = new HistogramEngine(m_pInterface);
+        m_pHistogramWidget = new HistogramWidget(this);
+        m_pHistogramWidget->setFixedHeight(120);
+        m_pHistogramWidget->hide();
+        m_pImageLayout->insertWidget(1, m_pHistogramWidget);
+        connect(m_pHistogramEngine, &HistogramEngine::histogramReady, m_pHistogramWidget, &HistogramWidget::setHistogram);
+    }
+    return m_pHistogramEngine;
+}
+
+/**
+ * @brief 设置显示的邻域原始值网格大小
+ *
+ * @param size 邻域边长（如 5 表示 5x5），0 表示不显示
+ */
+void ImagePlayer::setNeighborhoodSize(int size)
+{
+    m_nNeighborhoodSize = qMax(size, 0);
+    if (m_nNeighborhoodSize > 0 && m_pNeighborhoodLabel == nullptr)
+    {
+        // 与其他信息控件一致，以播放器的父控件为父对象，析构时一并释放
+        m_pNeighborhoodLabel = new QLabel(parentWidget());
+        m_pNeighborhoodLabel->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+        m_pImageLayout->addWidget(m_pNeighborhoodLabel);
+    }
+    if (m_pNeighborhoodLabel)
+        m_pNeighborhoodLabel->setVisible(m_nNeighborhoodSize > 0);
+}
+
+void ImagePlayer::nextImage()
+{
+    setCurrentIndex(m_nCurrentIndex + 1);
+}
+
+void ImagePlayer::previousImage()
+{
+    setCurrentIndex(m_nCurrentIndex - 1);
+}
+
 QPoint ImagePlayer::getImagePosition(const QPoint& pos)
 {
     return m_pInterface->getIamgePosition(pos);
 }
 
+void ImagePlayer::requestPosInfo()
+{
+	if (!m_pPosTimer->isActive())
+		m_pPosTimer->start();
+}
+
 void ImagePlayer::setPosInfo()
 {
 	setPositionInfo(m_pInterface->getPosition(), m_pPosLabel);
-	setColorInfo(m_pInterface->getPositionColor(), m_pRGBLabel);
-	setColorInfo(m_pInterface->getPositionColor(), m_pHSVLabel, QColorType::HSV);
+	const QColor color = m_pInterface->getPositionColor();
+	// 高位深图像显示原始值而不是映射后的颜色；源图像已释放时明确提示没有原始值
+	if (!m_pInterface->hasRawValues())
+		m_pRGBLabel->setText("Value: - (source released)");
+	else if (m_pInterface->isHighBitDepth())
+		setValueInfo(m_pInterface->getPositionValue(), m_pRGBLabel);
+	else
+		setColorInfo(color, m_pRGBLabel);
+	setColorInfo(color, m_pHSVLabel, QColorType::HSV);
+
+	if (m_nNeighborhoodSize > 0)
+	{
+		QVector<double> values;
+		const int size = m_pInterface->getNeighborhoodValues(m_nNeighborhoodSize, values);
+		setNeighborhoodInfo(values, size, m_pNeighborhoodLabel);
+	}
 }
\ No newline at end of file
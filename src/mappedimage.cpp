@@ -0,0 +1,299 @@
+/**
+ * @file mappedimage.cpp
+ * @author ldk
+ * @brief 基于内存映射的无拷贝图像加载
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <climits>
+#include <cstring>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+
+#include "mappedimage.hpp"
+
+namespace
+{
+
+constexpr qint64 PNM_HEADER_SIZE{ 1024 };   // PNM 头部的最大读取长度
+constexpr qint64 BMP_HEADER_SIZE{ 54 };     // BITMAPFILEHEADER + BITMAPINFOHEADER
+constexpr quint32 BMP_BI_RGB{ 0 };          // 未压缩 BMP
+
+struct RawFormat
+{
+    const char*    name;
+    QImage::Format format;
+    int            bytesPerPixel;
+};
+
+const RawFormat RAW_FORMATS[] =
+{
+    { "Grayscale8", QImage::Format_Grayscale8, 1 },
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+    { "Grayscale16", QImage::Format_Grayscale16, 2 },
+#endif
+    { "RGB888", QImage::Format_RGB888, 3 },
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    { "BGR888", QImage::Format_BGR888, 3 },
+#endif
+    { "RGB32", QImage::Format_RGB32, 4 },
+    { "ARGB32", QImage::Format_ARGB32, 4 },
+    { "RGBX8888", QImage::Format_RGBX8888, 4 },
+    { "RGBA8888", QImage::Format_RGBA8888, 4 },
+};
+
+inline quint16 readLE16(const uchar* p)
+{
+    return quint16(p[0] | (p[1] << 8));
+}
+
+inline quint32 readLE32(const uchar* p)
+{
+    return quint32(p[0]) | (quint32(p[1]) << 8) | (quint32(p[2]) << 16) | (quint32(p[3]) << 24);
+}
+
+/* QImage 析构时解除映射：关闭 QFile 会释放其所有映射 */
+void unmapImage(void* info)
+{
+    delete static_cast<QFile*>(info);
+}
+
+/**
+ * @brief 映射文件中的像素数据并包装为 QImage
+ * @remarks file 的所有权转移给返回的 QImage，失败时在此处释放。
+ * 映射地址与文件偏移同余于页大小，多字节像素的偏移或行跨度未对齐时无法直接引用，
+ * 此时从映射中逐行拷贝到对齐的缓冲后立即解除映射，仍省去解码
+ */
+QImage wrapMapped(QFile* file, qint64 offset, int width, int height, int bytesPerLine, QImage::Format format)
+{
+    const int depth = QImage::toPixelFormat(format).bitsPerPixel();
+    const int alignment = depth >= 32 ? 4 : (depth == 16 ? 2 : 1);
+    const qint64 size = qint64(bytesPerLine) * height;
+    const qint64 rowBytes = (qint64(width) * depth + 7) / 8;
+    if (width <= 0 || height <= 0 || bytesPerLine < rowBytes
+        || offset < 0 || offset + size > file->size())
+    {
+        delete file;
+        return QImage();
+    }
+
+    const uchar* data = file->map(offset, size);
+    if (data == nullptr)
+    {
+        delete file;
+        return QImage();
+    }
+
+    if (offset % alignment || bytesPerLine % alignment)
+    {
+        QImage image(width, height, format);
+        if (!image.isNull())
+            for (int y = 0; y < height; ++y)
+                memcpy(image.scanLine(y), data + qint64(y) * bytesPerLine, size_t(rowBytes));
+        delete file;
+        return image;
+    }
+
+    QImage image(data, width, height, bytesPerLine, format, unmapImage, file);
+    // 构造失败时不会调用清理函数
+    if (image.isNull())
+        delete file;
+    return image;
+}
+
+QString sidecarPath(const QString& path)
+{
+    const QString direct = path + ".hdr";
+    if (QFileInfo::exists(direct))
+        return direct;
+    const QFileInfo info(path);
+    const QString sibling = info.absolutePath() + "/" + info.completeBaseName() + ".hdr";
+    if (info.suffix().compare("hdr", Qt::CaseInsensitive) != 0 && QFileInfo::exists(sibling))
+        return sibling;
+    return QString();
+}
+
+QImage loadRaw(const QString& path, const QString& header)
+{
+    QSettings settings(header, QSettings::IniFormat);
+    const int width = settings.value("width").toInt();
+    const int height = settings.value("height").toInt();
+    const QString name = settings.value("format", "Grayscale8").toString();
+
+    const RawFormat* format = nullptr;
+    for (const RawFormat& candidate : RAW_FORMATS)
+        if (name.compare(candidate.name, Qt::CaseInsensitive) == 0)
+            format = &candidate;
+    if (format == nullptr)
+        return QImage();
+
+    const int stride = settings.value("stride", width * format->bytesPerPixel).toInt();
+    const qint64 offset = settings.value("offset", 0).toLongLong();
+
+    QFile* file = new QFile(path);
+    if (!file->open(QIODevice::ReadOnly))
+    {
+        delete file;
+        return QImage();
+    }
+    return wrapMapped(file, offset, width, height, stride, format->format);
+}
+
+/* 读取 PNM 头部中的下一个十进制数，跳过空白与注释 */
+bool readPnmNumber(const QByteArray& header, int& pos, int& value)
+{
+    while (pos < header.size())
+    {
+        const char c = header[pos];
+        if (c == '#')
+        {
+            while (pos < header.size() && header[pos] != '\n')
+                ++pos;
+        }
+        else if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+            ++pos;
+        else
+            break;
+    }
+
+    qint64 number = 0;
+    const int start = pos;
+    while (pos < header.size() && header[pos] >= '0' && header[pos] <= '9' && number <= INT_MAX)
+        number = number * 10 + (header[pos++] - '0');
+    value = int(number);
+    return pos > start && pos < header.size() && number <= INT_MAX;
+}
+
+QImage loadPnm(const QString& path)
+{
+    QFile* file = new QFile(path);
+    if (!file->open(QIODevice::ReadOnly))
+    {
+        delete file;
+        return QImage();
+    }
+
+    const QByteArray header = file->peek(PNM_HEADER_SIZE);
+    int pos = 2, width = 0, height = 0, maxValue = 0;
+    // 仅支持 8 位二进制 PNM，16 位数据为大端序，无法不经转换直接显示
+    if (header.size() < 2 || header[0] != 'P' || (header[1] != '5' && header[1] != '6')
+        || !readPnmNumber(header, pos, width)
+        || !readPnmNumber(header, pos, height)
+        || !readPnmNumber(header, pos, maxValue)
+        || maxValue <= 0 || maxValue > 255)
+    {
+        delete file;
+        return QImage();
+    }
+
+    const bool gray = header[1] == '5';
+    // 最大值后紧跟一个空白字符，随后为像素数据
+    const qint64 offset = pos + 1;
+    return wrapMapped(file, offset, width, height, gray ? width : width * 3,
+                      gray ? QImage::Format_Grayscale8 : QImage::Format_RGB888);
+}
+
+QImage loadBmp(const QString& path)
+{
+    QFile* file = new QFile(path);
+    if (!file->open(QIODevice::ReadOnly))
+    {
+        delete file;
+        return QImage();
+    }
+
+    const QByteArray bytes = file->peek(BMP_HEADER_SIZE);
+    const uchar* header = reinterpret_cast<const uchar*>(bytes.constData());
+    if (bytes.size() < BMP_HEADER_SIZE || header[0] != 'B' || header[1] != 'M')
+    {
+        delete file;
+        return QImage();
+    }
+
+    const quint32 offset = readLE32(header + 10);
+    const quint32 infoSize = readLE32(header + 14);
+    const qint32 width = qint32(readLE32(header + 18));
+    const qint32 height = qint32(readLE32(header + 22));
+    const quint16 bitCount = readLE16(header + 28);
+    const quint32 compression = readLE32(header + 30);
+    const quint32 colorsUsed = readLE32(header + 46);
+
+    // 自底向上存储的 BMP 无法以正向行跨度直接引用，交由解码器处理
+    QImage::Format format = QImage::Format_Invalid;
+    if (infoSize >= 40 && width > 0 && height < 0 && compression == BMP_BI_RGB)
+    {
+        switch (bitCount)
+        {
+        case 8:
+        {
+            // 仅当调色板为灰度恒等映射时才能作为 Grayscale8 直接显示
+            const quint32 colors = colorsUsed == 0 ? 256 : colorsUsed;
+            const QByteArray palette = file->peek(14 + qint64(infoSize) + 4 * colors).mid(14 + infoSize);
+            bool identity = colors == 256 && palette.size() == 4 * 256;
+            for (int i = 0; identity && i < 256; ++i)
+                identity = uchar(palette[4 * i]) == i && uchar(palette[4 * i + 1]) == i && uchar(palette[4 * i + 2]) == i;
+            if (identity)
+                format = QImage::Format_Grayscale8;
+            break;
+        }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        case 24:
+            format = QImage::Format_BGR888;
+            break;
+#endif
+        case 32:
+            format = QImage::Format_RGB32;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (format == QImage::Format_Invalid)
+    {
+        delete file;
+        return QImage();
+    }
+
+    const int bytesPerLine = ((width * bitCount + 31) / 32) * 4;
+    return wrapMapped(file, offset, width, -height, bytesPerLine, format);
+}
+
+} // namespace
+
+MappedImageType mappedImageType(const QString& path)
+{
+    if (!sidecarPath(path).isEmpty())
+        return MappedImageType::Raw;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return MappedImageType::None;
+    const QByteArray magic = file.read(2);
+    if (magic == "P5" || magic == "P6")
+        return MappedImageType::PNM;
+    if (magic == "BM")
+        return MappedImageType::BMP;
+    return MappedImageType::None;
+}
+
+QImage loadMappedImage(const QString& path)
+{
+    switch (mappedImageType(path))
+    {
+    case MappedImageType::Raw:
+        return loadRaw(path, sidecarPath(path));
+    case MappedImageType::PNM:
+        return loadPnm(path);
+    case MappedImageType::BMP:
+        return loadBmp(path);
+    default:
+        return QImage();
+    }
+}
@@ -0,0 +1,396 @@
+/**
+ * @file overlayitem.cpp
+ * @author ldk
+ * @brief 批量绘制检测框、轮廓与标签的叠加层
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <limits>
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+#include "overlayitem.hpp"
+
+namespace
+{
+
+constexpr int SHAPES_PER_CELL{ 4 };  // 网格每格平均的形状数
+constexpr int MAX_GRID_SIZE{ 512 };  // 网格每边的最大格数
+
+double segmentDistance(const QPointF& p, const QPointF& a, const QPointF& b)
+{
+    const QPointF ab = b - a;
+    const double length = QPointF::dotProduct(ab, ab);
+    const double t = length > 0. ? qBound(0., QPointF::dotProduct(p - a, ab) / length, 1.) : 0.;
+    const QPointF d = p - (a + t * ab);
+    return std::sqrt(QPointF::dotProduct(d, d));
+}
+
+/* 线段的包围盒，宽高可以为 0 */
+QRectF lineBounds(const QLineF& line)
+{
+    return QRectF(line.p1(), line.p2()).normalized();
+}
+
+/* 合并包围盒，QRectF 的 | 运算会忽略宽或高为 0 的矩形 */
+void unite(QRectF& bounds, bool& empty, const QRectF& rect)
+{
+    if (empty)
+    {
+        bounds = rect;
+        empty = false;
+        return;
+    }
+    const double left = std::min(bounds.left(), rect.left());
+    const double top = std::min(bounds.top(), rect.top());
+    const double right = std::max(bounds.right(), rect.right());
+    const double bottom = std::max(bounds.bottom(), rect.bottom());
+    bounds.setCoords(left, top, right, bottom);
+}
+
+/* 允许宽高为 0 的相交判断 */
+bool overlaps(const QRectF& a, const QRectF& b)
+{
+    return a.left() <= b.right() && b.left() <= a.right() && a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+} // namespace
+
+int OverlayFrame::addPen(const QPen& pen)
+{
+    pens.append(pen);
+    pens.last().setCosmetic(true);
+    return pens.size() - 1;
+}
+
+void OverlayFrame::addRect(const QRectF& rect, int pen)
+{
+    rects.append(rect);
+    rectPens.append(pen);
+}
+
+void OverlayFrame::addLine(const QLineF& line, int pen)
+{
+    lines.append(line);
+    linePens.append(pen);
+}
+
+void OverlayFrame::addPolyline(const QPointF* points, int count, int pen)
+{
+    polylineStarts.append(polylinePoints.size());
+    polylinePens.append(pen);
+    for (int i = 0; i < count; ++i)
+        polylinePoints.append(points[i]);
+}
+
+void OverlayFrame::addLabel(const QPointF& position, const QString& text, int pen)
+{
+    labelPositions.append(position);
+    labels.append(text);
+    labelPens.append(pen);
+}
+
+void OverlayFrame::reserve(int rectCount, int lineCount, int polylineCount, int labelCount)
+{
+    rects.reserve(rectCount);
+    rectPens.reserve(rectCount);
+    lines.reserve(lineCount);
+    linePens.reserve(lineCount);
+    polylineStarts.reserve(polylineCount);
+    polylinePens.reserve(polylineCount);
+    labelPositions.reserve(labelCount);
+    labels.reserve(labelCount);
+    labelPens.reserve(labelCount);
+}
+
+/* 清空形状，保留画笔表与已分配的内存 */
+void OverlayFrame::clear()
+{
+    rects.resize(0);
+    rectPens.resize(0);
+    lines.resize(0);
+    linePens.resize(0);
+    polylinePoints.resize(0);
+    polylineStarts.resize(0);
+    polylinePens.resize(0);
+    labelPositions.resize(0);
+    labels.clear();
+    labelPens.resize(0);
+}
+
+OverlayItem::OverlayItem(QGraphicsItem* parent)
+    : QGraphicsItem(parent)
+    , m_bGridDirty(true)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    setZValue(1);
+}
+
+/**
+ * @brief 设置一帧的形状，按画笔分组并计算包围盒
+ * @remarks 画笔下标越界的形状使用默认画笔
+ */
+void OverlayItem::setFrame(OverlayFrame frame)
+{
+    m_Frame = std::move(frame);
+    if (m_Frame.pens.isEmpty())
+        m_Frame.addPen(QPen(Qt::green));
+    buildBatches();
+    m_bGridDirty = true;
+    update();
+}
+
+void OverlayItem::buildBatches()
+{
+    const OverlayFrame& frame = m_Frame;
+    const int penCount = frame.pens.size();
+    auto batch = [this, penCount](int pen) -> Batch& { return m_batches[pen >= 0 && pen < penCount ? pen : 0]; };
+
+    // 保留上一帧各组的内存
+    m_batches.resize(penCount);
+    for (Batch& b : m_batches)
+    {
+        b.rects.resize(0);
+        b.lines.resize(0);
+        b.labels.resize(0);
+    }
+
+    QRectF bounds;
+    bool empty = true;
+    for (int i = 0; i < frame.rects.size(); ++i)
+    {
+        batch(frame.rectPens.value(i)).rects.append(frame.rects[i]);
+        unite(bounds, empty, frame.rects[i].normalized());
+    }
+    for (int i = 0; i < frame.lines.size(); ++i)
+    {
+        batch(frame.linePens.value(i)).lines.append(frame.lines[i]);
+        unite(bounds, empty, lineBounds(frame.lines[i]));
+    }
+    for (int i = 0; i < frame.polylineStarts.size(); ++i)
+    {
+        Batch& b = batch(frame.polylinePens.value(i));
+        const int first = frame.polylineStarts[i];
+        const int last = i + 1 < frame.polylineStarts.size() ? frame.polylineStarts[i + 1] : frame.polylinePoints.size();
+        for (int p = first + 1; p < last; ++p)
+            b.lines.append(QLineF(frame.polylinePoints[p - 1], frame.polylinePoints[p]));
+        if (last > first)
+            unite(bounds, empty, QPolygonF(frame.polylinePoints.mid(first, last - first)).boundingRect());
+    }
+    for (int i = 0; i < frame.labels.size(); ++i)
+    {
+        batch(frame.labelPens.value(i)).labels.append(i);
+        unite(bounds, empty, QRectF(frame.labelPositions[i], QSizeF(0, 0)));
+    }
+    m_bounds = bounds;
+}
+
+/* 覆盖整个场景，cosmetic 线宽与标签文字在任意缩放下都不会超出 */
+QRectF OverlayItem::boundingRect() const
+{
+    return QRectF(INT_MIN / 2, INT_MIN / 2, INT_MAX, INT_MAX);
+}
+
+void OverlayItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(widget);
+    if (m_Frame.shapeCount() == 0)
+        return;
+
+    const QRectF exposed = option->exposedRect;
+    const bool cull = !exposed.contains(m_bounds);
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    painter->setBrush(Qt::NoBrush);
+
+    for (int pen = 0; pen < int(m_batches.size()); ++pen)
+    {
+        const Batch& batch = m_batches[pen];
+        if (batch.rects.isEmpty() && batch.lines.isEmpty())
+            continue;
+        painter->setPen(m_Frame.pens[pen]);
+        if (!cull)
+        {
+            painter->drawRects(batch.rects);
+            painter->drawLines(batch.lines);
+            continue;
+        }
+
+        m_visibleRects.resize(0);
+        for (const QRectF& rect : batch.rects)
+            if (overlaps(rect.normalized(), exposed))
+                m_visibleRects.append(rect);
+        m_visibleLines.resize(0);
+        for (const QLineF& line : batch.lines)
+            if (overlaps(lineBounds(line), exposed))
+                m_visibleLines.append(line);
+        painter->drawRects(m_visibleRects);
+        painter->drawLines(m_visibleLines);
+    }
+
+    // 标签在设备坐标系下绘制，字号不随缩放变化
+    const QTransform transform = painter->worldTransform();
+    painter->save();
+    painter->resetTransform();
+    for (int pen = 0; pen < int(m_batches.size()); ++pen)
+    {
+        const Batch& batch = m_batches[pen];
+        if (batch.labels.isEmpty())
+            continue;
+        painter->setPen(m_Frame.pens[pen].color());
+        for (int i : batch.labels)
+        {
+            const QPointF& position = m_Frame.labelPositions[i];
+            if (exposed.contains(position))
+                painter->drawText(transform.map(position), m_Frame.labels[i]);
+        }
+    }
+    painter->restore();
+}
+
+/**
+ * @brief 命中测试，返回距离最近的形状，距离相同时返回后绘制的形状
+ * @remarks 点在矩形内部时距离为 0
+ *
+ * @param position 图像坐标
+ * @param tolerance 允许的距离（图像坐标）
+ * @return OverlayHit 没有命中时 kind 为 None
+ */
+OverlayHit OverlayItem::hitTest(const QPointF& position, double tolerance) const
+{
+    OverlayHit hit;
+    if (m_Frame.shapeCount() == 0)
+        return hit;
+    if (m_bGridDirty)
+        buildGrid();
+
+    const QRectF area(position.x() - tolerance, position.y() - tolerance, 2 * tolerance, 2 * tolerance);
+    if (!overlaps(area, m_grid.bounds))
+        return hit;
+
+    auto column = [this](double x) { return qBound(0, int((x - m_grid.bounds.left()) / m_grid.cellWidth), m_grid.columns - 1); };
+    auto row = [this](double y) { return qBound(0, int((y - m_grid.bounds.top()) / m_grid.cellHeight), m_grid.rows - 1); };
+
+    int best = -1;
+    double bestDistance = std::numeric_limits<double>::max();
+    for (int r = row(area.top()); r <= row(area.bottom()); ++r)
+    {
+        for (int c = column(area.left()); c <= column(area.right()); ++c)
+        {
+            const int cell = r * m_grid.columns + c;
+            for (int e = m_grid.offsets[cell]; e < m_grid.offsets[cell + 1]; ++e)
+            {
+                const int id = m_grid.entries[e];
+                const double distance = shapeDistance(id, position);
+                if (distance <= tolerance && (distance < bestDistance || (distance == bestDistance && id > best)))
+                {
+                    best = id;
+                    bestDistance = distance;
+                }
+            }
+        }
+    }
+    if (best < 0)
+        return hit;
+
+    const int rectEnd = m_Frame.rects.size();
+    const int lineEnd = rectEnd + m_Frame.lines.size();
+    const int polylineEnd = lineEnd + m_Frame.polylineStarts.size();
+    if (best < rectEnd)
+        hit = OverlayHit{ OverlayHit::Rect, best };
+    else if (best < lineEnd)
+        hit = OverlayHit{ OverlayHit::Line, best - rectEnd };
+    else if (best < polylineEnd)
+        hit = OverlayHit{ OverlayHit::Polyline, best - lineEnd };
+    else
+        hit = OverlayHit{ OverlayHit::Label, best - polylineEnd };
+    return hit;
+}
+
+/* 按形状数确定网格尺寸，两遍扫描构建压缩的格子列表 */
+void OverlayItem::buildGrid() const
+{
+    m_bGridDirty = false;
+    const int count = m_Frame.shapeCount();
+    const int size = qBound(1, int(std::sqrt(double(count) / SHAPES_PER_CELL)), MAX_GRID_SIZE);
+    m_grid.bounds = m_bounds;
+    m_grid.columns = size;
+    m_grid.rows = size;
+    m_grid.cellWidth = std::max(m_bounds.width() / size, 1e-6);
+    m_grid.cellHeight = std::max(m_bounds.height() / size, 1e-6);
+    m_grid.offsets.fill(0, size * size + 1);
+
+    auto forEachCell = [this](const QRectF& bounds, auto&& function)
+    {
+        const int c0 = qBound(0, int((bounds.left() - m_grid.bounds.left()) / m_grid.cellWidth), m_grid.columns - 1);
+        const int c1 = qBound(0, int((bounds.right() - m_grid.bounds.left()) / m_grid.cellWidth), m_grid.columns - 1);
+        const int r0 = qBound(0, int((bounds.top() - m_grid.bounds.top()) / m_grid.cellHeight), m_grid.rows - 1);
+        const int r1 = qBound(0, int((bounds.bottom() - m_grid.bounds.top()) / m_grid.cellHeight), m_grid.rows - 1);
+        for (int r = r0; r <= r1; ++r)
+            for (int c = c0; c <= c1; ++c)
+                function(r * m_grid.columns + c);
+    };
+
+    for (int id = 0; id < count; ++id)
+        forEachCell(shapeBounds(id), [this](int cell) { ++m_grid.offsets[cell + 1]; });
+    for (int cell = 0; cell < size * size; ++cell)
+        m_grid.offsets[cell + 1] += m_grid.offsets[cell];
+
+    m_grid.entries.resize(m_grid.offsets.last());
+    QVector<int> cursor = m_grid.offsets;
+    for (int id = 0; id < count; ++id)
+        forEachCell(shapeBounds(id), [this, &cursor, id](int cell) { m_grid.entries[cursor[cell]++] = id; });
+}
+
+QRectF OverlayItem::shapeBounds(int id) const
+{
+    if (id < m_Frame.rects.size())
+        return m_Frame.rects[id].normalized();
+    id -= m_Frame.rects.size();
+    if (id < m_Frame.lines.size())
+        return lineBounds(m_Frame.lines[id]);
+    id -= m_Frame.lines.size();
+    if (id < m_Frame.polylineStarts.size())
+    {
+        const int first = m_Frame.polylineStarts[id];
+        const int last = id + 1 < m_Frame.polylineStarts.size() ? m_Frame.polylineStarts[id + 1] : m_Frame.polylinePoints.size();
+        return QPolygonF(m_Frame.polylinePoints.mid(first, last - first)).boundingRect();
+    }
+    id -= m_Frame.polylineStarts.size();
+    return QRectF(m_Frame.labelPositions[id], QSizeF(0, 0));
+}
+
+double OverlayItem::shapeDistance(int id, const QPointF& position) const
+{
+    if (id < m_Frame.rects.size())
+    {
+        const QRectF rect = m_Frame.rects[id].normalized();
+        const double dx = std::max({ rect.left() - position.x(), 0., position.x() - rect.right() });
+        const double dy = std::max({ rect.top() - position.y(), 0., position.y() - rect.bottom() });
+        return std::sqrt(dx * dx + dy * dy);
+    }
+    id -= m_Frame.rects.size();
+    if (id < m_Frame.lines.size())
+        return segmentDistance(position, m_Frame.lines[id].p1(), m_Frame.lines[id].p2());
+    id -= m_Frame.lines.size();
+    if (id < m_Frame.polylineStarts.size())
+    {
+        const int first = m_Frame.polylineStarts[id];
+        const int last = id + 1 < m_Frame.polylineStarts.size() ? m_Frame.polylineStarts[id + 1] : m_Frame.polylinePoints.size();
+        double distance = std::numeric_limits<double>::max();
+        for (int p = first + 1; p < last; ++p)
+            distance = std::min(distance, segmentDistance(position, m_Frame.polylinePoints[p - 1], m_Frame.polylinePoints[p]));
+        if (last - first == 1)
+            distance = segmentDistance(position, m_Frame.polylinePoints[first], m_Frame.polylinePoints[first]);
+        return distance;
+    }
+    id -= m_Frame.polylineStarts.size();
+    return segmentDistance(position, m_Frame.labelPositions[id], m_Frame.labelPositions[id]);
+}
@@ -0,0 +1,572 @@
+/**
+ * @file pixelconvert.cpp
+ * @author ldk
+ * @brief 相机像素格式（Bayer / YUV / Mono）到 RGB32 的转换
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <array>
+
+#include "pixelconvert.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+
+/*
+ * RGB32 在小端机器上的内存布局为 B G R A，以下内核均按字节写出 B G R 0xFF。
+ */
+
+namespace
+{
+
+constexpr int ROW_GRAIN{ 16 };  // 并行时每段的最小行数
+
+inline uchar average(uchar a, uchar b)
+{
+    // 与 SIMD 的 avg 指令一致，向上取整
+    return uchar((a + b + 1) >> 1);
+}
+
+inline uchar clip8(int value)
+{
+    return uchar(std::clamp(value, 0, 255));
+}
+
+inline void storeBgra(uchar* dst, uchar b, uchar g, uchar r)
+{
+    dst[0] = b;
+    dst[1] = g;
+    dst[2] = r;
+    dst[3] = 0xFF;
+}
+
+/* 16 个 8 位像素的向量运算 */
+#if defined(QTTOOLS_SSE2)
+
+#define QTTOOLS_U8X16
+using U8x16 = __m128i;
+
+inline U8x16 load16(const uchar* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline U8x16 average16(U8x16 a, U8x16 b) { return _mm_avg_epu8(a, b); }
+inline U8x16 evenMask16() { return _mm_set1_epi16(0x00FF); }
+
+inline U8x16 select16(U8x16 mask, U8x16 a, U8x16 b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/* 将三个通道交错写出为 16 个 BGRA 像素 */
+inline void storeBgra16(uchar* dst, U8x16 b, U8x16 g, U8x16 r)
+{
+    const __m128i a = _mm_set1_epi8(char(0xFF));
+    const __m128i bgLo = _mm_unpacklo_epi8(b, g);
+    const __m128i bgHi = _mm_unpackhi_epi8(b, g);
+    const __m128i raLo = _mm_unpacklo_epi8(r, a);
+    const __m128i raHi = _mm_unpackhi_epi8(r, a);
+    __m128i* out = reinterpret_cast<__m128i*>(dst);
+    _mm_storeu_si128(out, _mm_unpacklo_epi16(bgLo, raLo));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(bgLo, raLo));
+    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(bgHi, raHi));
+    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(bgHi, raHi));
+}
+
+/**
+ * @brief 8 个像素的 YUV 到 BGRA 转换，分量为 16 位整数
+ * @remarks 系数放大 64 倍的定点运算，饱和加减只会发生在结果超过 255 时，与标量实现结果一致
+ */
+inline void yuvToBgra8(__m128i y, __m128i u, __m128i v, uchar* dst)
+{
+    const __m128i c = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(y, _mm_set1_epi16(16)), _mm_set1_epi16(75)),
+                                    _mm_set1_epi16(32));
+    const __m128i d = _mm_sub_epi16(u, _mm_set1_epi16(128));
+    const __m128i e = _mm_sub_epi16(v, _mm_set1_epi16(128));
+    const __m128i r = _mm_srai_epi16(_mm_adds_epi16(c, _mm_mullo_epi16(e, _mm_set1_epi16(102))), 6);
+    const __m128i g = _mm_srai_epi16(_mm_subs_epi16(_mm_subs_epi16(c, _mm_mullo_epi16(d, _mm_set1_epi16(25))),
+                                                    _mm_mullo_epi16(e, _mm_set1_epi16(52))), 6);
+    const __m128i b = _mm_srai_epi16(_mm_adds_epi16(c, _mm_mullo_epi16(d, _mm_set1_epi16(129))), 6);
+
+    const __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(g, g));
+    const __m128i ra = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), _mm_set1_epi8(char(0xFF)));
+    __m128i* out = reinterpret_cast<__m128i*>(dst);
+    _mm_storeu_si128(out, _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(bg, ra));
+}
+
+/* 将交错的 U V 分量（各 4 个）扩展为每像素的 U、V（各 8 个） */
+inline void expandChroma(__m128i uv, __m128i& u, __m128i& v)
+{
+    const __m128i lowU = _mm_and_si128(uv, _mm_set1_epi32(0xFFFF));
+    const __m128i lowV = _mm_srli_epi32(uv, 16);
+    u = _mm_or_si128(lowU, _mm_slli_epi32(lowU, 16));
+    v = _mm_or_si128(lowV, _mm_slli_epi32(lowV, 16));
+}
+
+#elif defined(QTTOOLS_NEON)
+
+#define QTTOOLS_U8X16
+using U8x16 = uint8x16_t;
+
+inline U8x16 load16(const uchar* p) { return vld1q_u8(p); }
+inline U8x16 average16(U8x16 a, U8x16 b) { return vrhaddq_u8(a, b); }
+inline U8x16 evenMask16() { return vreinterpretq_u8_u16(vdupq_n_u16(0x00FF)); }
+inline U8x16 select16(U8x16 mask, U8x16 a, U8x16 b) { return vbslq_u8(mask, a, b); }
+
+inline void storeBgra16(uchar* dst, U8x16 b, U8x16 g, U8x16 r)
+{
+    const uint8x16x4_t pixels{ { b, g, r, vdupq_n_u8(0xFF) } };
+    vst4q_u8(dst, pixels);
+}
+
+inline void yuvToBgra8(uint8x8_t y8, uint8x8_t u8, uint8x8_t v8, uchar* dst)
+{
+    const int16x8_t y = vreinterpretq_s16_u16(vmovl_u8(y8));
+    const int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u8)), vdupq_n_s16(128));
+    const int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v8)), vdupq_n_s16(128));
+    const int16x8_t c = vaddq_s16(vmulq_n_s16(vsubq_s16(y, vdupq_n_s16(16)), 75), vdupq_n_s16(32));
+    const int16x8_t r = vshrq_n_s16(vqaddq_s16(c, vmulq_n_s16(e, 102)), 6);
+    const int16x8_t g = vshrq_n_s16(vqsubq_s16(vqsubq_s16(c, vmulq_n_s16(d, 25)), vmulq_n_s16(e, 52)), 6);
+    const int16x8_t b = vshrq_n_s16(vqaddq_s16(c, vmulq_n_s16(d, 129)), 6);
+    const uint8x8x4_t pixels{ { vqmovun_s16(b), vqmovun_s16(g), vqmovun_s16(r), vdup_n_u8(0xFF) } };
+    vst4_u8(dst, pixels);
+}
+
+/* 将交错的 U V 分量（各 4 个）扩展为每像素的 U、V（各 8 个） */
+inline void expandChroma(uint8x8_t uv, uint8x8_t& u, uint8x8_t& v)
+{
+    const uint8x8x2_t split = vuzp_u8(uv, uv);
+    u = vzip_u8(split.val[0], split.val[0]).val[0];
+    v = vzip_u8(split.val[1], split.val[1]).val[0];
+}
+
+#endif
+
+/* 32 个 8 位像素的向量运算，未对齐的尾部交给 16 像素内核 */
+#if defined(QTTOOLS_AVX2)
+
+using U8x32 = __m256i;
+
+inline U8x32 load32(const uchar* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+inline U8x32 average32(U8x32 a, U8x32 b) { return _mm256_avg_epu8(a, b); }
+inline U8x32 evenMask32() { return _mm256_set1_epi16(0x00FF); }
+inline U8x32 select32(U8x32 mask, U8x32 a, U8x32 b) { return _mm256_blendv_epi8(b, a, mask); }
+
+/* 将三个通道交错写出为 32 个 BGRA 像素，unpack 只在 128 位内交错，写出前交换两半 */
+inline void storeBgra32(uchar* dst, U8x32 b, U8x32 g, U8x32 r)
+{
+    const __m256i a = _mm256_set1_epi8(char(0xFF));
+    const __m256i bgLo = _mm256_unpacklo_epi8(b, g);
+    const __m256i bgHi = _mm256_unpackhi_epi8(b, g);
+    const __m256i raLo = _mm256_unpacklo_epi8(r, a);
+    const __m256i raHi = _mm256_unpackhi_epi8(r, a);
+    const __m256i p0 = _mm256_unpacklo_epi16(bgLo, raLo);   // 像素 0-3, 16-19
+    const __m256i p1 = _mm256_unpackhi_epi16(bgLo, raLo);   // 像素 4-7, 20-23
+    const __m256i p2 = _mm256_unpacklo_epi16(bgHi, raHi);   // 像素 8-11, 24-27
+    const __m256i p3 = _mm256_unpackhi_epi16(bgHi, raHi);   // 像素 12-15, 28-31
+    __m256i* out = reinterpret_cast<__m256i*>(dst);
+    _mm256_storeu_si256(out, _mm256_permute2x128_si256(p0, p1, 0x20));
+    _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(p2, p3, 0x20));
+    _mm256_storeu_si256(out + 2, _mm256_permute2x128_si256(p0, p1, 0x31));
+    _mm256_storeu_si256(out + 3, _mm256_permute2x128_si256(p2, p3, 0x31));
+}
+
+#endif
+
+/* 与 SIMD 实现相同的定点 BT.601 转换 */
+inline void yuvPixel(int y, int u, int v, uchar* dst)
+{
+    const int c = (y - 16) * 75 + 32;
+    const int d = u - 128;
+    const int e = v - 128;
+    storeBgra(dst, clip8((c + d * 129) >> 6), clip8((c - d * 25 - e * 52) >> 6), clip8((c + e * 102) >> 6));
+}
+
+/* ---------------------------------- Mono8 ---------------------------------- */
+
+/**
+ * @brief 转换一行 Mono8 数据
+ *
+ * @param lut 可选的 256 项灰度查找表
+ * @param table 由 lut 展开的 BGRA 查找表，lut 为空时为空
+ */
+void monoRow(const uchar* src, uchar* dst, int width, const uchar* lut, const quint32* table)
+{
+    int x = 0;
+    if (table)
+    {
+#if defined(QTTOOLS_AVX2)
+        // 8 路 gather 直接取出展开后的 BGRA 像素
+        for (; x + 8 <= width; x += 8)
+        {
+            const __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + x)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 4 * x),
+                                _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, 4));
+        }
+#elif defined(QTTOOLS_NEON)
+        // 4 个 64 字节的表覆盖 256 项，超出当前表范围的索引保留之前查得的值
+        const uint8x16x4_t t0{ { vld1q_u8(lut), vld1q_u8(lut + 16), vld1q_u8(lut + 32), vld1q_u8(lut + 48) } };
+        const uint8x16x4_t t1{ { vld1q_u8(lut + 64), vld1q_u8(lut + 80), vld1q_u8(lut + 96), vld1q_u8(lut + 112) } };
+        const uint8x16x4_t t2{ { vld1q_u8(lut + 128), vld1q_u8(lut + 144), vld1q_u8(lut + 160), vld1q_u8(lut + 176) } };
+        const uint8x16x4_t t3{ { vld1q_u8(lut + 192), vld1q_u8(lut + 208), vld1q_u8(lut + 224), vld1q_u8(lut + 240) } };
+        const uint8x16_t step = vdupq_n_u8(64);
+        for (; x + 16 <= width; x += 16)
+        {
+            uint8x16_t index = vld1q_u8(src + x);
+            uint8x16_t gray = vqtbl4q_u8(t0, index);
+            index = vsubq_u8(index, step);
+            gray = vqtbx4q_u8(gray, t1, index);
+            index = vsubq_u8(index, step);
+            gray = vqtbx4q_u8(gray, t2, index);
+            index = vsubq_u8(index, step);
+            gray = vqtbx4q_u8(gray, t3, index);
+            storeBgra16(dst + 4 * x, gray, gray, gray);
+        }
+#else
+        // SSE2 没有字节重排指令，逐像素查 BGRA 表
+        Q_UNUSED(lut);
+#endif
+        quint32* out = reinterpret_cast<quint32*>(dst);
+        for (; x < width; ++x)
+            out[x] = table[src[x]];
+        return;
+    }
+#if defined(QTTOOLS_AVX2)
+    for (; x + 32 <= width; x += 32)
+    {
+        const U8x32 gray = load32(src + x);
+        storeBgra32(dst + 4 * x, gray, gray, gray);
+    }
+#endif
+#if defined(QTTOOLS_U8X16)
+    for (; x + 16 <= width; x += 16)
+    {
+        const U8x16 gray = load16(src + x);
+        storeBgra16(dst + 4 * x, gray, gray, gray);
+    }
+#endif
+    for (; x < width; ++x)
+        storeBgra(dst + 4 * x, src[x], src[x], src[x]);
+}
+
+/* ---------------------------------- Bayer ---------------------------------- */
+
+/* Bayer 阵列中像素的颜色，绿色按所在行区分 */
+enum class BayerColor
+{
+    Red,
+    GreenR,     // 与红色同行的绿色
+    GreenB,     // 与蓝色同行的绿色
+    Blue
+};
+
+/**
+ * @brief 双线性插值
+ * C 为中心值，H 为左右均值，V 为上下均值，X 为四邻域均值，D 为对角均值
+ */
+template <typename T>
+inline void bayerChannels(BayerColor color, T C, T H, T V, T X, T D, T& r, T& g, T& b)
+{
+    switch (color)
+    {
+    case BayerColor::Red:
+        r = C; g = X; b = D;
+        break;
+    case BayerColor::GreenR:
+        r = H; g = C; b = V;
+        break;
+    case BayerColor::GreenB:
+        r = V; g = C; b = H;
+        break;
+    case BayerColor::Blue:
+        r = D; g = X; b = C;
+        break;
+    }
+}
+
+/* 各格式 2x2 单元的颜色 */
+void bayerPattern(PixelFormat format, BayerColor pattern[2][2])
+{
+    using C = BayerColor;
+    switch (format)
+    {
+    case PixelFormat::BayerGR8:
+        pattern[0][0] = C::GreenR; pattern[0][1] = C::Red; pattern[1][0] = C::Blue; pattern[1][1] = C::GreenB;
+        break;
+    case PixelFormat::BayerGB8:
+        pattern[0][0] = C::GreenB; pattern[0][1] = C::Blue; pattern[1][0] = C::Red; pattern[1][1] = C::GreenR;
+        break;
+    case PixelFormat::BayerBG8:
+        pattern[0][0] = C::Blue; pattern[0][1] = C::GreenB; pattern[1][0] = C::GreenR; pattern[1][1] = C::Red;
+        break;
+    default:
+        pattern[0][0] = C::Red; pattern[0][1] = C::GreenR; pattern[1][0] = C::GreenB; pattern[1][1] = C::Blue;
+        break;
+    }
+}
+
+/**
+ * @brief 转换一行 Bayer 数据
+ * @remarks 边界按镜像处理以保持颜色相位，up/down 已由调用方镜像
+ *
+ * @param colors 该行偶数列与奇数列的颜色
+ */
+inline void bayerPixel(const uchar* up, const uchar* row, const uchar* down, uchar* dst, int width,
+                       const BayerColor colors[2], int x)
+{
+    const int l = x > 0 ? x - 1 : 1;
+    const int r = x < width - 1 ? x + 1 : width - 2;
+    const uchar C = row[x];
+    const uchar H = average(row[l], row[r]);
+    const uchar V = average(up[x], down[x]);
+    const uchar X = average(H, V);
+    const uchar D = average(average(up[l], up[r]), average(down[l], down[r]));
+    uchar red, green, blue;
+    bayerChannels(colors[x & 1], C, H, V, X, D, red, green, blue);
+    storeBgra(dst + 4 * x, blue, green, red);
+}
+
+void bayerRow(const uchar* up, const uchar* row, const uchar* down, uchar* dst, int width, const BayerColor colors[2])
+{
+    int x = 0;
+    for (; x < std::min(2, width); ++x)
+        bayerPixel(up, row, down, dst, width, colors, x);
+    // 从偶数列开始，使向量的偶数通道对应偶数列
+#if defined(QTTOOLS_AVX2)
+    const U8x32 even32 = evenMask32();
+    for (; x + 33 <= width; x += 32)
+    {
+        const U8x32 C = load32(row + x);
+        const U8x32 H = average32(load32(row + x - 1), load32(row + x + 1));
+        const U8x32 V = average32(load32(up + x), load32(down + x));
+        const U8x32 X = average32(H, V);
+        const U8x32 D = average32(average32(load32(up + x - 1), load32(up + x + 1)),
+                                  average32(load32(down + x - 1), load32(down + x + 1)));
+        U8x32 rEven, gEven, bEven, rOdd, gOdd, bOdd;
+        bayerChannels(colors[0], C, H, V, X, D, rEven, gEven, bEven);
+        bayerChannels(colors[1], C, H, V, X, D, rOdd, gOdd, bOdd);
+        storeBgra32(dst + 4 * x, select32(even32, bEven, bOdd), select32(even32, gEven, gOdd),
+                    select32(even32, rEven, rOdd));
+    }
+#endif
+#if defined(QTTOOLS_U8X16)
+    const U8x16 even = evenMask16();
+    for (; x + 17 <= width; x += 16)
+    {
+        const U8x16 C = load16(row + x);
+        const U8x16 H = average16(load16(row + x - 1), load16(row + x + 1));
+        const U8x16 V = average16(load16(up + x), load16(down + x));
+        const U8x16 X = average16(H, V);
+        const U8x16 D = average16(average16(load16(up + x - 1), load16(up + x + 1)),
+                                  average16(load16(down + x - 1), load16(down + x + 1)));
+        U8x16 rEven, gEven, bEven, rOdd, gOdd, bOdd;
+        bayerChannels(colors[0], C, H, V, X, D, rEven, gEven, bEven);
+        bayerChannels(colors[1], C, H, V, X, D, rOdd, gOdd, bOdd);
+        storeBgra16(dst + 4 * x, select16(even, bEven, bOdd), select16(even, gEven, gOdd), select16(even, rEven, rOdd));
+    }
+#endif
+    for (; x < width; ++x)
+        bayerPixel(up, row, down, dst, width, colors, x);
+}
+
+/* ----------------------------------- YUV ----------------------------------- */
+
+/**
+ * @brief 转换一行 4:2:2 打包数据
+ *
+ * @param yFirst 字节顺序是否为 Y U Y V（否则为 U Y V Y）
+ */
+void packedYuvRow(const uchar* src, uchar* dst, int width, bool yFirst)
+{
+    const int yOffset = yFirst ? 0 : 1;
+    const int uOffset = yFirst ? 1 : 0;
+    int x = 0;
+#if defined(QTTOOLS_SSE2)
+    const __m128i low = _mm_set1_epi16(0x00FF);
+    for (; x + 8 <= width; x += 8)
+    {
+        const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * x));
+        const __m128i y = yFirst ? _mm_and_si128(packed, low) : _mm_srli_epi16(packed, 8);
+        const __m128i uv = yFirst ? _mm_srli_epi16(packed, 8) : _mm_and_si128(packed, low);
+        __m128i u, v;
+        expandChroma(uv, u, v);
+        yuvToBgra8(y, u, v, dst + 4 * x);
+    }
+#elif defined(QTTOOLS_NEON)
+    for (; x + 8 <= width; x += 8)
+    {
+        const uint8x8x2_t packed = vld2_u8(src + 2 * x);
+        uint8x8_t u, v;
+        expandChroma(packed.val[uOffset], u, v);
+        yuvToBgra8(packed.val[yOffset], u, v, dst + 4 * x);
+    }
+#endif
+    for (; x + 1 < width; x += 2)
+    {
+        const uchar* p = src + 2 * x;
+        yuvPixel(p[yOffset], p[uOffset], p[uOffset + 2], dst + 4 * x);
+        yuvPixel(p[yOffset + 2], p[uOffset], p[uOffset + 2], dst + 4 * x + 4);
+    }
+}
+
+/* 转换一行 NV12 数据，uv 为该行对应的交错色度行 */
+void nv12Row(const uchar* y, const uchar* uv, uchar* dst, int width)
+{
+    int x = 0;
+#if defined(QTTOOLS_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 8 <= width; x += 8)
+    {
+        const __m128i luma = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x)), zero);
+        const __m128i chroma = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(uv + x)), zero);
+        __m128i u, v;
+        expandChroma(chroma, u, v);
+        yuvToBgra8(luma, u, v, dst + 4 * x);
+    }
+#elif defined(QTTOOLS_NEON)
+    for (; x + 8 <= width; x += 8)
+    {
+        uint8x8_t u, v;
+        expandChroma(vld1_u8(uv + x), u, v);
+        yuvToBgra8(vld1_u8(y + x), u, v, dst + 4 * x);
+    }
+#endif
+    for (; x + 1 < width; x += 2)
+    {
+        yuvPixel(y[x], uv[x], uv[x + 1], dst + 4 * x);
+        yuvPixel(y[x + 1], uv[x], uv[x + 1], dst + 4 * x + 4);
+    }
+}
+
+bool isBayer(PixelFormat format)
+{
+    return format == PixelFormat::BayerRG8 || format == PixelFormat::BayerGR8
+        || format == PixelFormat::BayerGB8 || format == PixelFormat::BayerBG8;
+}
+
+/**
+ * @brief 校验原始帧并准备输出缓冲
+ *
+ * @return int 原始帧的行字节数，参数无效时返回 0
+ */
+int prepareOutput(const RawFrame& frame, QImage& output)
+{
+    if (frame.isNull())
+        return 0;
+
+    const int width = frame.width;
+    const int height = frame.height;
+    const int stride = frame.stride > 0 ? frame.stride : minimumStride(frame.format, width);
+    if (stride < minimumStride(frame.format, width))
+        return 0;
+    if (isBayer(frame.format) && (width < 2 || height < 2))
+        return 0;
+    if ((frame.format == PixelFormat::YUYV || frame.format == PixelFormat::UYVY || frame.format == PixelFormat::NV12)
+        && width % 2 != 0)
+        return 0;
+    if (frame.format == PixelFormat::NV12 && height % 2 != 0)
+        return 0;
+
+    if (output.size() != QSize(width, height) || output.format() != QImage::Format_RGB32 || !output.isDetached())
+        output = QImage(width, height, QImage::Format_RGB32);
+    return output.isNull() ? 0 : stride;
+}
+
+} // namespace
+
+int minimumStride(PixelFormat format, int width) noexcept
+{
+    switch (format)
+    {
+    case PixelFormat::YUYV:
+    case PixelFormat::UYVY:
+        return width * 2;
+    default:
+        return width;
+    }
+}
+
+bool convertToRgb32(const RawFrame& frame, QImage& output)
+{
+    const int stride = prepareOutput(frame, output);
+    if (stride == 0)
+        return false;
+
+    const int width = frame.width;
+    const int height = frame.height;
+
+    // 在进入并行区域前取得缓冲区指针，避免多个线程同时调用 QImage::scanLine()
+    uchar* bits = output.bits();
+    const qsizetype bytesPerLine = output.bytesPerLine();
+    const uchar* src = frame.data;
+
+    switch (frame.format)
+    {
+    case PixelFormat::Mono8:
+    {
+        std::array<quint32, 256> table;
+        if (frame.lut)
+            for (int i = 0; i < 256; ++i)
+                table[i] = 0xFF000000u | (quint32(frame.lut[i]) * 0x010101u);
+        const quint32* lut = frame.lut ? table.data() : nullptr;
+        parallelFor(0, height, [&](int first, int last)
+        {
+            for (int y = first; y < last; ++y)
+                monoRow(src + qsizetype(y) * stride, bits + y * bytesPerLine, width, frame.lut, lut);
+        }, ROW_GRAIN);
+        break;
+    }
+    case PixelFormat::BayerRG8:
+    case PixelFormat::BayerGR8:
+    case PixelFormat::BayerGB8:
+    case PixelFormat::BayerBG8:
+    {
+        BayerColor pattern[2][2];
+        bayerPattern(frame.format, pattern);
+        parallelFor(0, height, [&](int first, int last)
+        {
+            for (int y = first; y < last; ++y)
+            {
+                // 上下边界镜像到相邻的同相位行
+                const int up = y > 0 ? y - 1 : 1;
+                const int down = y < height - 1 ? y + 1 : height - 2;
+                bayerRow(src + qsizetype(up) * stride, src + qsizetype(y) * stride, src + qsizetype(down) * stride,
+                         bits + y * bytesPerLine, width, pattern[y & 1]);
+            }
+        }, ROW_GRAIN);
+        break;
+    }
+    case PixelFormat::YUYV:
+    case PixelFormat::UYVY:
+    {
+        const bool yFirst = frame.format == PixelFormat::YUYV;
+        parallelFor(0, height, [&](int first, int last)
+        {
+            for (int y = first; y < last; ++y)
+                packedYuvRow(src + qsizetype(y) * stride, bits + y * bytesPerLine, width, yFirst);
+        }, ROW_GRAIN);
+        break;
+    }
+    case PixelFormat::NV12:
+    {
+        const uchar* chroma = src + qsizetype(height) * stride;
+        parallelFor(0, height, [&](int first, int last)
+        {
+            for (int y = first; y < last; ++y)
+                nv12Row(src + qsizetype(y) * stride, chroma + qsizetype(y / 2) * stride, bits + y * bytesPerLine, width);
+        }, ROW_GRAIN);
+        break;
+    }
+    }
+    return true;
+}
+
+QImage convertToRgb32(const RawFrame& frame)
+{
+    QImage output;
+    if (!convertToRgb32(frame, output))
+        return QImage();
+    return output;
+}
@@ -0,0 +1,340 @@
+/**
+ * @file regiondecoder.cpp
+ * @author ldk
+ * @brief 超大压缩图像按视口区域解码
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <QImageIOHandler>
+#include <QImageReader>
+#include <QThread>
+
+#include "regiondecoder.hpp"
+#include "displaystatistics.hpp"
+#include "parallel.hpp"
+
+namespace
+{
+
+inline int tileLevel(quint64 key) noexcept { return int(key >> 56); }
+inline int tileX(quint64 key) noexcept { return int((key >> 28) & 0xfffffff); }
+inline int tileY(quint64 key) noexcept { return int(key & 0xfffffff); }
+
+/* 分块在原图中的区域 */
+QRect tileRect(quint64 key, const QSize& size)
+{
+    const int span = RegionDecoder::tileSpan(tileLevel(key));
+    return QRect(tileX(key) * span, tileY(key) * span, span, span) & QRect(QPoint(0, 0), size);
+}
+
+} // namespace
+
+RegionDecoder::RegionDecoder(QObject* parent)
+    : QObject(parent)
+    , m_nGeneration(0)
+    , m_nBudget(DefaultBudget)
+    , m_nBytes(0)
+    , m_nMaxLevel(-1)
+    , m_bNotifyPending(false)
+{
+    m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
+}
+
+RegionDecoder::~RegionDecoder()
+{
+    close();
+    m_pool.waitForDone();
+}
+
+/**
+ * @brief 图像插件是否支持按区域与缩放解码
+ *
+ * @param path 图像路径
+ * @param size 图像尺寸
+ * @return bool 支持 ClipRect 与 ScaledSize 且能读出尺寸时返回 true
+ */
+bool RegionDecoder::canDecode(const QString& path, QSize* size)
+{
+    QImageReader reader(path);
+    reader.setDecideFormatFromContent(true);
+    const QSize imageSize = reader.size();
+    if (size)
+        *size = imageSize;
+    return imageSize.isValid() && reader.supportsOption(QImageIOHandler::ClipRect)
+        && reader.supportsOption(QImageIOHandler::ScaledSize);
+}
+
+/**
+ * @brief 打开图像，只读取文件头，概览图在线程池中解码
+ * @remarks 概览图就绪前 overview() 为空，调用者先显示占位，就绪后发出 tileReady()
+ *
+ * @param path 图像路径
+ * @return bool 格式不支持区域解码时返回 false
+ */
+bool RegionDecoder::open(const QString& path)
+{
+    close();
+
+    QSize size;
+    if (!canDecode(path, &size))
+        return false;
+
+    // 分块分辨率不高于概览图的级别不需要解码
+    const double scale = std::min(1., double(OverviewSize) / std::max(size.width(), size.height()));
+    const int overviewWidth = std::max(1, int(std::lround(size.width() * scale)));
+    int maxLevel = -1;
+    while ((1 << (maxLevel + 1)) * overviewWidth < size.width())
+        ++maxLevel;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_Path = path;
+    m_Size = size;
+    m_nMaxLevel = maxLevel;
+    m_statistics = RegionDecoderStatistics();
+    const quint64 generation = m_nGeneration;
+    // 概览图先于所有分块解码
+    runAsync(&m_pool, [this, generation] { decodeOverview(generation); }, std::numeric_limits<int>::max());
+    return true;
+}
+
+/**
+ * @brief 关闭图像，释放缓存；排队中的任务取消，正在解码的分块完成后丢弃
+ */
+void RegionDecoder::close()
+{
+    m_pool.clear();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_nGeneration;
+    m_entries.clear();
+    m_index.clear();
+    m_queued.clear();
+    m_wanted.clear();
+    m_failed.clear();
+    m_nBytes = 0;
+    m_nMaxLevel = -1;
+    m_Path.clear();
+    m_Size = QSize();
+    m_overview = QImage();
+}
+
+/**
+ * @brief 按缩放倍数选择分辨率不低于屏幕的最低一级
+ *
+ * @param zoom 屏幕像素与原图像素之比
+ * @return int 分辨率级别，概览图已足够时返回 -1
+ */
+int RegionDecoder::levelForZoom(double zoom) const
+{
+    if (m_nMaxLevel < 0 || zoom <= 0.)
+        return -1;
+    const int level = zoom >= 1. ? 0 : int(std::floor(std::log2(1. / zoom)));
+    return level > m_nMaxLevel ? -1 : level;
+}
+
+/**
+ * @brief 请求解码可见区域的分块，已缓存的分块只更新使用时间
+ * @remarks 排队中但已不在本次请求范围内的分块在开始解码前跳过
+ *
+ * @param visible 可见区域（原图坐标）
+ * @param zoom 屏幕像素与原图像素之比
+ */
+void RegionDecoder::request(const QRectF& visible, double zoom)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_wanted.clear();
+    const int level = levelForZoom(zoom);
+    const QRect area = visible.toAlignedRect() & QRect(QPoint(0, 0), m_Size);
+    if (level < 0 || area.isEmpty())
+        return;
+
+    const int span = tileSpan(level);
+    const int x0 = area.left() / span;
+    const int x1 = area.right() / span;
+    const int y0 = area.top() / span;
+    const int y1 = area.bottom() / span;
+    const double cx = (x0 + x1) / 2.;
+    const double cy = (y0 + y1) / 2.;
+    for (int y = y0; y <= y1; ++y)
+    {
+        for (int x = x0; x <= x1; ++x)
+        {
+            const quint64 key = tileKey(level, x, y);
+            m_wanted.insert(key);
+            auto it = m_index.find(key);
+            if (it != m_index.end())
+            {
+                m_entries.splice(m_entries.begin(), m_entries, it->second);
+                continue;
+            }
+            if (m_queued.count(key) != 0 || m_failed.count(key) != 0)
+                continue;
+
+            m_queued.insert(key);
+            const quint64 generation = m_nGeneration;
+            // 靠近视口中心的分块优先解码
+            const int priority = -int(std::hypot(x - cx, y - cy) * 16.);
+            runAsync(&m_pool, [this, key, generation] { decode(key, generation); }, priority);
+        }
+    }
+}
+
+/**
+ * @brief 获取概览图
+ *
+ * @return QImage 尚未解码完成或解码失败时返回空图像
+ */
+QImage RegionDecoder::overview() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_overview;
+}
+
+/**
+ * @brief 获取已缓存的分块
+ *
+ * @return QImage 未缓存时返回空图像
+ */
+QImage RegionDecoder::tile(int level, int x, int y) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(tileKey(level, x, y));
+    return it == m_index.end() ? QImage() : it->second->image;
+}
+
+void RegionDecoder::setBudget(qint64 bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_nBudget = std::max<qint64>(0, bytes);
+    evict();
+}
+
+void RegionDecoder::setThreadCount(int count)
+{
+    m_pool.setMaxThreadCount(std::max(1, count));
+}
+
+RegionDecoderStatistics RegionDecoder::statistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RegionDecoderStatistics result = m_statistics;
+    result.bytes = m_nBytes + m_overview.sizeInBytes();
+    result.tiles = int(m_entries.size());
+    return result;
+}
+
+quint64 RegionDecoder::tileKey(int level, int x, int y) noexcept
+{
+    return (quint64(level) << 56) | (quint64(x & 0xfffffff) << 28) | quint64(y & 0xfffffff);
+}
+
+/* 解码一个分块，每个任务使用独立的 QImageReader */
+void RegionDecoder::decode(quint64 key, quint64 generation)
+{
+    QString path;
+    QSize size;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (generation != m_nGeneration)
+            return;
+        if (m_wanted.count(key) == 0)
+        {
+            m_queued.erase(key);
+            ++m_statistics.skipped;
+            return;
+        }
+        path = m_Path;
+        size = m_Size;
+    }
+
+    const QRect rect = tileRect(key, size);
+    const int level = tileLevel(key);
+    const qint64 start = DisplayStatistics::now();
+    QImageReader reader(path);
+    reader.setDecideFormatFromContent(true);
+    reader.setClipRect(rect);
+    reader.setScaledSize(QSize(std::max(1, (rect.width() + (1 << level) - 1) >> level),
+                               std::max(1, (rect.height() + (1 << level) - 1) >> level)));
+    const QImage image = reader.read();
+    const qint64 elapsed = DisplayStatistics::now() - start;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (generation != m_nGeneration)
+            return;
+        m_queued.erase(key);
+        if (image.isNull())
+        {
+            m_failed.insert(key);
+            return;
+        }
+        m_index[key] = m_entries.insert(m_entries.begin(), Entry{ key, image });
+        m_nBytes += image.sizeInBytes();
+        ++m_statistics.decoded;
+        m_statistics.decodeNs += elapsed;
+        evict();
+    }
+    notify();
+}
+
+/* 解码概览图，长边不超过 OverviewSize */
+void RegionDecoder::decodeOverview(quint64 generation)
+{
+    QString path;
+    QSize size;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (generation != m_nGeneration)
+            return;
+        path = m_Path;
+        size = m_Size;
+    }
+
+    QImageReader reader(path);
+    reader.setDecideFormatFromContent(true);
+    const double scale = std::min(1., double(OverviewSize) / std::max(size.width(), size.height()));
+    reader.setScaledSize(QSize(std::max(1, int(std::lround(size.width() * scale))),
+                               std::max(1, int(std::lround(size.height() * scale)))));
+    const QImage overview = reader.read();
+    if (overview.isNull())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (generation != m_nGeneration)
+            return;
+        m_overview = overview;
+    }
+    notify();
+}
+
+/* 在解码器所在线程发出 tileReady()，尚未处理的通知合并为一次 */
+void RegionDecoder::notify()
+{
+    if (m_bNotifyPending.exchange(true, std::memory_order_acq_rel))
+        return;
+    QMetaObject::invokeMethod(this, [this]
+    {
+        m_bNotifyPending.store(false, std::memory_order_release);
+        emit tileReady();
+    }, Qt::QueuedConnection);
+}
+
+/* 淘汰最久未使用的分块直到满足预算，可见的分块不淘汰，调用前需持有 m_mutex */
+void RegionDecoder::evict()
+{
+    while (m_nBytes > m_nBudget && !m_entries.empty() && m_wanted.count(m_entries.back().key) == 0)
+    {
+        m_nBytes -= m_entries.back().image.sizeInBytes();
+        m_index.erase(m_entries.back().key);
+        m_entries.pop_back();
+        ++m_statistics.evictions;
+    }
+}
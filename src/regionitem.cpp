@@ -0,0 +1,98 @@
+/**
+ * @file regionitem.cpp
+ * @author ldk
+ * @brief 按视口区域解码的超大图像控件
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QWidget>
+
+#include "regionitem.hpp"
+#include "regiondecoder.hpp"
+
+RegionItem::RegionItem(QGraphicsItem* parent)
+    : QGraphicsItem(parent)
+    , m_pDecoder(nullptr)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+/**
+ * @brief 设置解码器，解码器打开新图像后需再次调用以更新范围
+ */
+void RegionItem::setDecoder(RegionDecoder* decoder)
+{
+    const QRectF bounds = decoder && decoder->isOpen() ? QRectF(QPointF(0, 0), decoder->imageSize()) : QRectF();
+    if (bounds != m_Bounds)
+        prepareGeometryChange();
+    m_pDecoder = decoder;
+    m_Bounds = bounds;
+    update();
+}
+
+QRectF RegionItem::boundingRect() const
+{
+    return m_Bounds;
+}
+
+void RegionItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    if (m_pDecoder == nullptr || !m_pDecoder->isOpen())
+        return;
+    const QRectF exposed = option->exposedRect & m_Bounds;
+    if (exposed.isEmpty())
+        return;
+
+    // 按整个视口请求分块，分块到达后的局部重绘不会使视口内其他分块被跳过
+    const double zoom = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    const QRectF visible = widget ? painter->worldTransform().inverted().mapRect(QRectF(widget->rect())) & m_Bounds
+                                  : exposed;
+    m_pDecoder->request(visible, zoom);
+
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, zoom < 1.);
+    // 概览图在后台解码，就绪前以占位色填充
+    const QImage overview = m_pDecoder->overview();
+    if (overview.isNull())
+    {
+        painter->fillRect(exposed, QColor(64, 64, 64));
+    }
+    else
+    {
+        const double sx = overview.width() / m_Bounds.width();
+        const double sy = overview.height() / m_Bounds.height();
+        painter->drawImage(exposed, overview,
+                           QRectF(exposed.x() * sx, exposed.y() * sy, exposed.width() * sx, exposed.height() * sy));
+    }
+
+    const int level = m_pDecoder->levelForZoom(zoom);
+    if (level >= 0)
+    {
+        const QRect area = exposed.toAlignedRect() & m_Bounds.toRect();
+        drawTiles(painter, area, level + 1);
+        drawTiles(painter, area, level);
+    }
+    painter->restore();
+}
+
+/* 绘制与 area 相交的一级已缓存分块 */
+void RegionItem::drawTiles(QPainter* painter, const QRect& area, int level)
+{
+    const int span = RegionDecoder::tileSpan(level);
+    const QRect bounds = m_Bounds.toRect();
+    for (int y = area.top() / span; y <= area.bottom() / span; ++y)
+    {
+        for (int x = area.left() / span; x <= area.right() / span; ++x)
+        {
+            const QImage tile = m_pDecoder->tile(level, x, y);
+            if (!tile.isNull())
+                painter->drawImage(QRectF(QRect(x * span, y * span, span, span) & bounds), tile);
+        }
+    }
+}
@@ -0,0 +1,411 @@
+/**
+ * @file resample.cpp
+ * @author ldk
+ * @brief 并行 SIMD 图像重采样
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "resample.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+
+namespace
+{
+
+constexpr int    PRECISION_BITS{ 14 };                          // 定点权重的小数位数
+constexpr int    ONE{ 1 << PRECISION_BITS };                    // 定点权重 1.0
+constexpr int    ROUND{ 1 << (PRECISION_BITS - 1) };            // 舍入偏置
+constexpr int    ROW_GRAIN{ 8 };                                // 并行时每段的最小行数
+constexpr double PI{ 3.14159265358979323846 };
+
+double sinc(double x)
+{
+    if (x == 0.)
+        return 1.;
+    x *= PI;
+    return std::sin(x) / x;
+}
+
+double support(ResampleFilter filter)
+{
+    switch (filter)
+    {
+    case ResampleFilter::Box:      return 0.5;
+    case ResampleFilter::Bilinear: return 1.;
+    default:                       return 3.;
+    }
+}
+
+double evaluate(ResampleFilter filter, double x)
+{
+    switch (filter)
+    {
+    case ResampleFilter::Box:
+        return x > -0.5 && x <= 0.5 ? 1. : 0.;
+    case ResampleFilter::Bilinear:
+        x = std::abs(x);
+        return x < 1. ? 1. - x : 0.;
+    default:
+        return std::abs(x) < 3. ? sinc(x) * sinc(x / 3.) : 0.;
+    }
+}
+
+/**
+ * @brief 一个方向上的定点权重表，第 i 个输出像素由 [first[i], first[i] + count[i]) 内的源像素加权得到
+ */
+struct Coefficients
+{
+    std::vector<int>    first;
+    std::vector<int>    count;
+    std::vector<qint16> weights;    // 每个输出像素 stride 个，多余的为 0
+    int                 stride = 0;
+
+    inline const qint16* at(int i) const { return weights.data() + size_t(i) * stride; }
+};
+
+Coefficients coefficients(int inSize, int outSize, ResampleFilter filter)
+{
+    const double scale = double(inSize) / outSize;
+    const double filterScale = std::max(scale, 1.);
+    const double radius = support(filter) * filterScale;
+
+    Coefficients result;
+    result.stride = int(std::ceil(radius)) * 2 + 1;
+    result.first.resize(outSize);
+    result.count.resize(outSize);
+    result.weights.assign(size_t(outSize) * result.stride, 0);
+
+    std::vector<double> weights(result.stride);
+    for (int i = 0; i < outSize; ++i)
+    {
+        const double center = (i + 0.5) * scale;
+        const int first = std::max(0, int(std::floor(center - radius)));
+        const int last = std::min(inSize, int(std::ceil(center + radius)));
+        int count = std::min(last - first, result.stride);
+
+        double sum = 0.;
+        for (int k = 0; k < count; ++k)
+        {
+            weights[k] = evaluate(filter, (first + k + 0.5 - center) / filterScale);
+            sum += weights[k];
+        }
+        // 支撑范围内没有采样到任何像素时取最近的像素
+        if (sum == 0.)
+        {
+            count = 1;
+            weights[0] = sum = 1.;
+        }
+
+        // 量化后的权重和必须恰好为 ONE，误差补在最大的权重上
+        qint16* fixed = result.weights.data() + size_t(i) * result.stride;
+        int total = 0, peak = 0;
+        for (int k = 0; k < count; ++k)
+        {
+            fixed[k] = qint16(std::lround(weights[k] / sum * ONE));
+            total += fixed[k];
+            if (fixed[k] > fixed[peak])
+                peak = k;
+        }
+        fixed[peak] = qint16(fixed[peak] + ONE - total);
+        result.first[i] = first;
+        result.count[i] = count;
+    }
+    return result;
+}
+
+#if defined(QTTOOLS_SSE2)
+/* 读取一个 4 通道像素并扩展为 16 位 */
+inline __m128i loadPixel(const uchar* pixel)
+{
+    int value;
+    std::memcpy(&value, pixel, sizeof(value));
+    return _mm_unpacklo_epi8(_mm_cvtsi32_si128(value), _mm_setzero_si128());
+}
+#endif
+
+inline uchar clamp8(int value)
+{
+    value = (value + ROUND) >> PRECISION_BITS;
+    return uchar(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+/* 水平方向重采样一行 4 通道像素 */
+void horizontal4(const uchar* src, uchar* dst, int outWidth, const Coefficients& c)
+{
+    for (int x = 0; x < outWidth; ++x)
+    {
+        const uchar* pixels = src + c.first[x] * 4;
+        const qint16* w = c.at(x);
+        const int count = c.count[x];
+        int k = 0;
+#if defined(QTTOOLS_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        __m128i acc = _mm_setzero_si128();
+        // 两个像素交错为 [r0 r1 g0 g1 b0 b1 a0 a1]，与 [w0 w1] 相乘累加
+        for (; k + 2 <= count; k += 2)
+        {
+            const __m128i p0 = loadPixel(pixels + k * 4);
+            const __m128i p1 = loadPixel(pixels + k * 4 + 4);
+            const __m128i weight = _mm_set1_epi32(int(quint16(w[k])) | int(quint32(quint16(w[k + 1])) << 16));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi16(p0, p1), weight));
+        }
+        if (k < count)
+        {
+            const __m128i p0 = loadPixel(pixels + k * 4);
+            const __m128i weight = _mm_set1_epi32(int(quint16(w[k])));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi16(p0, zero), weight));
+        }
+        acc = _mm_srai_epi32(_mm_add_epi32(acc, _mm_set1_epi32(ROUND)), PRECISION_BITS);
+        acc = _mm_packs_epi32(acc, acc);
+        const int value = _mm_cvtsi128_si32(_mm_packus_epi16(acc, acc));
+        std::memcpy(dst + x * 4, &value, sizeof(value));
+#else
+        int sum[4] = { 0, 0, 0, 0 };
+        for (; k < count; ++k)
+            for (int ch = 0; ch < 4; ++ch)
+                sum[ch] += pixels[k * 4 + ch] * w[k];
+        for (int ch = 0; ch < 4; ++ch)
+            dst[x * 4 + ch] = clamp8(sum[ch]);
+#endif
+    }
+}
+
+/* 水平方向重采样一行单通道像素 */
+void horizontal1(const uchar* src, uchar* dst, int outWidth, const Coefficients& c)
+{
+    for (int x = 0; x < outWidth; ++x)
+    {
+        const uchar* pixels = src + c.first[x];
+        const qint16* w = c.at(x);
+        const int count = c.count[x];
+        int k = 0;
+        int sum = 0;
+#if defined(QTTOOLS_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        __m128i acc = _mm_setzero_si128();
+        for (; k + 8 <= count; k += 8)
+        {
+            const __m128i p = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixels + k)), zero);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(p, _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + k))));
+        }
+        acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+        acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+        sum = _mm_cvtsi128_si32(acc);
+#endif
+        for (; k < count; ++k)
+            sum += pixels[k] * w[k];
+        dst[x] = clamp8(sum);
+    }
+}
+
+/**
+ * @brief 垂直方向重采样一行：dst[i] = sum(w[k] * rows[k][i])，逐字节处理，与通道数无关
+ *
+ * @param rows 参与加权的源行
+ * @param w 权重
+ * @param count 行数
+ * @param bytes 每行字节数
+ */
+void verticalRow(const uchar* const* rows, const qint16* w, int count, uchar* dst, int bytes)
+{
+    int i = 0;
+#if defined(QTTOOLS_AVX2)
+    // 与 SSE2 相同，unpack / pack 均在 128 位通道内进行，两次变换互逆，结果顺序不变
+    const __m256i zero256 = _mm256_setzero_si256();
+    for (; i + 32 <= bytes; i += 32)
+    {
+        __m256i s0 = _mm256_set1_epi32(ROUND), s1 = s0, s2 = s0, s3 = s0;
+        for (int k = 0; k < count; k += 2)
+        {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k] + i));
+            const __m256i b = k + 1 < count ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k + 1] + i)) : zero256;
+            const int w1 = k + 1 < count ? w[k + 1] : 0;
+            const __m256i weight = _mm256_set1_epi32(int(quint16(w[k])) | int(quint32(quint16(w1)) << 16));
+            const __m256i lo = _mm256_unpacklo_epi8(a, b);
+            const __m256i hi = _mm256_unpackhi_epi8(a, b);
+            s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(_mm256_unpacklo_epi8(lo, zero256), weight));
+            s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(_mm256_unpackhi_epi8(lo, zero256), weight));
+            s2 = _mm256_add_epi32(s2, _mm256_madd_epi16(_mm256_unpacklo_epi8(hi, zero256), weight));
+            s3 = _mm256_add_epi32(s3, _mm256_madd_epi16(_mm256_unpackhi_epi8(hi, zero256), weight));
+        }
+        const __m256i p0 = _mm256_packs_epi32(_mm256_srai_epi32(s0, PRECISION_BITS), _mm256_srai_epi32(s1, PRECISION_BITS));
+        const __m256i p1 = _mm256_packs_epi32(_mm256_srai_epi32(s2, PRECISION_BITS), _mm256_srai_epi32(s3, PRECISION_BITS));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(p0, p1));
+    }
+#endif
+#if defined(QTTOOLS_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= bytes; i += 16)
+    {
+        __m128i s0 = _mm_set1_epi32(ROUND), s1 = s0, s2 = s0, s3 = s0;
+        for (int k = 0; k < count; k += 2)
+        {
+            // 相邻两行逐字节交错为 [a0 b0 a1 b1 ...]，与 [w0 w1] 相乘累加
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + i));
+            const __m128i b = k + 1 < count ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k + 1] + i)) : zero;
+            const int w1 = k + 1 < count ? w[k + 1] : 0;
+            const __m128i weight = _mm_set1_epi32(int(quint16(w[k])) | int(quint32(quint16(w1)) << 16));
+            const __m128i lo = _mm_unpacklo_epi8(a, b);
+            const __m128i hi = _mm_unpackhi_epi8(a, b);
+            s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), weight));
+            s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), weight));
+            s2 = _mm_add_epi32(s2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), weight));
+            s3 = _mm_add_epi32(s3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), weight));
+        }
+        const __m128i p0 = _mm_packs_epi32(_mm_srai_epi32(s0, PRECISION_BITS), _mm_srai_epi32(s1, PRECISION_BITS));
+        const __m128i p1 = _mm_packs_epi32(_mm_srai_epi32(s2, PRECISION_BITS), _mm_srai_epi32(s3, PRECISION_BITS));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(p0, p1));
+    }
+#endif
+    for (; i < bytes; ++i)
+    {
+        int sum = 0;
+        for (int k = 0; k < count; ++k)
+            sum += rows[k][i] * w[k];
+        dst[i] = clamp8(sum);
+    }
+}
+
+/**
+ * @brief 重采样 channels 通道的 8 位图像
+ *
+ * @param src 源图像
+ * @param srcStride 源图像每行字节数
+ * @param dst 目标图像
+ * @param dstStride 目标图像每行字节数
+ */
+void resampleBuffer(const uchar* src, int srcWidth, int srcHeight, qsizetype srcStride,
+                    uchar* dst, int dstWidth, int dstHeight, qsizetype dstStride,
+                    int channels, ResampleFilter filter)
+{
+    // 水平方向：只处理垂直方向会用到的源行
+    const uchar* rows = src;
+    qsizetype rowStride = srcStride;
+    // 水平方向的中间结果在各调用线程中复用，连续重采样时不再分配
+    static thread_local std::vector<uchar> buffer;
+    const Coefficients vertical = coefficients(srcHeight, dstHeight, filter);
+    if (dstWidth != srcWidth)
+    {
+        const Coefficients horizontal = coefficients(srcWidth, dstWidth, filter);
+        const int top = vertical.first.front();
+        const int bottom = vertical.first.back() + vertical.count.back();
+        rowStride = qsizetype(dstWidth) * channels;
+        buffer.resize(size_t(rowStride) * srcHeight);
+        uchar* out = buffer.data();
+        parallelFor(top, bottom, [&](int first, int last)
+        {
+            for (int y = first; y < last; ++y)
+            {
+                if (channels == 4)
+                    horizontal4(src + y * srcStride, out + y * rowStride, dstWidth, horizontal);
+                else
+                    horizontal1(src + y * srcStride, out + y * rowStride, dstWidth, horizontal);
+            }
+        }, ROW_GRAIN);
+        rows = out;
+    }
+
+    const int bytes = dstWidth * channels;
+    parallelFor(0, dstHeight, [&](int first, int last)
+    {
+        std::vector<const uchar*> taps(vertical.stride);
+        for (int y = first; y < last; ++y)
+        {
+            const int count = vertical.count[y];
+            for (int k = 0; k < count; ++k)
+                taps[k] = rows + (vertical.first[y] + k) * rowStride;
+            verticalRow(taps.data(), vertical.at(y), count, dst + y * dstStride, bytes);
+        }
+    }, ROW_GRAIN);
+}
+
+/* Lanczos 的负瓣可能使预乘颜色超过透明度 */
+void clampPremultiplied(QImage& image)
+{
+    uchar* bits = image.bits();
+    const qsizetype bytesPerLine = image.bytesPerLine();
+    const int width = image.width();
+    parallelFor(0, image.height(), [&](int first, int last)
+    {
+        for (int y = first; y < last; ++y)
+        {
+            QRgb* row = reinterpret_cast<QRgb*>(bits + y * bytesPerLine);
+            for (int x = 0; x < width; ++x)
+            {
+                const int a = qAlpha(row[x]);
+                row[x] = qRgba(std::min(qRed(row[x]), a), std::min(qGreen(row[x]), a), std::min(qBlue(row[x]), a), a);
+            }
+        }
+    }, ROW_GRAIN * 8);
+}
+
+} // namespace
+
+QImage resample(const QImage& image, const QSize& size, ResampleFilter filter)
+{
+    if (image.isNull() || size.isEmpty())
+        return QImage();
+
+    QImage source = image;
+    switch (image.format())
+    {
+    case QImage::Format_Grayscale8:
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        break;
+    default:
+        source = image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                               : QImage::Format_RGB32);
+        break;
+    }
+    if (source.size() == size)
+        return source;
+
+    QImage result(size, source.format());
+    if (result.isNull())
+        return QImage();
+    const int channels = source.format() == QImage::Format_Grayscale8 ? 1 : 4;
+    resampleBuffer(source.constBits(), source.width(), source.height(), source.bytesPerLine(),
+                   result.bits(), result.width(), result.height(), result.bytesPerLine(),
+                   channels, filter);
+    if (filter == ResampleFilter::Lanczos && result.format() == QImage::Format_ARGB32_Premultiplied)
+        clampPremultiplied(result);
+    return result;
+}
+
+bool resample(const QImage& image, const QRect& area, const QSize& size, QImage& output, ResampleFilter filter)
+{
+    const QImage::Format format = image.format();
+    if (format != QImage::Format_Grayscale8 && format != QImage::Format_RGB32
+        && format != QImage::Format_ARGB32_Premultiplied)
+        return false;
+    const QRect source = area & image.rect();
+    if (source.isEmpty() || size.isEmpty())
+        return false;
+
+    if (output.width() < size.width() || output.height() < size.height() || output.format() != format
+        || !output.isDetached())
+    {
+        output = QImage(size, format);
+        if (output.isNull())
+            return false;
+    }
+    const int channels = format == QImage::Format_Grayscale8 ? 1 : 4;
+    const qsizetype bytesPerLine = image.bytesPerLine();
+    const uchar* src = image.constBits() + source.top() * bytesPerLine + source.left() * channels;
+    resampleBuffer(src, source.width(), source.height(), bytesPerLine,
+                   output.bits(), size.width(), size.height(), output.bytesPerLine(),
+                   channels, filter);
+    if (filter == ResampleFilter::Lanczos && format == QImage::Format_ARGB32_Premultiplied)
+        clampPremultiplied(output);
+    return true;
+}
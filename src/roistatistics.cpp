@@ -0,0 +1,515 @@
+/**
+ * @file roistatistics.cpp
+ * @author ldk
+ * @brief 基于分块统计表的 ROI 统计（均值/方差/最值/像素数）
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <QTimer>
+
+#include "roistatistics.hpp"
+#include "drawbutton.hpp"
+#include "floatimage.hpp"
+#include "graphicsviewinterface.hpp"
+#include "parallel.hpp"
+
+namespace
+{
+
+constexpr int TILE{ 32 };           // 分块边长
+constexpr int SHIFT_SAMPLES{ 64 };  // 估计浮点图像偏移时每个方向的采样数
+
+enum class SampleFormat
+{
+    Gray8,
+    Gray16,
+    Rgb32,
+    Float
+};
+
+} // namespace
+
+/**
+ * @brief 一帧的分块统计表
+ * 每个 TILE x TILE 分块保存总和、平方和与最值，内存约为每像素 0.04 字节，与 ROI 大小无关；
+ * 图像本身只持有共享引用，不拷贝。
+ * 整数图像用 64 位整数精确累加；浮点图像先减去整幅图像均值的估计再以双精度累加，
+ * NaN 不参与累加与计数，均值与方差按有效像素数计算。
+ */
+struct RoiTables
+{
+    int                  width = 0;
+    int                  height = 0;
+    quint64              frameNumber = 0;
+    SampleFormat         format = SampleFormat::Gray8;
+    QImage               image;          // 整数图像，用于扫描边缘分块
+    FloatImage           floatImage;     // 浮点图像
+    double               shift = 0.;     // 浮点图像累加前减去的偏移
+    int                  tilesX = 0;
+    int                  tilesY = 0;
+    std::vector<quint64> tileSum;        // 整数图像各分块的总和
+    std::vector<quint64> tileSquares;    // 整数图像各分块的平方和
+    std::vector<double>  floatSum;       // 浮点图像各分块减去偏移后的总和
+    std::vector<double>  floatSquares;   // 浮点图像各分块减去偏移后的平方和
+    std::vector<quint32> floatCount;     // 浮点图像各分块的有效（非 NaN）像素数
+    std::vector<double>  tileMin;        // 各分块最小值
+    std::vector<double>  tileMax;        // 各分块最大值
+};
+
+namespace
+{
+
+/* 读取一行中 [first, last) 的像素值 */
+template <typename T>
+void loadRow(const RoiTables& tables, int y, int first, int last, T* out)
+{
+    switch (tables.format)
+    {
+    case SampleFormat::Gray8:
+    {
+        const uchar* row = tables.image.constScanLine(y);
+        for (int x = first; x < last; ++x)
+            *out++ = T(row[x]);
+        break;
+    }
+    case SampleFormat::Gray16:
+    {
+        const quint16* row = reinterpret_cast<const quint16*>(tables.image.constScanLine(y));
+        for (int x = first; x < last; ++x)
+            *out++ = T(row[x]);
+        break;
+    }
+    case SampleFormat::Rgb32:
+    {
+        const QRgb* row = reinterpret_cast<const QRgb*>(tables.image.constScanLine(y));
+        for (int x = first; x < last; ++x)
+            *out++ = T(qGray(row[x]));
+        break;
+    }
+    case SampleFormat::Float:
+    {
+        const float* row = tables.floatImage.constScanLine(y);
+        for (int x = first; x < last; ++x)
+            *out++ = T(row[x]);
+        break;
+    }
+    }
+}
+
+/* 以稀疏网格上有效像素的均值估计浮点图像的偏移 */
+double estimateShift(const RoiTables& tables)
+{
+    const int stepX = std::max(1, tables.width / SHIFT_SAMPLES);
+    const int stepY = std::max(1, tables.height / SHIFT_SAMPLES);
+    double sum = 0.;
+    qint64 count = 0;
+    for (int y = 0; y < tables.height; y += stepY)
+    {
+        const float* row = tables.floatImage.constScanLine(y);
+        for (int x = 0; x < tables.width; x += stepX)
+        {
+            if (!std::isnan(row[x]))
+            {
+                sum += row[x];
+                ++count;
+            }
+        }
+    }
+    return count ? sum / count : 0.;
+}
+
+/* Neumaier 补偿求和 */
+inline void compensatedAdd(double& sum, double& error, double value)
+{
+    const double total = sum + value;
+    error += std::abs(sum) >= std::abs(value) ? (sum - total) + value : (value - total) + sum;
+    sum = total;
+}
+
+/**
+ * @brief 区域内的累加值
+ * 整数图像精确累加；浮点图像累加减去偏移后的值，跨分块时补偿舍入误差
+ */
+struct Accumulator
+{
+    quint64 sum = 0;
+    quint64 squares = 0;
+    double  floatSum = 0.;
+    double  floatSumError = 0.;
+    double  floatSquares = 0.;
+    double  floatSquaresError = 0.;
+    qint64  count = 0;
+    double  min = std::numeric_limits<double>::infinity();
+    double  max = -std::numeric_limits<double>::infinity();
+
+    inline void addRange(double low, double high)
+    {
+        min = std::min(min, low);
+        max = std::max(max, high);
+    }
+};
+
+/* 累加一行中 [first, last) 的像素，比较写法使 NaN 不参与最值 */
+void accumulateRow(const RoiTables& tables, int y, int first, int last, Accumulator& acc)
+{
+    const int count = last - first;
+    if (tables.format == SampleFormat::Float)
+    {
+        double values[TILE];
+        loadRow(tables, y, first, last, values);
+        double sum = 0.;
+        double squares = 0.;
+        for (int i = 0; i < count; ++i)
+        {
+            if (std::isnan(values[i]))
+                continue;
+            const double d = values[i] - tables.shift;
+            sum += d;
+            squares += d * d;
+            ++acc.count;
+            if (values[i] < acc.min)
+                acc.min = values[i];
+            if (values[i] > acc.max)
+                acc.max = values[i];
+        }
+        compensatedAdd(acc.floatSum, acc.floatSumError, sum);
+        compensatedAdd(acc.floatSquares, acc.floatSquaresError, squares);
+        return;
+    }
+
+    quint64 values[TILE];
+    loadRow(tables, y, first, last, values);
+    for (int i = 0; i < count; ++i)
+    {
+        acc.sum += values[i];
+        acc.squares += values[i] * values[i];
+        acc.min = std::min(acc.min, double(values[i]));
+        acc.max = std::max(acc.max, double(values[i]));
+    }
+    acc.count += count;
+}
+
+/**
+ * @brief 构建分块统计表
+ * @remarks 按分块行并行，各段独占自己的分块行
+ */
+void buildTables(RoiTables& tables)
+{
+    if (!tables.floatImage.isNull())
+    {
+        tables.format = SampleFormat::Float;
+        tables.width = tables.floatImage.width();
+        tables.height = tables.floatImage.height();
+    }
+    else
+    {
+        switch (tables.image.format())
+        {
+        case QImage::Format_Grayscale8:
+            tables.format = SampleFormat::Gray8;
+            break;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+        case QImage::Format_Grayscale16:
+            tables.format = SampleFormat::Gray16;
+            break;
+#endif
+        case QImage::Format_RGB32:
+        case QImage::Format_ARGB32:
+        case QImage::Format_ARGB32_Premultiplied:
+            tables.format = SampleFormat::Rgb32;
+            break;
+        default:
+            tables.image = tables.image.convertToFormat(QImage::Format_Grayscale8);
+            tables.format = SampleFormat::Gray8;
+            break;
+        }
+        tables.width = tables.image.width();
+        tables.height = tables.image.height();
+    }
+
+    const bool floating = tables.format == SampleFormat::Float;
+    tables.tilesX = (tables.width + TILE - 1) / TILE;
+    tables.tilesY = (tables.height + TILE - 1) / TILE;
+    const size_t tiles = size_t(tables.tilesX) * tables.tilesY;
+    tables.shift = floating ? estimateShift(tables) : 0.;
+    tables.tileSum.assign(floating ? 0 : tiles, 0);
+    tables.tileSquares.assign(floating ? 0 : tiles, 0);
+    tables.floatSum.assign(floating ? tiles : 0, 0.);
+    tables.floatSquares.assign(floating ? tiles : 0, 0.);
+    tables.floatCount.assign(floating ? tiles : 0, 0);
+    tables.tileMin.resize(tiles);
+    tables.tileMax.resize(tiles);
+
+    parallelFor(0, tables.tilesY, [&](int first, int last)
+    {
+        for (int ty = first; ty < last; ++ty)
+        {
+            for (int tx = 0; tx < tables.tilesX; ++tx)
+            {
+                const int x0 = tx * TILE;
+                const int x1 = std::min(tables.width, x0 + TILE);
+                Accumulator acc;
+                for (int y = ty * TILE; y < std::min(tables.height, (ty + 1) * TILE); ++y)
+                    accumulateRow(tables, y, x0, x1, acc);
+
+                const size_t index = size_t(ty) * tables.tilesX + tx;
+                if (floating)
+                {
+                    tables.floatSum[index] = acc.floatSum + acc.floatSumError;
+                    tables.floatSquares[index] = acc.floatSquares + acc.floatSquaresError;
+                    tables.floatCount[index] = quint32(acc.count);
+                }
+                else
+                {
+                    tables.tileSum[index] = acc.sum;
+                    tables.tileSquares[index] = acc.squares;
+                }
+                tables.tileMin[index] = acc.min;
+                tables.tileMax[index] = acc.max;
+            }
+        }
+    }, 1);
+}
+
+/**
+ * @brief 整数样本的方差
+ * @remarks 记 sum = q * count + r，则 sum² / count = q² count + 2 q r + r² / count，
+ * 离差平方和的整数部分精确求得，避免 E[x²] - mean² 在双精度下的相消误差
+ */
+double integerVariance(quint64 sum, quint64 squares, quint64 count)
+{
+    const quint64 q = sum / count;
+    const quint64 r = sum % count;
+    const quint64 centered = squares - q * q * count - 2 * q * r;
+    return std::max(0., (double(centered) - double(r) * double(r) / double(count)) / double(count));
+}
+
+} // namespace
+
+RoiStatisticsEngine::RoiStatisticsEngine(GraphicsViewInterface* source, QObject* parent, int interval)
+    : QObject(parent)
+    , m_pSource(source)
+    , m_pTimer(new QTimer(this))
+    , m_nNextId(0)
+    , m_nFrameNumber(0)
+    , m_bEnabled(false)
+    , m_bBusy(false)
+{
+    m_pool.setMaxThreadCount(1);
+    m_pTimer->setInterval(interval);
+    connect(m_pTimer, &QTimer::timeout, this, &RoiStatisticsEngine::poll);
+}
+
+RoiStatisticsEngine::~RoiStatisticsEngine()
+{
+    m_pTimer->stop();
+    m_pool.waitForDone();
+}
+
+void RoiStatisticsEngine::setEnabled(bool enabled)
+{
+    m_bEnabled = enabled;
+    if (enabled)
+    {
+        m_pTimer->start();
+        poll();
+    }
+    else
+    {
+        m_pTimer->stop();
+    }
+}
+
+/**
+ * @brief 设置轮询间隔，一般与显示刷新间隔一致
+ *
+ * @param interval 间隔（毫秒）
+ */
+void RoiStatisticsEngine::setUpdateInterval(int interval)
+{
+    m_pTimer->setInterval(interval);
+}
+
+/**
+ * @brief 添加 ROI
+ *
+ * @param rect 图像坐标系下的矩形
+ * @return int ROI 编号
+ */
+int RoiStatisticsEngine::addRoi(const QRect& rect)
+{
+    const int id = m_nNextId++;
+    m_rois.insert(id, rect.normalized());
+    emit statisticsUpdated();
+    return id;
+}
+
+void RoiStatisticsEngine::setRoi(int id, const QRect& rect)
+{
+    m_rois[id] = rect.normalized();
+    emit statisticsUpdated();
+}
+
+void RoiStatisticsEngine::removeRoi(int id)
+{
+    if (m_rois.remove(id) > 0)
+        emit statisticsUpdated();
+}
+
+void RoiStatisticsEngine::clearRois()
+{
+    m_rois.clear();
+    emit statisticsUpdated();
+}
+
+/**
+ * @brief 跟随 DrawButton 的框选更新 ROI，拖动过程中实时更新
+ * @remarks DrawButton 的画布应覆盖显示图像的控件
+ *
+ * @param button 绘图按钮
+ * @param id ROI 编号，为负数时新建
+ * @return int ROI 编号
+ */
+int RoiStatisticsEngine::trackDrawButton(DrawButton* button, int id)
+{
+    if (id < 0)
+        id = addRoi(QRect());
+    connect(button, &DrawButton::selectionChanged, this, [this, id](const QPoint& start, const QPoint& stop)
+    {
+        setRoi(id, QRect(m_pSource->mapGlobalToImage(start), m_pSource->mapGlobalToImage(stop)));
+    });
+    return id;
+}
+
+/**
+ * @brief 查询任意矩形的统计值
+ * @remarks 完整覆盖的分块直接查表，边缘分块只扫描与区域相交的部分
+ *
+ * @param rect 图像坐标系下的矩形
+ * @return RoiStatistics 统计结果，没有统计表或矩形在图像外时为空
+ */
+RoiStatistics RoiStatisticsEngine::statistics(const QRect& rect) const
+{
+    RoiStatistics result;
+    if (!m_pTables)
+        return result;
+
+    const RoiTables& tables = *m_pTables;
+    const QRect bounds(0, 0, tables.width, tables.height);
+    const QRect area = rect.normalized() & bounds;
+    if (area.isEmpty())
+        return result;
+
+    const bool floating = tables.format == SampleFormat::Float;
+    Accumulator acc;
+    for (int ty = area.top() / TILE; ty <= area.bottom() / TILE; ++ty)
+    {
+        for (int tx = area.left() / TILE; tx <= area.right() / TILE; ++tx)
+        {
+            const QRect tile = QRect(tx * TILE, ty * TILE, TILE, TILE) & bounds;
+            if (!area.contains(tile))
+            {
+                const QRect part = tile & area;
+                for (int y = part.top(); y <= part.bottom(); ++y)
+                    accumulateRow(tables, y, part.left(), part.right() + 1, acc);
+                continue;
+            }
+
+            const size_t index = size_t(ty) * tables.tilesX + tx;
+            if (floating)
+            {
+                compensatedAdd(acc.floatSum, acc.floatSumError, tables.floatSum[index]);
+                compensatedAdd(acc.floatSquares, acc.floatSquaresError, tables.floatSquares[index]);
+                acc.count += tables.floatCount[index];
+            }
+            else
+            {
+                acc.sum += tables.tileSum[index];
+                acc.squares += tables.tileSquares[index];
+                acc.count += qint64(tile.width()) * tile.height();
+            }
+            acc.addRange(tables.tileMin[index], tables.tileMax[index]);
+        }
+    }
+
+    result.rect = area;
+    result.frameNumber = tables.frameNumber;
+    // 全部为 NaN 时没有有效像素
+    if (acc.count == 0)
+        return result;
+    result.count = acc.count;
+    if (floating)
+    {
+        const double sum = acc.floatSum + acc.floatSumError;
+        const double squares = acc.floatSquares + acc.floatSquaresError;
+        const double offset = sum / acc.count;
+        result.sum = tables.shift * acc.count + sum;
+        result.mean = tables.shift + offset;
+        result.variance = std::max(0., squares / acc.count - offset * offset);
+    }
+    else
+    {
+        result.sum = double(acc.sum);
+        result.mean = result.sum / acc.count;
+        result.variance = integerVariance(acc.sum, acc.squares, quint64(acc.count));
+    }
+    result.stddev = std::sqrt(result.variance);
+    result.min = acc.min;
+    result.max = acc.max;
+    return result;
+}
+
+RoiStatistics RoiStatisticsEngine::roiStatistics(int id) const
+{
+    const auto it = m_rois.constFind(id);
+    return it == m_rois.cend() ? RoiStatistics() : statistics(*it);
+}
+
+/* 帧序号改变且没有构建任务时构建新的统计表，构建期间到来的帧直接跳过 */
+void RoiStatisticsEngine::poll()
+{
+    if (!m_bEnabled || m_bBusy || m_pSource == nullptr || !m_pSource->hasImage())
+        return;
+
+    const quint64 frameNumber = m_pSource->frameNumber();
+    if (m_pTables && frameNumber == m_nFrameNumber)
+        return;
+
+    m_nFrameNumber = frameNumber;
+    m_bBusy = true;
+    std::shared_ptr<RoiTables> tables = std::move(m_pSpare);
+    if (!tables)
+        tables = std::make_shared<RoiTables>();
+    tables->frameNumber = frameNumber;
+    tables->image = m_pSource->getImage();
+    tables->floatImage = m_pSource->getFloatImage();
+
+    runAsync(&m_pool, [this, tables]
+    {
+        buildTables(*tables);
+        QMetaObject::invokeMethod(this, [this, tables] { finish(tables); }, Qt::QueuedConnection);
+    });
+}
+
+void RoiStatisticsEngine::finish(std::shared_ptr<RoiTables> tables)
+{
+    m_bBusy = false;
+    // 旧统计表没有其他引用时留作下一帧复用，并释放其持有的图像
+    if (m_pTables && m_pTables.use_count() == 1)
+    {
+        m_pSpare = std::const_pointer_cast<RoiTables>(m_pTables);
+        m_pSpare->image = QImage();
+        m_pSpare->floatImage = FloatImage();
+    }
+    m_pTables = std::move(tables);
+    emit statisticsUpdated();
+}
@@ -0,0 +1,367 @@
+/**
+ * @file sequenceplayer.cpp
+ * @author ldk
+ * @brief 图像序列播放引擎，在线程池中预先解码并按目标帧率呈现
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <QCollator>
+#include <QDir>
+#include <QImageReader>
+#include <QThread>
+#include <QTimer>
+
+#include "sequenceplayer.hpp"
+#include "graphicsviewinterface.hpp"
+#include "parallel.hpp"
+
+SequencePlayer::SequencePlayer(QObject* parent)
+    : QObject(parent)
+    , m_nGeneration(0)
+    , m_nPresentedCount(0)
+    , m_nDroppedCount(0)
+    , m_nPresented(-1)
+    , m_nDue(0)
+    , m_nStartFrame(0)
+    , m_nQueueSize(DefaultQueueSize)
+    , m_dFps(DefaultFps)
+    , m_dSpeed(1.)
+    , m_bPlaying(false)
+    , m_bLoop(false)
+    , m_pTimer(new QTimer(this))
+{
+    m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+    m_pTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_pTimer, &QTimer::timeout, this, &SequencePlayer::tick);
+    m_statisticsClock.start();
+    updateInterval();
+}
+
+SequencePlayer::~SequencePlayer()
+{
+    m_pTimer->stop();
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+/**
+ * @brief 以文件夹中的图像作为序列，按文件名自然排序
+ *
+ * @param directory 文件夹路径
+ * @param nameFilters 文件名过滤器，为空时使用所有支持的图像格式
+ * @return bool 文件夹中是否有图像
+ */
+bool SequencePlayer::setDirectory(const QString& directory, const QStringList& nameFilters)
+{
+    QStringList filters = nameFilters;
+    if (filters.isEmpty())
+    {
+        for (const QByteArray& format : QImageReader::supportedImageFormats())
+            filters << "*." + QString::fromLatin1(format);
+        filters << "*.raw";
+    }
+
+    const QDir dir(directory);
+    QStringList names = dir.entryList(filters, QDir::Files);
+    QCollator collator;
+    collator.setNumericMode(true);
+    std::sort(names.begin(), names.end(), collator);
+
+    QStringList files;
+    for (const QString& name : names)
+        files << dir.absoluteFilePath(name);
+    setFrames(files);
+    return !files.isEmpty();
+}
+
+void SequencePlayer::setFrames(const QStringList& files)
+{
+    pause();
+    m_pool.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_nGeneration;
+        m_frames = files;
+        m_decoded.clear();
+        m_scheduled.clear();
+        m_nDue = 0;
+        m_nPresented = -1;
+    }
+    m_nPresentedCount = 0;
+    m_nDroppedCount = 0;
+    m_presentTimes.clear();
+    if (!files.isEmpty())
+        seek(0);
+}
+
+void SequencePlayer::setTargetFps(double fps)
+{
+    if (fps <= 0.)
+        return;
+    m_dFps = fps;
+    rebaseClock(m_nPresented + 1);
+    updateInterval();
+}
+
+void SequencePlayer::setSpeed(double speed)
+{
+    if (speed <= 0.)
+        return;
+    m_dSpeed = speed;
+    rebaseClock(m_nPresented + 1);
+    updateInterval();
+}
+
+void SequencePlayer::setQueueSize(int size)
+{
+    m_nQueueSize = std::max(1, size);
+    schedule();
+}
+
+void SequencePlayer::setDecodeThreadCount(int count)
+{
+    m_pool.setMaxThreadCount(std::max(1, count));
+}
+
+PlaybackStatistics SequencePlayer::statistics() const
+{
+    PlaybackStatistics statistics;
+    statistics.targetFps = m_dFps * m_dSpeed;
+    statistics.presented = m_nPresentedCount;
+    statistics.dropped = m_nDroppedCount;
+    // 统计最近一秒内的呈现次数
+    const qint64 now = m_statisticsClock.elapsed();
+    statistics.achievedFps = double(std::count_if(m_presentTimes.begin(), m_presentTimes.end(),
+                                                  [now](qint64 time) { return now - time <= 1000; }));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    statistics.queued = int(m_decoded.size());
+    return statistics;
+}
+
+void SequencePlayer::play()
+{
+    if (m_bPlaying || m_frames.isEmpty())
+        return;
+    // 播放结束后重新播放
+    if (m_nPresented >= m_frames.size() - 1)
+        seek(0);
+    m_bPlaying = true;
+    rebaseClock(m_nPresented + 1);
+    schedule();
+    m_pTimer->start();
+    emit stateChanged(true);
+}
+
+void SequencePlayer::pause()
+{
+    if (!m_bPlaying)
+        return;
+    m_bPlaying = false;
+    m_pTimer->stop();
+    emit stateChanged(false);
+}
+
+void SequencePlayer::stop()
+{
+    pause();
+    if (!m_frames.isEmpty())
+        seek(0);
+}
+
+/**
+ * @brief 跳转到指定帧并立即呈现
+ * @remarks 若该帧已预解码则直接呈现，否则在调用线程中同步解码
+ *
+ * @param frame 帧序号
+ */
+void SequencePlayer::seek(int frame)
+{
+    if (frame < 0 || frame >= m_frames.size())
+        return;
+
+    QImage image;
+    QString path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_decoded.find(frame);
+        if (it != m_decoded.end())
+            image = it->second;
+        else
+            path = m_frames[frame];
+        // 丢弃预解码窗口以外的帧
+        for (auto it = m_decoded.begin(); it != m_decoded.end();)
+        {
+            if (it->first <= frame || it->first > frame + m_nQueueSize)
+                it = m_decoded.erase(it);
+            else
+                ++it;
+        }
+        m_nDue = frame;
+    }
+    if (image.isNull())
+        image = decodeFrame(path);
+
+    present(frame, image);
+    rebaseClock(frame + 1);
+    schedule();
+}
+
+void SequencePlayer::stepForward()
+{
+    pause();
+    seek(m_nPresented + 1);
+}
+
+void SequencePlayer::stepBackward()
+{
+    pause();
+    seek(m_nPresented - 1);
+}
+
+/**
+ * @brief 呈现计时器回调
+ * @remarks 呈现 (已呈现帧, 时钟对应帧] 范围内已解码的最新一帧，跳过的帧计为丢帧
+ */
+void SequencePlayer::tick()
+{
+    const int count = int(m_frames.size());
+    const qint64 elapsed = m_clock.nsecsElapsed();
+    int due = m_nStartFrame + int(std::floor(elapsed * 1e-9 * m_dFps * m_dSpeed));
+
+    // 播放到末尾
+    if (m_nPresented >= count - 1)
+    {
+        if (m_bLoop && count > 0)
+        {
+            seek(0);
+            return;
+        }
+        pause();
+        emit finished();
+        return;
+    }
+    due = std::min(due, count - 1);
+
+    int frame = -1;
+    QImage image;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_nDue = due;
+        auto it = m_decoded.upper_bound(due);
+        if (it != m_decoded.begin() && (--it)->first > m_nPresented)
+        {
+            frame = it->first;
+            image = it->second;
+            m_decoded.erase(m_decoded.begin(), ++it);
+        }
+    }
+
+    if (frame >= 0)
+    {
+        m_nDroppedCount += quint64(frame - m_nPresented - 1);
+        present(frame, image);
+    }
+    schedule();
+}
+
+/* 以指定帧作为播放时钟的起点 */
+void SequencePlayer::rebaseClock(int frame)
+{
+    m_nStartFrame = frame;
+    m_clock.start();
+}
+
+/* 在有界窗口内为尚未解码的帧安排解码任务 */
+void SequencePlayer::schedule()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const int first = std::max(m_nPresented + 1, m_nDue);
+    const int last = std::min(int(m_frames.size()), first + m_nQueueSize);
+    for (int frame = first; frame < last; ++frame)
+    {
+        if (m_decoded.count(frame) != 0 || m_scheduled.count(frame) != 0)
+            continue;
+        m_scheduled.insert(frame);
+        const quint64 generation = m_nGeneration;
+        // 越靠前的帧优先解码
+        runAsync(&m_pool, [this, frame, generation] { decode(frame, generation); }, last - frame);
+    }
+}
+
+void SequencePlayer::decode(int frame, quint64 generation)
+{
+    QString path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (generation != m_nGeneration)
+            return;
+        // 已经错过呈现时间的帧不再解码
+        if (frame < m_nDue || frame <= m_nPresented)
+        {
+            m_scheduled.erase(frame);
+            return;
+        }
+        path = m_frames[frame];
+    }
+
+    QImage image = decodeFrame(path);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (generation != m_nGeneration)
+        return;
+    m_scheduled.erase(frame);
+    if (!image.isNull() && frame > m_nPresented)
+        m_decoded[frame] = image;
+}
+
+void SequencePlayer::present(int frame, const QImage& image)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_nPresented = frame;
+    }
+    ++m_nPresentedCount;
+    const qint64 now = m_statisticsClock.elapsed();
+    m_presentTimes.push_back(now);
+    while (!m_presentTimes.empty() && now - m_presentTimes.front() > 1000)
+        m_presentTimes.pop_front();
+    emit frameReady(image, frame);
+}
+
+/* 计时器以两倍目标帧率采样播放时钟 */
+void SequencePlayer::updateInterval()
+{
+    m_pTimer->setInterval(std::max(1, int(500. / (m_dFps * m_dSpeed))));
+}
+
+/**
+ * @brief 解码一帧
+ * @remarks 在解码线程中提前转换为绘制所需的格式，减少界面线程的转换开销；
+ * 灰度图像保持原格式，16 位图像保留原始值以支持窗宽窗位与像素读数
+ */
+QImage SequencePlayer::decodeFrame(const QString& path)
+{
+    QImage image = GraphicsViewInterface::loadImage(path);
+    switch (image.format())
+    {
+    case QImage::Format_Invalid:
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+    case QImage::Format_Grayscale8:
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+    case QImage::Format_Grayscale16:
+#endif
+        return image;
+    default:
+        return image.hasAlphaChannel()
+            ? image.convertToFormat(QImage::Format_ARGB32_Premultiplied)
+            : image.convertToFormat(QImage::Format_RGB32);
+    }
+}
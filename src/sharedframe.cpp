@@ -0,0 +1,328 @@
+/**
+ * @file sharedframe.cpp
+ * @author ldk
+ * @brief 跨进程共享内存帧环形缓冲：内存布局与生产者
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <new>
+
+#include "sharedframe.hpp"
+#include "displaystatistics.hpp"
+
+namespace
+{
+
+constexpr qint64 ALIGNMENT{ 64 };
+
+inline qint64 alignUp(qint64 value) noexcept { return (value + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+/* 槽位数据区的起始偏移 */
+inline qint64 dataOffset(int slotCount) noexcept
+{
+    return alignUp(qint64(sizeof(SharedFrameHeader)) + qint64(sizeof(SharedFrameSlot)) * slotCount);
+}
+
+}
+
+qint64 sharedFrameMemorySize(int slotCount, qint64 slotBytes)
+{
+    return dataOffset(slotCount) + alignUp(slotBytes) * slotCount;
+}
+
+SharedFrameSlot* sharedFrameSlot(SharedFrameHeader* header, int index)
+{
+    return reinterpret_cast<SharedFrameSlot*>(header + 1) + index;
+}
+
+uchar* sharedFrameData(SharedFrameHeader* header, int index)
+{
+    return reinterpret_cast<uchar*>(header) + dataOffset(int(header->slotCount))
+         + alignUp(qint64(header->slotBytes)) * index;
+}
+
+SharedFrameWriter::~SharedFrameWriter()
+{
+    close();
+}
+
+/**
+ * @brief 创建共享内存
+ * @remarks 同名的共享内存已存在（如生产者异常退出后重启）时：
+ * 布局有效且槽位容量足够则沿用其槽位数与消费者的占用位，只递增 generation 并修复未写完的槽位，
+ * 消费者正在显示的帧不受影响；布局无效时重新初始化，但有消费者占用槽位时拒绝接管
+ *
+ * @param key 共享内存名
+ * @param slotBytes 每个槽位的容量，应不小于最大帧的 bytesPerLine * height
+ * @param slotCount 槽位数，至少 3 个（最新帧、消费者正在显示的帧、正在写入的帧）
+ */
+bool SharedFrameWriter::create(const QString& key, qint64 slotBytes, int slotCount)
+{
+    close();
+    slotCount = qBound(3, slotCount, SHARED_FRAME_MAX_SLOTS);
+    const qint64 size = sharedFrameMemorySize(slotCount, slotBytes);
+    if (slotBytes <= 0 || size > std::numeric_limits<int>::max())
+        return false;
+
+    m_memory.setKey(key);
+    bool existing = false;
+    if (!m_memory.create(int(size)))
+    {
+        if (m_memory.error() != QSharedMemory::AlreadyExists || !m_memory.attach() || m_memory.size() < size)
+        {
+            m_memory.detach();
+            return false;
+        }
+        existing = true;
+    }
+
+    auto* header = static_cast<SharedFrameHeader*>(m_memory.data());
+    const bool valid = existing && header->magic == SHARED_FRAME_MAGIC && header->version == SHARED_FRAME_VERSION;
+    if (valid && header->slotCount >= 3 && header->slotCount <= quint32(SHARED_FRAME_MAX_SLOTS)
+        && header->slotBytes >= quint64(slotBytes)
+        && m_memory.size() >= sharedFrameMemorySize(int(header->slotCount), qint64(header->slotBytes)))
+    {
+        /* 上一个生产者写到一半的槽位不会是最新槽位，消费者不会读取，恢复为偶数序号即可复用 */
+        for (int i = 0; i < int(header->slotCount); ++i)
+        {
+            SharedFrameSlot* slot = sharedFrameSlot(header, i);
+            if (slot->sequence.load(std::memory_order_relaxed) & 1)
+                slot->sequence.fetch_add(1, std::memory_order_release);
+        }
+        ++header->generation;
+        m_pHeader = header;
+        m_nWriting = -1;
+        m_nNext = int((header->latestSlot.load(std::memory_order_relaxed) + 1) % header->slotCount);
+        return true;
+    }
+    if (valid && header->pinned.load(std::memory_order_acquire) != 0)
+    {
+        m_memory.detach();
+        return false;
+    }
+
+    /* 消费者以 magic 判断布局是否就绪，最后写入；原子量以 placement-new 构造 */
+    header->magic = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    const quint32 generation = valid ? header->generation + 1 : 0;
+    header = new (m_memory.data()) SharedFrameHeader();
+    header->version = SHARED_FRAME_VERSION;
+    header->slotCount = quint32(slotCount);
+    header->generation = generation;
+    header->slotBytes = quint64(slotBytes);
+    for (int i = 0; i < slotCount; ++i)
+        new (sharedFrameSlot(header, i)) SharedFrameSlot();
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = SHARED_FRAME_MAGIC;
+
+    m_pHeader = header;
+    m_nWriting = -1;
+    m_nNext = 0;
+    return true;
+}
+
+void SharedFrameWriter::close()
+{
+    if (m_pHeader && m_nWriting >= 0)
+    {
+        /* 放弃未完成的帧，恢复为偶数序号 */
+        sharedFrameSlot(m_pHeader, m_nWriting)->sequence.fetch_sub(1, std::memory_order_release);
+    }
+    m_pHeader = nullptr;
+    m_nWriting = -1;
+    if (m_memory.isAttached())
+        m_memory.detach();
+}
+
+/**
+ * @brief 取得一个空闲槽位用于写入下一帧
+ *
+ * @param bytesPerLine 每行字节数，0 表示按 QImage 的 4 字节对齐计算
+ * @return uchar* 槽位数据，帧超过槽位容量或所有槽位都被消费者占用时返回 nullptr（后者计入丢帧）
+ */
+uchar* SharedFrameWriter::beginFrame(int width, int height, QImage::Format format, int bytesPerLine)
+{
+    if (!m_pHeader || width <= 0 || height <= 0 || format == QImage::Format_Invalid)
+        return nullptr;
+    if (m_nWriting >= 0)
+    {
+        sharedFrameSlot(m_pHeader, m_nWriting)->sequence.fetch_sub(1, std::memory_order_release);
+        m_nWriting = -1;
+    }
+
+    const int depth = QImage::toPixelFormat(format).bitsPerPixel();
+    const int minimum = (width * depth + 7) / 8;
+    if (bytesPerLine <= 0)
+        bytesPerLine = (width * depth + 31) / 32 * 4;
+    if (bytesPerLine < minimum || qint64(bytesPerLine) * height > qint64(m_pHeader->slotBytes))
+        return nullptr;
+
+    const int count = int(m_pHeader->slotCount);
+    const quint32 latest = m_pHeader->latestSlot.load(std::memory_order_relaxed);
+    const bool hasLatest = m_pHeader->published.load(std::memory_order_relaxed) != 0;
+    for (int n = 0; n < count; ++n)
+    {
+        const int index = (m_nNext + n) % count;
+        const quint64 bit = quint64(1) << index;
+        if ((hasLatest && quint32(index) == latest) || (m_pHeader->pinned.load(std::memory_order_acquire) & bit))
+            continue;
+
+        /*
+         * 先将序号置为奇数再复查占用位：消费者先置占用位再复查序号，
+         * 两边都是顺序一致的读改写 / 写，至少一方能看到对方，不会同时进入同一槽位
+         */
+        SharedFrameSlot* slot = sharedFrameSlot(m_pHeader, index);
+        const quint32 sequence = slot->sequence.load(std::memory_order_relaxed);
+        slot->sequence.store(sequence + 1, std::memory_order_seq_cst);
+        if (m_pHeader->pinned.load(std::memory_order_seq_cst) & bit)
+        {
+            slot->sequence.store(sequence, std::memory_order_release);
+            continue;
+        }
+
+        slot->width = quint32(width);
+        slot->height = quint32(height);
+        slot->format = quint32(format);
+        slot->bytesPerLine = quint32(bytesPerLine);
+        m_nWriting = index;
+        m_nNext = (index + 1) % count;
+        return sharedFrameData(m_pHeader, index);
+    }
+
+    m_pHeader->dropped.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+/**
+ * @brief 发布 beginFrame() 取得的槽位
+ *
+ * @param frameNumber 帧序号
+ * @param timestamp 生产时间，0 表示取当前时间
+ */
+void SharedFrameWriter::endFrame(quint64 frameNumber, qint64 timestamp)
+{
+    if (!m_pHeader || m_nWriting < 0)
+        return;
+
+    SharedFrameSlot* slot = sharedFrameSlot(m_pHeader, m_nWriting);
+    slot->frameNumber = frameNumber;
+    slot->timestamp = timestamp ? timestamp : DisplayStatistics::now();
+    slot->sequence.fetch_add(1, std::memory_order_release);
+    m_pHeader->latestSlot.store(quint32(m_nWriting), std::memory_order_release);
+    m_pHeader->published.fetch_add(1, std::memory_order_release);
+    m_nWriting = -1;
+}
+
+/**
+ * @brief 拷贝并发布一幅图像
+ *
+ * @return bool 是否发布，槽位全部被占用时返回 false
+ */
+bool SharedFrameWriter::publish(const QImage& image, quint64 frameNumber, qint64 timestamp)
+{
+    /* 槽位沿用源图像的每行字节数，整块拷贝 */
+    uchar* data = beginFrame(image.width(), image.height(), image.format(), image.bytesPerLine());
+    if (!data)
+        return false;
+
+    std::memcpy(data, image.constBits(), size_t(image.sizeInBytes()));
+    endFrame(frameNumber, timestamp);
+    return true;
+}
+
+SharedFrameSimulator::~SharedFrameSimulator()
+{
+    stop();
+}
+
+/**
+ * @brief 创建共享内存并开始发布
+ *
+ * @param key 共享内存名
+ * @param size 帧尺寸
+ * @param fps 帧率
+ * @param format 像素格式，支持 Grayscale8、Grayscale16、RGB32
+ */
+bool SharedFrameSimulator::start(const QString& key, const QSize& size, double fps, QImage::Format format)
+{
+    stop();
+    if (size.isEmpty() || fps <= 0.)
+        return false;
+    if (format != QImage::Format_Grayscale8 && format != QImage::Format_Grayscale16 && format != QImage::Format_RGB32)
+        return false;
+
+    const qint64 lineBytes = (qint64(size.width()) * QImage::toPixelFormat(format).bitsPerPixel() + 31) / 32 * 4;
+    if (!m_writer.create(key, lineBytes * size.height()))
+        return false;
+
+    m_bStop.store(false);
+    m_nPublished.store(0);
+    m_thread = std::thread(&SharedFrameSimulator::run, this, size, fps, format);
+    return true;
+}
+
+void SharedFrameSimulator::stop()
+{
+    if (!m_thread.joinable())
+        return;
+    m_bStop.store(true);
+    m_thread.join();
+    m_writer.close();
+}
+
+/**
+ * @brief 发布线程：直接在槽位中生成对角移动的渐变条纹
+ */
+void SharedFrameSimulator::run(QSize size, double fps, QImage::Format format)
+{
+    using namespace std::chrono;
+    const auto period = duration_cast<steady_clock::duration>(duration<double>(1. / fps));
+    auto next = steady_clock::now();
+    const int bytesPerLine = (size.width() * QImage::toPixelFormat(format).bitsPerPixel() + 31) / 32 * 4;
+    quint64 frame = 0;
+
+    while (!m_bStop.load(std::memory_order_relaxed))
+    {
+        uchar* data = m_writer.beginFrame(size.width(), size.height(), format);
+        if (data)
+        {
+            const int offset = int(frame * 4);
+            for (int y = 0; y < size.height(); ++y)
+            {
+                uchar* line = data + qsizetype(y) * bytesPerLine;
+                for (int x = 0; x < size.width(); ++x)
+                {
+                    const quint32 value = quint32(x + y + offset) & 0xff;
+                    switch (format)
+                    {
+                    case QImage::Format_Grayscale16:
+                        reinterpret_cast<quint16*>(line)[x] = quint16(value * 257);
+                        break;
+                    case QImage::Format_RGB32:
+                        reinterpret_cast<quint32*>(line)[x] = 0xff000000u | (value << 16) | ((255 - value) << 8) | quint32(y & 0xff);
+                        break;
+                    default:
+                        line[x] = uchar(value);
+                        break;
+                    }
+                }
+            }
+            m_writer.endFrame(frame);
+            m_nPublished.fetch_add(1, std::memory_order_relaxed);
+        }
+        ++frame;
+
+        next += period;
+        const auto now = steady_clock::now();
+        if (next < now)
+            next = now;
+        std::this_thread::sleep_until(next);
+    }
+}
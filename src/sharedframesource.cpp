@@ -0,0 +1,284 @@
+/**
+ * @file sharedframesource.cpp
+ * @author ldk
+ * @brief 跨进程共享内存帧环形缓冲：消费者
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <QSharedMemory>
+#include <QTimer>
+
+#include "sharedframesource.hpp"
+#include "graphicsviewinterface.hpp"
+#include "sharedframe.hpp"
+
+/**
+ * @brief 共享内存映射，由消费者与其包装出的所有图像共同持有，最后一个持有者释放时解除映射
+ */
+struct SharedFrameMapping
+{
+    QSharedMemory       memory;
+    SharedFrameHeader*  header = nullptr;
+};
+
+namespace
+{
+
+constexpr int MAX_RETRIES{ 4 };     // 读到正在写入的槽位时的最大重试次数
+
+/**
+ * @brief 包装图像的占用信息，图像数据释放时解除占用
+ */
+struct SlotPin
+{
+    std::shared_ptr<SharedFrameMapping> mapping;
+    quint64                             bit;
+};
+
+void releaseSlot(void* info)
+{
+    auto* pin = static_cast<SlotPin*>(info);
+    pin->mapping->header->pinned.fetch_and(~pin->bit, std::memory_order_release);
+    delete pin;
+}
+
+}
+
+SharedFrameSource::SharedFrameSource(QObject* parent)
+    : QObject(parent)
+    , m_pView(nullptr)
+    , m_pTimer(new QTimer(this))
+    , m_bStarted(false)
+    , m_dFps(30.)
+    , m_nPublished(0)
+{
+    m_pTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_pTimer, &QTimer::timeout, this, &SharedFrameSource::poll);
+}
+
+SharedFrameSource::~SharedFrameSource()
+{
+    unbind();
+    stop();
+    setFrameCallback(nullptr);
+    detach();
+}
+
+/**
+ * @brief 连接到生产者创建的共享内存
+ *
+ * @param key 共享内存名，与 SharedFrameWriter::create 相同
+ * @return bool 共享内存不存在或布局不匹配时返回 false
+ */
+bool SharedFrameSource::attach(const QString& key)
+{
+    detach();
+
+    auto mapping = std::make_shared<SharedFrameMapping>();
+    mapping->memory.setKey(key);
+    if (!mapping->memory.attach(QSharedMemory::ReadWrite))
+        return false;
+
+    auto* header = static_cast<SharedFrameHeader*>(mapping->memory.data());
+    if (mapping->memory.size() < qint64(sizeof(SharedFrameHeader)) || header->magic != SHARED_FRAME_MAGIC
+        || header->version != SHARED_FRAME_VERSION || header->slotCount < 1
+        || header->slotCount > quint32(SHARED_FRAME_MAX_SLOTS)
+        || mapping->memory.size() < sharedFrameMemorySize(int(header->slotCount), qint64(header->slotBytes)))
+        return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    mapping->header = header;
+    m_pMapping = std::move(mapping);
+    m_nPublished = 0;
+    m_Statistics = SharedFrameStatistics{ };
+    return true;
+}
+
+/**
+ * @brief 断开连接，已取得的图像仍然有效，直到其最后一个副本析构
+ */
+void SharedFrameSource::detach()
+{
+    m_pMapping.reset();
+}
+
+/**
+ * @brief 取得最新一帧
+ *
+ * @param image 包装共享内存的只读图像
+ * @param info 帧信息
+ * @return bool 自上次取帧后没有新帧或槽位持续被改写时返回 false
+ */
+bool SharedFrameSource::acquire(QImage& image, FrameInfo* info)
+{
+    if (!m_pMapping)
+        return false;
+
+    SharedFrameHeader* header = m_pMapping->header;
+    const quint64 published = header->published.load(std::memory_order_acquire);
+    if (published == m_nPublished)
+        return false;
+
+    for (int attempt = 0; attempt < MAX_RETRIES; ++attempt)
+    {
+        const quint32 index = header->latestSlot.load(std::memory_order_acquire);
+        if (index >= header->slotCount)
+            return false;
+
+        /* 序号为偶数时置占用位，再复查序号未变，之后生产者不会再写入该槽位 */
+        SharedFrameSlot* slot = sharedFrameSlot(header, int(index));
+        const quint32 sequence = slot->sequence.load(std::memory_order_acquire);
+        const quint64 bit = quint64(1) << index;
+        if (!(sequence & 1))
+        {
+            header->pinned.fetch_or(bit, std::memory_order_seq_cst);
+            if (slot->sequence.load(std::memory_order_seq_cst) == sequence)
+            {
+                const auto format = QImage::Format(slot->format);
+                const int width = int(slot->width);
+                const int height = int(slot->height);
+                const int bytesPerLine = int(slot->bytesPerLine);
+                if (width <= 0 || height <= 0 || format <= QImage::Format_Invalid || format >= QImage::NImageFormats
+                    || qint64(bytesPerLine) * height > qint64(header->slotBytes))
+                {
+                    header->pinned.fetch_and(~bit, std::memory_order_release);
+                    return false;
+                }
+
+                // 以只读数据构造，写入时 QImage 先复制，不会改动生产者的槽位
+                image = QImage(static_cast<const uchar*>(sharedFrameData(header, int(index))), width, height,
+                               bytesPerLine, format, releaseSlot, new SlotPin{ m_pMapping, bit });
+                if (info)
+                {
+                    info->sequence = slot->frameNumber;
+                    info->timestamp = slot->timestamp;
+                }
+
+                ++m_Statistics.received;
+                if (m_nPublished && published > m_nPublished + 1)
+                    m_Statistics.skipped += published - m_nPublished - 1;
+                m_nPublished = published;
+                return true;
+            }
+            header->pinned.fetch_and(~bit, std::memory_order_release);
+        }
+        ++m_Statistics.retries;
+    }
+    return false;
+}
+
+/**
+ * @brief 定时轮询新帧并送入显示控件
+ *
+ * @param view 显示控件，应处于 DynamicMode
+ * @param interval 轮询间隔（毫秒）
+ */
+void SharedFrameSource::bind(GraphicsViewInterface* view, int interval)
+{
+    m_pView = view;
+    updateTimer(qMax(1, interval));
+}
+
+void SharedFrameSource::unbind()
+{
+    m_pView = nullptr;
+    updateTimer(0);
+}
+
+/**
+ * @brief 协商帧格式
+ * @remarks 尺寸与像素格式由生产者决定，只采用请求的帧率（决定轮询间隔）
+ */
+FrameFormat SharedFrameSource::negotiate(const FrameFormat& requested)
+{
+    m_dFps = requested.fps > 0. ? qMin(requested.fps, 1000.) : 30.;
+    if (m_bStarted && !m_pView)
+        updateTimer(qMax(1, int(500. / m_dFps)));
+    return format();
+}
+
+/* 最新一帧的格式，尚无帧时尺寸为空 */
+FrameFormat SharedFrameSource::format() const
+{
+    FrameFormat result;
+    result.fps = m_dFps;
+    if (m_pMapping && m_pMapping->header->published.load(std::memory_order_acquire) != 0)
+    {
+        SharedFrameHeader* header = m_pMapping->header;
+        const quint32 index = header->latestSlot.load(std::memory_order_acquire);
+        if (index < header->slotCount)
+        {
+            const SharedFrameSlot* slot = sharedFrameSlot(header, int(index));
+            result.size = QSize(int(slot->width), int(slot->height));
+            result.format = QImage::Format(slot->format);
+        }
+    }
+    return result;
+}
+
+bool SharedFrameSource::start()
+{
+    if (!m_pMapping)
+        return false;
+    m_bStarted = true;
+    updateTimer(m_pView ? 0 : qMax(1, int(500. / m_dFps)));
+    return true;
+}
+
+void SharedFrameSource::stop()
+{
+    m_bStarted = false;
+    updateTimer(0);
+}
+
+bool SharedFrameSource::isRunning() const
+{
+    return m_bStarted;
+}
+
+/**
+ * @brief 按绑定与启动状态启停轮询计时器
+ *
+ * @param interval 新的轮询间隔（毫秒），0 表示保持不变
+ */
+void SharedFrameSource::updateTimer(int interval)
+{
+    if (!m_pView && !m_bStarted)
+    {
+        m_pTimer->stop();
+        return;
+    }
+    if (interval > 0)
+        m_pTimer->setInterval(interval);
+    if (!m_pTimer->isActive())
+        m_pTimer->start();
+}
+
+SharedFrameStatistics SharedFrameSource::statistics() const
+{
+    SharedFrameStatistics result = m_Statistics;
+    if (m_pMapping)
+        result.dropped = m_pMapping->header->dropped.load(std::memory_order_relaxed);
+    return result;
+}
+
+void SharedFrameSource::poll()
+{
+    QImage image;
+    FrameInfo info;
+    if (!acquire(image, &info))
+        return;
+
+    if (m_pView)
+    {
+        m_pView->setFrameInfo(info);
+        m_pView->setImage(image);
+    }
+    if (m_bStarted)
+        deliver(image, info);
+    emit frameDelivered(info.sequence);
+}
@@ -0,0 +1,41 @@
+/**
+ * @file simd.hpp
+ * @author ldk
+ * @brief 图像处理内核使用的 SIMD 指令集检测
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _SIMD_HPP_
+#define _SIMD_HPP_
+
+/*
+ * 指令集在编译期选择：x86-64 默认使用 SSE2，开启 CMake 选项 QTTOOLS_ENABLE_AVX2 后使用 AVX2；
+ * AArch64 使用 NEON；其余平台使用标量实现。内核的尾部元素统一由标量代码处理。
+ * AVX2 编译选项只作用于库本身，本文件因此是 src 下的私有头文件：
+ * 公共头文件与内联函数不得依赖这些宏，否则库与使用者按不同指令集编译同一内联函数会违反单一定义规则。
+ */
+#if defined(__AVX2__)
+#define QTTOOLS_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QTTOOLS_SSE2
+#endif
+
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && (defined(__aarch64__) || defined(_M_ARM64))
+#define QTTOOLS_NEON
+#endif
+
+#if defined(QTTOOLS_AVX2)
+#include <immintrin.h>
+#elif defined(QTTOOLS_SSE2)
+#include <emmintrin.h>
+#elif defined(QTTOOLS_NEON)
+#include <arm_neon.h>
+#endif
+
+#endif // !_SIMD_HPP_
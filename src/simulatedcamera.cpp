@@ -0,0 +1,346 @@
+/**
+ * @file simulatedcamera.cpp
+ * @author ldk
+ * @brief 生成合成图像的模拟相机
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "simulatedcamera.hpp"
+#include "parallel.hpp"
+
+namespace
+{
+
+inline quint32 packRgb(int r, int g, int b) noexcept
+{
+    return 0xff000000u | (quint32(r & 0xff) << 16) | (quint32(g & 0xff) << 8) | quint32(b & 0xff);
+}
+
+inline int luma(quint32 rgb) noexcept
+{
+    return (int((rgb >> 16) & 0xff) * 77 + int((rgb >> 8) & 0xff) * 150 + int(rgb & 0xff) * 29) >> 8;
+}
+
+/* 每行独立的噪声序列，与分段方式无关，保证相同种子逐帧可复现 */
+struct Noise
+{
+    quint32 state;
+    int     amplitude;
+
+    Noise(quint32 seed, quint64 index, int y, int amplitude_)
+        : state((seed ^ quint32(index * 0x9E3779B1u) ^ (quint32(y) * 0x85EBCA77u)) | 1u)
+        , amplitude(amplitude_)
+    {}
+
+    inline int next() noexcept
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return int(state % quint32(2 * amplitude + 1)) - amplitude;
+    }
+};
+
+/* 生成一行 RGB 图像内容 */
+void patternRow(SimulatedPattern pattern, quint32* row, int y, int width, int height, quint64 index)
+{
+    const int t = int(index & 0xffff);
+    switch (pattern)
+    {
+    case SimulatedPattern::Checkerboard:
+    {
+        constexpr int Cell = 32;
+        const int band = (y / Cell) & 1;
+        for (int x = 0; x < width; ++x)
+        {
+            const int v = ((((x + 2 * t) / Cell) & 1) ^ band) ? 224 : 32;
+            row[x] = packRgb(v, v, v);
+        }
+        break;
+    }
+    case SimulatedPattern::MovingBar:
+    {
+        const int bar = std::max(8, width / 16);
+        const int position = int(index * 8 % quint64(width + bar)) - bar;
+        const int background = y * 96 / std::max(1, height);
+        for (int x = 0; x < width; ++x)
+            row[x] = x >= position && x < position + bar ? packRgb(255, 255, 255)
+                                                         : packRgb(background / 2, background, 48 + background);
+        break;
+    }
+    default:
+    {
+        const int g = (y * 256 / std::max(1, height) + 2 * t) & 0xff;
+        const quint32 step = (256u << 16) / quint32(std::max(1, width));
+        quint32 r = quint32(4 * t) << 16;
+        for (int x = 0; x < width; ++x, r += step)
+        {
+            const int red = int(r >> 16) & 0xff;
+            row[x] = packRgb(red, g, ((red + g) >> 1) ^ 0x80);
+        }
+        break;
+    }
+    }
+}
+
+/* Bayer 2x2 单元各位置取 RGB32 中的哪个通道（移位量） */
+void bayerShifts(PixelFormat format, int shifts[2][2])
+{
+    constexpr int R = 16, G = 8, B = 0;
+    switch (format)
+    {
+    case PixelFormat::BayerGR8:
+        shifts[0][0] = G; shifts[0][1] = R; shifts[1][0] = B; shifts[1][1] = G;
+        break;
+    case PixelFormat::BayerGB8:
+        shifts[0][0] = G; shifts[0][1] = B; shifts[1][0] = R; shifts[1][1] = G;
+        break;
+    case PixelFormat::BayerBG8:
+        shifts[0][0] = B; shifts[0][1] = G; shifts[1][0] = G; shifts[1][1] = R;
+        break;
+    default:
+        shifts[0][0] = R; shifts[0][1] = G; shifts[1][0] = G; shifts[1][1] = B;
+        break;
+    }
+}
+
+}
+
+SimulatedCamera::SimulatedCamera()
+    : m_nPattern(int(SimulatedPattern::Gradient))
+    , m_nNoise(0)
+    , m_nSeed(0x5EED)
+    , m_bStop(false)
+    , m_nGenerated(0)
+    , m_nLate(0)
+    , m_nRenderNs(0)
+{
+    m_Format.size = QSize(640, 480);
+}
+
+SimulatedCamera::~SimulatedCamera()
+{
+    stop();
+    setFrameCallback(nullptr);
+}
+
+/**
+ * @brief 协商帧格式
+ * @remarks 尺寸限制在 [MinSize, MaxSize]，Bayer 时取偶数；帧率限制在 (0, MaxFps]；
+ * Bayer 输出 Grayscale8，其他像素排列按 format 输出，不支持的 format 调整为 RGB32
+ */
+FrameFormat SimulatedCamera::negotiate(const FrameFormat& requested)
+{
+    if (isRunning())
+        return m_Format;
+
+    FrameFormat result = requested;
+    const QSize size = requested.size.isEmpty() ? m_Format.size : requested.size;
+    result.size = size.expandedTo(QSize(MinSize, MinSize)).boundedTo(QSize(MaxSize, MaxSize));
+    result.fps = requested.fps > 0. ? std::min(requested.fps, MaxFps) : 30.;
+
+    if (result.isBayer())
+    {
+        result.format = QImage::Format_Grayscale8;
+        result.size = QSize(result.size.width() & ~1, result.size.height() & ~1);
+    }
+    else
+    {
+        result.pixel = PixelFormat::Mono8;
+        if (result.format != QImage::Format_Grayscale8 && result.format != QImage::Format_Grayscale16)
+            result.format = QImage::Format_RGB32;
+    }
+
+    m_Format = result;
+    return result;
+}
+
+FrameFormat SimulatedCamera::format() const
+{
+    return m_Format;
+}
+
+bool SimulatedCamera::start()
+{
+    if (isRunning())
+        return true;
+
+    m_bStop.store(false);
+    m_nGenerated.store(0);
+    m_nLate.store(0);
+    m_thread = std::thread(&SimulatedCamera::run, this);
+    return true;
+}
+
+void SimulatedCamera::stop()
+{
+    if (!m_thread.joinable())
+        return;
+    m_bStop.store(true);
+    m_thread.join();
+}
+
+bool SimulatedCamera::isRunning() const
+{
+    return m_thread.joinable();
+}
+
+void SimulatedCamera::setPattern(SimulatedPattern pattern)
+{
+    m_nPattern.store(int(pattern));
+}
+
+/**
+ * @brief 设置噪声幅度
+ *
+ * @param amplitude 均匀噪声的最大偏移（8 位灰度级），0 表示无噪声
+ */
+void SimulatedCamera::setNoise(int amplitude)
+{
+    m_nNoise.store(qBound(0, amplitude, 127));
+}
+
+/* 设置噪声种子，运行中修改从下一次 start() 起生效 */
+void SimulatedCamera::setSeed(quint32 seed)
+{
+    if (!isRunning())
+        m_nSeed = seed;
+}
+
+SimulatedCameraStatistics SimulatedCamera::statistics() const
+{
+    SimulatedCameraStatistics result;
+    result.generated = m_nGenerated.load(std::memory_order_relaxed);
+    result.late = m_nLate.load(std::memory_order_relaxed);
+    result.renderNs = m_nRenderNs.load(std::memory_order_relaxed);
+    return result;
+}
+
+/**
+ * @brief 生成线程：按帧率生成并推送，消费者已释放的帧缓冲循环复用
+ */
+void SimulatedCamera::run()
+{
+    using namespace std::chrono;
+    const auto period = duration_cast<steady_clock::duration>(duration<double>(1. / m_Format.fps));
+    auto next = steady_clock::now();
+    QImage buffers[BufferCount];
+    int current = 0;
+
+    for (quint64 index = 0; !m_bStop.load(std::memory_order_relaxed); ++index)
+    {
+        /* 优先复用不再被消费者引用的缓冲，全部被引用时替换为新缓冲 */
+        int slot = -1;
+        for (int i = 0; i < BufferCount && slot < 0; ++i)
+        {
+            const int candidate = (current + i) % BufferCount;
+            if (!buffers[candidate].isNull() && buffers[candidate].isDetached())
+                slot = candidate;
+        }
+        if (slot < 0)
+        {
+            slot = current;
+            buffers[slot] = QImage(m_Format.size, m_Format.format);
+        }
+        current = (slot + 1) % BufferCount;
+
+        const qint64 begin = DisplayStatistics::now();
+        render(buffers[slot], index);
+        FrameInfo info;
+        info.sequence = index;
+        info.timestamp = DisplayStatistics::now();
+        m_nRenderNs.store(info.timestamp - begin, std::memory_order_relaxed);
+        m_nGenerated.fetch_add(1, std::memory_order_relaxed);
+        deliver(buffers[slot], info);
+
+        next += period;
+        const auto now = steady_clock::now();
+        if (next < now)
+        {
+            m_nLate.fetch_add(1, std::memory_order_relaxed);
+            next = now;
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+/**
+ * @brief 按行分段并行生成一帧
+ */
+void SimulatedCamera::render(QImage& frame, quint64 index) const
+{
+    const auto pattern = SimulatedPattern(m_nPattern.load(std::memory_order_relaxed));
+    const int amplitude = m_nNoise.load(std::memory_order_relaxed);
+    const int width = frame.width();
+    const int height = frame.height();
+    const QImage::Format format = frame.format();
+    const PixelFormat pixel = m_Format.pixel;
+    const bool bayer = m_Format.isBayer();
+    const qsizetype bytesPerLine = frame.bytesPerLine();
+    uchar* const bits = frame.bits();
+
+    int shifts[2][2];
+    bayerShifts(pixel, shifts);
+
+    parallelFor(0, height, [&](int first, int last)
+    {
+        std::vector<quint32> row(size_t(width));
+        for (int y = first; y < last; ++y)
+        {
+            patternRow(pattern, row.data(), y, width, height, index);
+            Noise noise(m_nSeed, index, y, amplitude);
+            uchar* line = bits + y * bytesPerLine;
+
+            if (bayer)
+            {
+                const int* rowShifts = shifts[y & 1];
+                for (int x = 0; x < width; ++x)
+                {
+                    const int value = int((row[size_t(x)] >> rowShifts[x & 1]) & 0xff);
+                    line[x] = uchar(std::clamp(amplitude ? value + noise.next() : value, 0, 255));
+                }
+            }
+            else if (format == QImage::Format_Grayscale8)
+            {
+                for (int x = 0; x < width; ++x)
+                {
+                    const int value = luma(row[size_t(x)]);
+                    line[x] = uchar(std::clamp(amplitude ? value + noise.next() : value, 0, 255));
+                }
+            }
+            else if (format == QImage::Format_Grayscale16)
+            {
+                auto* out = reinterpret_cast<quint16*>(line);
+                for (int x = 0; x < width; ++x)
+                {
+                    const int value = luma(row[size_t(x)]) * 257;
+                    out[x] = quint16(std::clamp(amplitude ? value + noise.next() * 257 : value, 0, 65535));
+                }
+            }
+            else
+            {
+                auto* out = reinterpret_cast<quint32*>(line);
+                if (!amplitude)
+                {
+                    std::copy(row.begin(), row.end(), out);
+                    continue;
+                }
+                for (int x = 0; x < width; ++x)
+                {
+                    const quint32 rgb = row[size_t(x)];
+                    out[x] = packRgb(std::clamp(int((rgb >> 16) & 0xff) + noise.next(), 0, 255),
+                                     std::clamp(int((rgb >> 8) & 0xff) + noise.next(), 0, 255),
+                                     std::clamp(int(rgb & 0xff) + noise.next(), 0, 255));
+                }
+            }
+        }
+    }, 16);
+}
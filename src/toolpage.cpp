@@ -3,6 +3,18 @@
 
 #include "ui_toolpage.h"
 #include "toolpage.hpp"
+#include "resample.hpp"
+
+namespace
+{
+
+/* 将图标重采样到标签尺寸 */
+QPixmap iconPixmap(const QString& path, const QSize& size)
+{
+    return QPixmap::fromImage(resample(QImage(path), size, ResampleFilter::Lanczos));
+}
+
+} // namespace
 
 ToolPage::ToolPage(const QString& title, QWidget *parent)
 	: QWidget(parent)
@@ -18,15 +30,7 @@ ToolPage::ToolPage(const QString& title, QWidget *parent)
     ui->widgetContent->setAttribute(Qt::WA_StyledBackground);
 
     m_pLabel->setFixedSize(20, 20);
-    m_pLabel->setPixmap
-    (
-        QPixmap(":/icons/down-arrow.png").scaled
-        (
-            m_pLabel->size(),
-            Qt::IgnoreAspectRatio,
-            Qt::SmoothTransformation
-        )
-    );
+    m_pLabel->setPixmap(iconPixmap(":/icons/down-arrow.png", m_pLabel->size()));
     m_pLayout = new QHBoxLayout(ui->pushButtonFold);
     m_pLayout->setContentsMargins(0, 0, 5, 0);
     m_pLayout->addStretch(1);
@@ -80,30 +84,14 @@ void ToolPage::expand()
 {
     ui->widgetContent->show();
     m_bIsExpanded = true;
-    m_pLabel->setPixmap
-    (
-        QPixmap(":/icons/down-arrow.png").scaled
-        (
-            m_pLabel->size(),
-            Qt::IgnoreAspectRatio,
-            Qt::SmoothTransformation
-        )
-    );
+    m_pLabel->setPixmap(iconPixmap(":/icons/down-arrow.png", m_pLabel->size()));
 }
 
 void ToolPage::collapse()
 {
     ui->widgetContent->hide();
     m_bIsExpanded = false;
-    m_pLabel->setPixmap
-    (
-        QPixmap(":/icons/left-arrow.png").scaled
-        (
-            m_pLabel->size(),
-            Qt::IgnoreAspectRatio,
-            Qt::SmoothTransformation
-        )
-    );
+    m_pLabel->setPixmap(iconPixmap(":/icons/left-arrow.png", m_pLabel->size()));
 }
 
 void ToolPage::on_pushButtonFold_clicked()
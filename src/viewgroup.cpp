@@ -0,0 +1,101 @@
+/**
+ * @file viewgroup.cpp
+ * @author ldk
+ * @brief 共享图像并同步缩放平移的多视图组
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <QTimer>
+
+#include "viewgroup.hpp"
+#include "graphicsviewinterface.hpp"
+#include "imageplayer.hpp"
+
+ViewGroup::ViewGroup(QObject* parent, int interval)
+    : QObject(parent)
+    , m_pLeader(nullptr)
+    , m_pTimer(new QTimer(this))
+    , m_bLinked(true)
+{
+    m_pTimer->setSingleShot(true);
+    m_pTimer->setInterval(interval);
+    connect(m_pTimer, &QTimer::timeout, this, &ViewGroup::synchronize);
+}
+
+/**
+ * @brief 添加视图，已有视图时新视图立即与之对齐
+ */
+void ViewGroup::addView(GraphicsViewInterface* view)
+{
+    if (view == nullptr || m_views.contains(view))
+        return;
+    m_views.append(view);
+    connect(view, &GraphicsViewInterface::viewChanged, this, [this, view] { scheduleSync(view); });
+    connect(view, &QObject::destroyed, this, [this, view] { removeView(view); });
+    if (m_views.size() > 1)
+        scheduleSync(m_views.first());
+}
+
+void ViewGroup::addView(ImagePlayer* player)
+{
+    addView(player->viewInterface());
+}
+
+void ViewGroup::removeView(GraphicsViewInterface* view)
+{
+    if (!m_views.removeOne(view))
+        return;
+    disconnect(view, nullptr, this, nullptr);
+    if (m_pLeader == view)
+        m_pLeader = nullptr;
+}
+
+void ViewGroup::setLinked(bool linked)
+{
+    m_bLinked = linked;
+    if (!linked)
+        m_pTimer->stop();
+}
+
+/**
+ * @brief 所有视图显示同一幅图像，只深拷贝一次
+ */
+void ViewGroup::setImage(const QImage& image)
+{
+    const QImage shared = image.copy();
+    for (GraphicsViewInterface* view : m_views)
+        view->setSharedImage(shared);
+}
+
+/**
+ * @brief 按顺序为各视图设置图像，用于对齐的多帧对比
+ */
+void ViewGroup::setImages(const QList<QImage>& images)
+{
+    for (int i = 0; i < qMin(images.size(), m_views.size()); ++i)
+        m_views[i]->setSharedImage(images[i].copy());
+}
+
+/* 把最近操作的视图的变换同步到其他视图 */
+void ViewGroup::synchronize()
+{
+    if (!m_bLinked || m_pLeader == nullptr)
+        return;
+    const QTransform transform = m_pLeader->viewTransform();
+    const QPointF center = m_pLeader->viewCenter();
+    for (GraphicsViewInterface* view : m_views)
+        if (view != m_pLeader)
+            view->setViewTransform(transform, center);
+}
+
+/* 一个显示周期内的多次操作只同步一次 */
+void ViewGroup::scheduleSync(GraphicsViewInterface* leader)
+{
+    m_pLeader = leader;
+    if (m_bLinked && !m_pTimer->isActive())
+        m_pTimer->start();
+}